@@ -1,15 +1,534 @@
+#include <chrono>
+#include <cmath>
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <stdexcept>
+#include <string>
 #include <SDL3/SDL.h>
 #include <SDL3/SDL_vulkan.h>
 
+#include "AssetLoader.h"
+#include "DrawBatcher.h"
+#include "FrameScheduler.h"
+#include "GpuScene.h"
+#include "ImGuiRenderer.h"
+#include "TextureStreamer.h"
 #include "VulkanRenderer.h"
 
 constexpr unsigned int SCREEN_WIDTH = 640;
 constexpr unsigned int SCREEN_HEIGHT = 480;
 
-int main()
+namespace
 {
+    struct Options
+    {
+        bool headless = false;
+        // 0 runs until the window is closed, headless runs always stop
+        uint32_t frames = 0;
+        uint32_t width = SCREEN_WIDTH;
+        uint32_t height = SCREEN_HEIGHT;
+        // Headless only, the last frame is written there as a binary PPM
+        std::string readbackPath;
+        // GPU timings written on exit, JSON when the name ends in .json and CSV otherwise
+        std::string profilePath;
+        // Cubes drawn by the GPU driven scene, 0 disables it
+        uint32_t objects = 0;
+        // Submits the cubes through the draw batcher every frame instead
+        bool batched = false;
+        // KTX2 texture streamed and shown in its own window
+        std::string texturePath;
+        // OBJ loaded in the background, replaces the cube of the batched field once it arrives
+        std::string meshPath;
+    };
+
+    bool parseOptions(int argc, char** argv, Options& options)
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            const bool hasValue = i + 1 < argc;
+            if (std::strcmp(argv[i], "--headless") == 0)
+                options.headless = true;
+            else if (std::strcmp(argv[i], "--frames") == 0 && hasValue)
+                options.frames = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+            else if (std::strcmp(argv[i], "--size") == 0 && hasValue)
+                std::sscanf(argv[++i], "%ux%u", &options.width, &options.height);
+            else if (std::strcmp(argv[i], "--readback") == 0 && hasValue)
+                options.readbackPath = argv[++i];
+            else if (std::strcmp(argv[i], "--profile") == 0 && hasValue)
+                options.profilePath = argv[++i];
+            else if (std::strcmp(argv[i], "--objects") == 0 && hasValue)
+                options.objects = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+            else if (std::strcmp(argv[i], "--batched") == 0)
+                options.batched = true;
+            else if (std::strcmp(argv[i], "--texture") == 0 && hasValue)
+                options.texturePath = argv[++i];
+            else if (std::strcmp(argv[i], "--mesh") == 0 && hasValue)
+                options.meshPath = argv[++i];
+            else
+            {
+                fprintf(stderr, "Usage: %s [--headless] [--frames N] [--size WxH] [--readback file.ppm]"
+                                " [--profile file.csv|file.json] [--objects N] [--batched]"
+                                " [--texture file.ktx2] [--mesh file.obj]\n", argv[0]);
+                return false;
+            }
+        }
+        if (options.headless && options.frames == 0)
+            options.frames = 600;
+        // Only the batcher draws from buffers of its own
+        if (!options.meshPath.empty())
+            options.batched = true;
+        return options.width > 0 && options.height > 0;
+    }
+
+    bool writePpm(const std::string& path, const std::vector<uint8_t>& rgba, uint32_t width, uint32_t height)
+    {
+        FILE* file = std::fopen(path.c_str(), "wb");
+        if (!file)
+            return false;
+        std::fprintf(file, "P6\n%u %u\n255\n", width, height);
+        for (size_t i = 0; i < rgba.size(); i += 4)
+            std::fwrite(&rgba[i], 1, 3, file);
+        return std::fclose(file) == 0;
+    }
+
+    bool writeProfile(const GpuProfiler& profiler, const std::string& path)
+    {
+        const bool json = path.size() >= 5 && path.compare(path.size() - 5, 5, ".json") == 0;
+        const bool written = json ? profiler.writeJson(path) : profiler.writeCsv(path);
+        if (written)
+            printf("GPU timings written to %s\n", path.c_str());
+        else
+            fprintf(stderr, "Could not write %s\n", path.c_str());
+        return written;
+    }
+
+    // Column major, c = a * b
+    void multiply(const float* a, const float* b, float* c)
+    {
+        for (int column = 0; column < 4; column++)
+            for (int row = 0; row < 4; row++)
+            {
+                float sum = 0.0f;
+                for (int k = 0; k < 4; k++)
+                    sum += a[k * 4 + row] * b[column * 4 + k];
+                c[column * 4 + row] = sum;
+            }
+    }
+
+    // Right handed view, Vulkan clip space with y flipped so +y is up on screen
+    void getViewProjection(const float eye[3], float aspect, float farPlane, float* viewProjection)
+    {
+        const float nearPlane = 0.1f;
+        const float focal = 1.0f / std::tan(0.5f * 1.0472f);
+        float projection[16] = {};
+        projection[0] = focal / aspect;
+        projection[5] = -focal;
+        projection[10] = farPlane / (nearPlane - farPlane);
+        projection[11] = -1.0f;
+        projection[14] = nearPlane * farPlane / (nearPlane - farPlane);
+
+        // Looking at the origin with +y up
+        const float eyeLength = std::sqrt(eye[0] * eye[0] + eye[1] * eye[1] + eye[2] * eye[2]);
+        const float forward[3] = {-eye[0] / eyeLength, -eye[1] / eyeLength, -eye[2] / eyeLength};
+        const float sideLength = std::sqrt(forward[2] * forward[2] + forward[0] * forward[0]);
+        const float side[3] = {-forward[2] / sideLength, 0.0f, forward[0] / sideLength};
+        const float up[3] = {
+            side[1] * forward[2] - side[2] * forward[1], side[2] * forward[0] - side[0] * forward[2],
+            side[0] * forward[1] - side[1] * forward[0]
+        };
+        float view[16] = {};
+        for (int i = 0; i < 3; i++)
+        {
+            view[i * 4 + 0] = side[i];
+            view[i * 4 + 1] = up[i];
+            view[i * 4 + 2] = -forward[i];
+        }
+        view[12] = -(side[0] * eye[0] + side[1] * eye[1] + side[2] * eye[2]);
+        view[13] = -(up[0] * eye[0] + up[1] * eye[1] + up[2] * eye[2]);
+        view[14] = forward[0] * eye[0] + forward[1] * eye[1] + forward[2] * eye[2];
+        view[15] = 1.0f;
+        multiply(projection, view, viewProjection);
+    }
+
+    // A cube of `count` unit cubes around the origin, the camera orbits through it so culling has work to do.
+    // Batched, the cubes stay on the host and go through the draw batcher every frame.
+    class CubeField
+    {
+    public:
+        void init(VulkanRenderer& renderer, uint32_t count, bool useBatcher)
+        {
+            batched = useBatcher;
+            std::vector<GpuScene::Vertex> vertices;
+            std::vector<uint32_t> indices;
+            for (int axis = 0; axis < 3; axis++)
+                for (float sign : {1.0f, -1.0f})
+                {
+                    // Counter clockwise seen from outside, u x v points along the face normal
+                    const int u = (axis + 1) % 3;
+                    const int v = (axis + 2) % 3;
+                    const float corners[4][2] = {{-1, -1}, {1, -1}, {1, 1}, {-1, 1}};
+                    const uint32_t base = static_cast<uint32_t>(vertices.size());
+                    for (int c = 0; c < 4; c++)
+                    {
+                        const int corner = sign > 0.0f ? c : 3 - c;
+                        GpuScene::Vertex vertex = {};
+                        vertex.position[axis] = 0.5f * sign;
+                        vertex.position[u] = 0.5f * corners[corner][0];
+                        vertex.position[v] = 0.5f * corners[corner][1];
+                        vertex.normal[axis] = sign;
+                        vertices.push_back(vertex);
+                    }
+                    for (const uint32_t index : {0u, 1u, 2u, 0u, 2u, 3u})
+                        indices.push_back(base + index);
+                }
+            MeshHandle cube;
+            if (batched)
+            {
+                const VkDeviceSize vertexSize = vertices.size() * sizeof(GpuScene::Vertex);
+                const VkDeviceSize indexSize = indices.size() * sizeof(uint32_t);
+                vertexBuffer = renderer.createBuffer(vertexSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT |
+                                                     VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                                     VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+                indexBuffer = renderer.createBuffer(indexSize, VK_BUFFER_USAGE_INDEX_BUFFER_BIT |
+                                                    VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+                renderer.getUploadManager().uploadBuffer(vertexBuffer.buffer, 0, vertices.data(), vertexSize);
+                renderer.getUploadManager().uploadBuffer(indexBuffer.buffer, 0, indices.data(), indexSize);
+                batcher.init(renderer);
+                const float white[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+                batchMaterial = batcher.addMaterial(batcher.addPipeline("batch.vert.spv", "scene.frag.spv"), white);
+                cube = batcher.addMesh(vertexBuffer.buffer, indexBuffer.buffer, 0,
+                                       static_cast<uint32_t>(indices.size()), 0);
+            }
+            else
+            {
+                scene.init(renderer, count, 16, 1024, 4096);
+                cube = scene.addMesh(vertices.data(), static_cast<uint32_t>(vertices.size()), indices.data(),
+                                     static_cast<uint32_t>(indices.size()));
+            }
+
+            side = static_cast<uint32_t>(std::ceil(std::cbrt(static_cast<double>(count))));
+            const float spacing = 2.5f;
+            const float center = 0.5f * static_cast<float>(side - 1);
+            for (uint32_t i = 0; i < count; i++)
+            {
+                const uint32_t cell[3] = {i % side, (i / side) % side, i / (side * side)};
+                float transform[16] = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1};
+                float color[4] = {0, 0, 0, 1};
+                for (int axis = 0; axis < 3; axis++)
+                {
+                    transform[12 + axis] = (static_cast<float>(cell[axis]) - center) * spacing;
+                    color[axis] = 0.2f + 0.8f * static_cast<float>(cell[axis]) / static_cast<float>(side);
+                }
+                if (batched)
+                {
+                    Instance instance = {};
+                    instance.mesh = cube;
+                    std::memcpy(instance.transform, transform, sizeof(transform));
+                    std::memcpy(instance.color, color, sizeof(color));
+                    instances.push_back(instance);
+                }
+                else
+                    scene.addObject(cube, 0, transform, color);
+            }
+            extent = static_cast<float>(side) * spacing;
+        }
+
+        void render(VulkanRenderer& renderer)
+        {
+            const VkExtent2D renderExtent = renderer.getRenderExtent();
+            const float angle = 0.005f * static_cast<float>(renderer.getFrameNumber());
+            const float eye[3] = {std::cos(angle) * extent * 0.6f, extent * 0.15f, std::sin(angle) * extent * 0.6f};
+            float viewProjection[16];
+            getViewProjection(eye, static_cast<float>(renderExtent.width) / static_cast<float>(renderExtent.height),
+                              extent * 2.0f, viewProjection);
+            if (batched)
+            {
+                batcher.setCamera(viewProjection);
+                for (const Instance& instance : instances)
+                    batcher.submit(instance.mesh, batchMaterial, instance.transform, instance.color);
+                batcher.render();
+                return;
+            }
+            scene.setCamera(viewProjection);
+            scene.render();
+        }
+
+        void destroy(VulkanRenderer& renderer)
+        {
+            scene.destroy();
+            batcher.destroy();
+            if (batched)
+            {
+                renderer.destroyBuffer(vertexBuffer);
+                renderer.destroyBuffer(indexBuffer);
+            }
+            instances.clear();
+        }
+
+        // Batched only, every cube switches to the mesh
+        void setMesh(const MeshAsset& mesh)
+        {
+            const uint32_t loaded = batcher.addMesh(mesh.vertexBuffer.buffer, mesh.indexBuffer.buffer, 0,
+                                                    mesh.indexCount, 0);
+            for (Instance& instance : instances)
+                instance.mesh = loaded;
+        }
+
+        bool isBatched() const
+        {
+            return batched;
+        }
+
+        const GpuScene& getScene() const
+        {
+            return scene;
+        }
+
+        const DrawBatcher& getBatcher() const
+        {
+            return batcher;
+        }
+
+    private:
+        struct Instance
+        {
+            uint32_t mesh;
+            float transform[16];
+            float color[4];
+        };
+
+        GpuScene scene;
+        DrawBatcher batcher;
+        bool batched = false;
+        MemoryAllocator::Buffer vertexBuffer;
+        MemoryAllocator::Buffer indexBuffer;
+        uint32_t batchMaterial = 0;
+        std::vector<Instance> instances;
+        uint32_t side = 0;
+        float extent = 0.0f;
+    };
+
+    // One streamed texture shown at an adjustable size, so its levels come and go with it
+    class TexturePreview
+    {
+    public:
+        void init(VulkanRenderer& renderer, const std::string& path)
+        {
+            streamer.init(renderer, 256ull << 20);
+            texture = streamer.load(path);
+        }
+
+        void draw(ImGuiRenderer& imgui)
+        {
+            streamer.update();
+            ImGui::Begin("Texture");
+            ImGui::SliderFloat("Size", &size, 16.0f, 2048.0f, "%.0f px");
+            // Every streamed level comes with a new view
+            const VkImageView view = streamer.getImageView(texture);
+            if (view != shownView && shownView != VK_NULL_HANDLE)
+                imgui.releaseTexture(shownView);
+            shownView = view;
+            const TextureStreamer::Statistics statistics = streamer.getStatistics();
+            ImGui::Text("Level %u resident, %llu / %llu KiB, %u streaming, %u evictions, %u failed",
+                        streamer.getResidentMip(texture),
+                        static_cast<unsigned long long>(statistics.residentBytes >> 10),
+                        static_cast<unsigned long long>(statistics.budgetBytes >> 10), statistics.streamingCount,
+                        statistics.evictionCount, statistics.failedCount);
+            if (view != VK_NULL_HANDLE)
+            {
+                ImGui::Image(imgui.getTextureId(view), ImVec2(size, size));
+                streamer.reportUsage(texture, size);
+            }
+            ImGui::End();
+        }
+
+        void destroy(ImGuiRenderer& imgui)
+        {
+            if (shownView != VK_NULL_HANDLE)
+                imgui.releaseTexture(shownView);
+            shownView = VK_NULL_HANDLE;
+            streamer.destroy();
+        }
+
+    private:
+        TextureStreamer streamer;
+        TextureHandle texture = 0;
+        VkImageView shownView = VK_NULL_HANDLE;
+        float size = 256.0f;
+    };
+
+    // Also after a failed init, every destroy() skips what was never created
+    void destroyScene(VulkanRenderer& renderer, ImGuiRenderer& imgui, AssetLoader& assets, CubeField& cubes,
+                      TexturePreview& preview)
+    {
+        cubes.destroy(renderer);
+        preview.destroy(imgui);
+        // After the cubes, their batcher draws from the loaded meshes
+        assets.destroy();
+        imgui.destroy();
+    }
+
+    void drawDiagnostics(VulkanRenderer& renderer, const FrameScheduler* scheduler, const CubeField* cubes,
+                         const AssetLoader& assets)
+    {
+        ImGui::Begin("Diagnostics");
+        ImGui::Text("%.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
+        if (scheduler)
+        {
+            ImGui::Text("Frame mode: %s (F1)", FrameScheduler::getModeName(scheduler->getMode()));
+            ImGui::Text("Present mode: %s (F2)", Swapchain::getPresentModeName(renderer.getPresentMode()));
+        }
+        else
+        {
+            ImGui::Text("Headless, frame %llu", static_cast<unsigned long long>(renderer.getFrameNumber()));
+        }
+        const UploadManager::Statistics uploads = renderer.getUploadManager().getStatistics();
+        ImGui::Text("Uploads: %llu in %llu batches, %llu stalls", static_cast<unsigned long long>(uploads.uploadCount),
+                    static_cast<unsigned long long>(uploads.batchCount),
+                    static_cast<unsigned long long>(uploads.stallCount));
+        ImGui::Text("Upload ring: %llu / %llu KiB", static_cast<unsigned long long>(uploads.ringUsed >> 10),
+                    static_cast<unsigned long long>(uploads.ringSize >> 10));
+        ImGui::Text("Recording threads: %u", renderer.getJobSystem().getThreadCount());
+        const MemoryAllocator& memory = renderer.getMemoryAllocator();
+        const std::vector<MemoryAllocator::HeapBudget> heaps = memory.getBudgets();
+        for (uint32_t i = 0; i < heaps.size(); i++)
+        {
+            ImGui::Text("Heap %u: %llu / %llu MiB%s%s", i, static_cast<unsigned long long>(heaps[i].usage >> 20),
+                        static_cast<unsigned long long>(heaps[i].budget >> 20),
+                        heaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT ? ", device local" : "",
+                        memory.isBudgetSupported() ? "" : " (estimated)");
+        }
+        const PipelineCompiler::Statistics pipelines = renderer.getPipelineCompiler().getStatistics();
+        ImGui::Text("Pipelines: %u compiled, %u pending, %u deduplicated, %u failed", pipelines.compiledCount,
+                    pipelines.pendingCount, pipelines.deduplicatedCount, pipelines.failedCount);
+        ImGui::Text("Pipeline compile: %.1f ms total, %.1f ms max", pipelines.compileMs, pipelines.maxCompileMs);
+        const ShaderLibrary::Statistics shaders = renderer.getShaderLibrary().getStatistics();
+        ImGui::Text("Shaders: %u modules, %u loads, %u cache hits, %u reloads", shaders.moduleCount,
+                    shaders.loadCount, shaders.cacheHits, shaders.reloadCount);
+        // From the previous frame, this one's graph is still being built
+        const RenderGraph::Statistics& graph = renderer.getRenderGraph().getStatistics();
+        ImGui::Text("Render graph: %u passes (%u culled), %u barriers", graph.passCount, graph.culledPassCount,
+                    graph.barrierCount);
+        ImGui::Text("Transients: %u in %llu / %llu KiB", graph.transientCount,
+                    static_cast<unsigned long long>(graph.transientBytes >> 10),
+                    static_cast<unsigned long long>(graph.unaliasedBytes >> 10));
+        if (cubes && cubes->isBatched())
+        {
+            const DrawBatcher::Statistics batches = cubes->getBatcher().getStatistics();
+            ImGui::Text("Batches: %u requests in %u draws, sorted in %.3f ms", batches.requestCount,
+                        batches.drawCount, batches.sortMs);
+            ImGui::Text("Binds: %u pipelines, %u materials, %u meshes, recorded in %u chunks", batches.pipelineBinds,
+                        batches.materialBinds, batches.meshBinds, batches.chunkCount);
+        }
+        else if (cubes)
+        {
+            const GpuScene::Statistics scene = cubes->getScene().getStatistics();
+            ImGui::Text("Scene: %u / %u objects visible, %u materials", scene.visibleCount, scene.objectCount,
+                        scene.materialCount);
+        }
+        const AssetLoader::Statistics loads = assets.getStatistics();
+        ImGui::Text("Assets: %u ready, %u loading, %u queued, %u failed, %.1f ms decoding", loads.readyCount,
+                    loads.loadingCount, loads.queuedCount, loads.failedCount, loads.decodeMs);
+        renderer.getProfiler().drawPanel();
+        ImGui::End();
+    }
+
+    // No SDL, no window and no surface: the device only needs a graphics queue, so software ICDs like lavapipe work
+    int runHeadless(const Options& options)
+    {
+        auto* renderer = new VulkanRenderer();
+        ImGuiRenderer imgui;
+        AssetLoader assets;
+        CubeField cubes;
+        TexturePreview preview;
+        try
+        {
+            renderer->createInstance(std::vector<const char*>());
+            DeviceRequirements requirements;
+            // Only the GPU scene draws indirectly, the batcher records plain draws
+            if (options.objects > 0 && !options.batched)
+                GpuScene::addRequirements(requirements);
+            renderer->createDevice(requirements);
+            SwapchainConfig config;
+            if (const char* framesInFlight = std::getenv("SOLID_FRAMES_IN_FLIGHT"))
+                config.framesInFlight = static_cast<uint32_t>(std::strtoul(framesInFlight, nullptr, 10));
+            renderer->createOffscreen(options.width, options.height, config.framesInFlight);
+            imgui.init(*renderer, nullptr);
+            if (options.objects > 0)
+                cubes.init(*renderer, options.objects, options.batched);
+            if (!options.texturePath.empty())
+                preview.init(*renderer, options.texturePath);
+            assets.init(*renderer);
+            if (options.objects > 0 && !options.meshPath.empty())
+                assets.loadMesh(options.meshPath, [&cubes](AssetHandle, const MeshAsset* mesh)
+                {
+                    if (mesh)
+                        cubes.setMesh(*mesh);
+                });
+        }
+        catch (std::exception& e)
+        {
+            fprintf(stderr, "Error: %s\n", e.what());
+            destroyScene(*renderer, imgui, assets, cubes, preview);
+            delete renderer;
+            return -3;
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < options.frames; i++)
+        {
+            if (!renderer->beginFrame())
+                continue;
+            assets.update();
+            if (options.objects > 0)
+                cubes.render(*renderer);
+            imgui.newFrame();
+            drawDiagnostics(*renderer, nullptr, options.objects > 0 ? &cubes : nullptr, assets);
+            if (!options.texturePath.empty())
+                preview.draw(imgui);
+            imgui.render();
+            if (i + 1 == options.frames && !options.readbackPath.empty())
+                renderer->requestReadback();
+            renderer->endFrame();
+        }
+        renderer->waitFor(QueueType::Graphics, renderer->getTimeline(QueueType::Graphics).getSubmittedValue());
+        const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        printf("Rendered %u frames at %ux%u in %.2f ms (%.3f ms/frame, %.1f FPS)\n", options.frames, options.width,
+               options.height, elapsed.count(), elapsed.count() / options.frames,
+               options.frames * 1000.0 / elapsed.count());
+
+        int result = 0;
+        std::vector<uint8_t> pixels;
+        if (!options.readbackPath.empty())
+        {
+            if (renderer->getReadback(pixels) && writePpm(options.readbackPath, pixels, options.width, options.height))
+                printf("Last frame written to %s\n", options.readbackPath.c_str());
+            else
+            {
+                fprintf(stderr, "Could not write %s\n", options.readbackPath.c_str());
+                result = -6;
+            }
+        }
+
+        if (!options.profilePath.empty() && !writeProfile(renderer->getProfiler(), options.profilePath))
+            result = -7;
+
+        destroyScene(*renderer, imgui, assets, cubes, preview);
+        delete renderer;
+        return result;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!parseOptions(argc, argv, options))
+        return -1;
+    if (options.headless)
+        return runHeadless(options);
+
     if (SDL_Init(SDL_INIT_VIDEO) < 0)
     {
         fprintf(stderr, "SDL could not initialize! SDL_Error: %s\n", SDL_GetError());
@@ -17,7 +536,7 @@ int main()
     }
 
     SDL_Window* window = nullptr;
-    window = SDL_CreateWindow("SDL Tutorial", SCREEN_WIDTH, SCREEN_HEIGHT,
+    window = SDL_CreateWindow("SDL Tutorial", static_cast<int>(options.width), static_cast<int>(options.height),
                               SDL_WINDOW_RESIZABLE | SDL_WINDOW_VULKAN);
     if (!window)
     {
@@ -55,33 +574,159 @@ int main()
         return -2;
     }
 
+    try
+    {
+        DeviceRequirements requirements;
+        requirements.presentSurface = surface;
+        requirements.extensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+        if (options.objects > 0 && !options.batched)
+            GpuScene::addRequirements(requirements);
+        renderer->createDevice(requirements);
+    }
+    catch (std::exception& e)
+    {
+        fprintf(stderr, "Error: %s\n", e.what());
+        vkDestroySurfaceKHR(renderer->getInstance(), surface, renderer->getAllocator());
+        delete renderer;
+        SDL_DestroyWindow(window);
+        SDL_Quit();
+        return -3;
+    }
+
     int width, height;
-    SDL_GetWindowSize(window, &width, &height);
+    SDL_GetWindowSizeInPixels(window, &width, &height);
+
+    // SOLID_PRESENT_MODE=fifo|mailbox|immediate selects the initial present mode, F2 cycles it at runtime
+    SwapchainConfig swapchainConfig;
+    Swapchain::parsePresentMode(std::getenv("SOLID_PRESENT_MODE"), swapchainConfig.presentMode);
+    if (const char* framesInFlight = std::getenv("SOLID_FRAMES_IN_FLIGHT"))
+        swapchainConfig.framesInFlight = static_cast<uint32_t>(std::strtoul(framesInFlight, nullptr, 10));
+    try
+    {
+        // From here on the renderer owns the surface
+        renderer->createSwapchain(surface, static_cast<uint32_t>(width), static_cast<uint32_t>(height),
+                                  swapchainConfig);
+    }
+    catch (std::exception& e)
+    {
+        fprintf(stderr, "Error: %s\n", e.what());
+        delete renderer;
+        SDL_DestroyWindow(window);
+        SDL_Quit();
+        return -4;
+    }
+
+    ImGuiRenderer imgui;
+    AssetLoader assets;
+    CubeField cubes;
+    TexturePreview preview;
+    try
+    {
+        imgui.init(*renderer, window);
+        if (options.objects > 0)
+            cubes.init(*renderer, options.objects, options.batched);
+        if (!options.texturePath.empty())
+            preview.init(*renderer, options.texturePath);
+        assets.init(*renderer);
+        if (options.objects > 0 && !options.meshPath.empty())
+            assets.loadMesh(options.meshPath, [&cubes](AssetHandle, const MeshAsset* mesh)
+            {
+                if (mesh)
+                    cubes.setMesh(*mesh);
+            });
+    }
+    catch (std::exception& e)
+    {
+        fprintf(stderr, "Error: %s\n", e.what());
+        destroyScene(*renderer, imgui, assets, cubes, preview);
+        delete renderer;
+        SDL_DestroyWindow(window);
+        SDL_Quit();
+        return -5;
+    }
 
-    SDL_UpdateWindowSurface(window);
-    SDL_Event e;
     bool quit = false;
 
+    // Frame mode can be switched at runtime with F1, SOLID_FRAME_MODE=idle|paced|dirty selects the initial one
+    FrameScheduler scheduler;
+    FrameScheduler::Mode frameMode;
+    if (FrameScheduler::parseMode(std::getenv("SOLID_FRAME_MODE"), frameMode))
+        scheduler.setMode(frameMode);
+    if (const char* targetFps = std::getenv("SOLID_TARGET_FPS"))
+        scheduler.setTargetFps(static_cast<uint32_t>(std::strtoul(targetFps, nullptr, 10)));
+
     // Main loop
     while (!quit)
     {
-        while (SDL_PollEvent(&e) != 0)
+        const bool render = scheduler.waitForFrame([&](const SDL_Event& e)
         {
+            // Every input can change the UI, so it always earns a frame
+            imgui.processEvent(e);
+            scheduler.markDirty();
             switch (e.type)
             {
             case SDL_EVENT_QUIT:
                 quit = true;
                 break;
+            case SDL_EVENT_WINDOW_PIXEL_SIZE_CHANGED:
+                renderer->resize(static_cast<uint32_t>(e.window.data1), static_cast<uint32_t>(e.window.data2));
+                break;
+            case SDL_EVENT_KEY_DOWN:
+                if (e.key.key == SDLK_F1)
+                    scheduler.cycleMode();
+                else if (e.key.key == SDLK_F3)
+                    writeProfile(renderer->getProfiler(),
+                                 options.profilePath.empty() ? "gpu_profile.csv" : options.profilePath);
+                else if (e.key.key == SDLK_F2)
+                {
+                    // Modes the surface lacks are skipped, requesting one would only recreate the swapchain in FIFO
+                    const VkPresentModeKHR modes[] = {VK_PRESENT_MODE_FIFO_KHR, VK_PRESENT_MODE_MAILBOX_KHR,
+                                                      VK_PRESENT_MODE_IMMEDIATE_KHR};
+                    const VkPresentModeKHR current = renderer->getPresentMode();
+                    uint32_t index = 0;
+                    while (index < 3 && modes[index] != current)
+                        index++;
+                    for (uint32_t step = 1; step <= 3; step++)
+                    {
+                        const VkPresentModeKHR next = modes[(index + step) % 3];
+                        if (next != current && renderer->isPresentModeSupported(next))
+                        {
+                            renderer->setPresentMode(next);
+                            break;
+                        }
+                    }
+                }
+                break;
             default: ;
             }
+        });
+        if (quit || !render)
+            continue;
+
+        if (!renderer->beginFrame())
+            continue;
+        assets.update();
+
+        if (options.objects > 0)
+        {
+            cubes.render(*renderer);
+            // The camera moves every frame
+            scheduler.markDirty();
         }
+        imgui.newFrame();
+        drawDiagnostics(*renderer, &scheduler, options.objects > 0 ? &cubes : nullptr, assets);
+        if (!options.texturePath.empty())
+            preview.draw(imgui);
+        imgui.render();
+        renderer->endFrame();
+        if (options.frames != 0 && renderer->getFrameNumber() >= options.frames)
+            quit = true;
     }
 
-    // Verificación antes de destruir `surface`
-    if (surface != VK_NULL_HANDLE)
-    {
-        vkDestroySurfaceKHR(renderer->getInstance(), surface, renderer->getAllocator());
-    }
+    if (!options.profilePath.empty())
+        writeProfile(renderer->getProfiler(), options.profilePath);
+    destroyScene(*renderer, imgui, assets, cubes, preview);
+    // The renderer destroys the swapchain and the surface
     delete renderer;
     SDL_DestroyWindow(window);
     SDL_Quit();
@@ -0,0 +1,38 @@
+#version 450 core
+
+#include "bindless.glsl"
+
+layout(location = 0) in vec3 aPosition;
+layout(location = 1) in vec3 aNormal;
+
+// Instance data as separate arrays of the frame's instance buffer, indexed by gl_InstanceIndex which includes the
+// draw's first instance
+BINDLESS_BUFFER(Transforms, { mat4 transforms[]; });
+BINDLESS_BUFFER(Colors, { vec4 colors[]; });
+
+layout(push_constant) uniform uPushConstant
+{
+    mat4 viewProjection;
+    vec4 materialColor;
+    uint transformBuffer;
+    uint colorBuffer;
+} pc;
+
+out gl_PerVertex
+{
+    vec4 gl_Position;
+};
+
+layout(location = 0) out struct
+{
+    vec4 Color;
+    vec3 Normal;
+} Out;
+
+void main()
+{
+    const mat4 transform = bindlessTransforms[pc.transformBuffer].transforms[gl_InstanceIndex];
+    Out.Color = bindlessColors[pc.colorBuffer].colors[gl_InstanceIndex] * pc.materialColor;
+    Out.Normal = mat3(transform) * aNormal;
+    gl_Position = pc.viewProjection * transform * vec4(aPosition, 1.0);
+}
@@ -0,0 +1,19 @@
+// Bindless resource set, must match BindlessRegistry. Include it and set BINDLESS_SET before to move it.
+#extension GL_EXT_nonuniform_qualifier : require
+
+#ifndef BINDLESS_SET
+#define BINDLESS_SET 0
+#endif
+
+layout(set = BINDLESS_SET, binding = 0) uniform texture2D bindlessTextures[];
+layout(set = BINDLESS_SET, binding = 2) uniform sampler bindlessSamplers[];
+
+// Storage buffers are declared per use, e.g. BINDLESS_BUFFER(Instances, { Instance instances[]; });
+#define BINDLESS_BUFFER(Name, Body) \
+    layout(set = BINDLESS_SET, binding = 1) readonly buffer Name Body bindless##Name[]
+
+vec4 sampleBindless(uint textureIndex, uint samplerIndex, vec2 uv)
+{
+    return texture(sampler2D(bindlessTextures[nonuniformEXT(textureIndex)],
+                             bindlessSamplers[nonuniformEXT(samplerIndex)]), uv);
+}
@@ -0,0 +1,16 @@
+#version 450 core
+
+layout(location = 0) out vec4 fColor;
+
+layout(location = 0) in struct
+{
+    vec4 Color;
+    vec3 Normal;
+} In;
+
+void main()
+{
+    const vec3 light = normalize(vec3(0.4, 0.8, 0.5));
+    const float diffuse = max(dot(normalize(In.Normal), light), 0.0);
+    fColor = vec4(In.Color.rgb * (0.25 + 0.75 * diffuse), In.Color.a);
+}
@@ -0,0 +1,34 @@
+// Shared by the GPU scene shaders, mirrors the structs of src/GpuScene.cpp
+
+struct ObjectData
+{
+    mat4 transform;
+    vec4 color;
+    uint mesh;
+    uint bucket;
+    // Largest axis scale of the transform, scales the mesh bounding sphere
+    float radiusScale;
+    // 0 for removed objects
+    uint enabled;
+};
+
+struct MeshData
+{
+    // Bounding sphere, center in xyz and radius in w
+    vec4 sphere;
+    uint indexCount;
+    uint firstIndex;
+    int vertexOffset;
+    uint padding;
+};
+
+struct DrawCommand
+{
+    uint indexCount;
+    uint instanceCount;
+    uint firstIndex;
+    int vertexOffset;
+    uint firstInstance;
+};
+
+#define MAX_BUCKETS 64
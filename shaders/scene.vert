@@ -0,0 +1,36 @@
+#version 450 core
+
+#include "scene.glsl"
+
+layout(location = 0) in vec3 aPosition;
+layout(location = 1) in vec3 aNormal;
+
+layout(set = 0, binding = 0) readonly buffer Objects
+{
+    ObjectData objects[];
+};
+
+layout(push_constant) uniform uPushConstant
+{
+    mat4 viewProjection;
+} pc;
+
+out gl_PerVertex
+{
+    vec4 gl_Position;
+};
+
+layout(location = 0) out struct
+{
+    vec4 Color;
+    vec3 Normal;
+} Out;
+
+void main()
+{
+    const ObjectData object = objects[gl_InstanceIndex];
+    Out.Color = object.color;
+    // Uniform scale is all the scene uses, the normal matrix is the transform itself
+    Out.Normal = mat3(object.transform) * aNormal;
+    gl_Position = pc.viewProjection * object.transform * vec4(aPosition, 1.0);
+}
@@ -0,0 +1,571 @@
+//
+// Created by Batur on 18/10/2026.
+//
+
+#include "AssetLoader.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "DebugConfig.h"
+#include "VulkanRenderer.h"
+
+namespace
+{
+    constexpr uint32_t VERTEX_FLOATS = 6;
+
+    std::vector<char> readFile(const std::string& path)
+    {
+        FILE* file = std::fopen(path.c_str(), "rb");
+        if (!file)
+        {
+            throw std::runtime_error("[Vulkan] Asset not found: " + path);
+        }
+        std::fseek(file, 0, SEEK_END);
+        const long size = std::ftell(file);
+        std::fseek(file, 0, SEEK_SET);
+        std::vector<char> data(size > 0 ? static_cast<size_t>(size) : 0);
+        const size_t read = data.empty() ? 0 : std::fread(data.data(), 1, data.size(), file);
+        std::fclose(file);
+        if (size <= 0 || read != data.size())
+        {
+            throw std::runtime_error("[Vulkan] Failed to read asset: " + path);
+        }
+        return data;
+    }
+
+    // OBJ index as zero based, negative ones count back from the last element
+    bool resolveIndex(long index, size_t count, uint32_t& result)
+    {
+        const long resolved = index < 0 ? static_cast<long>(count) + index : index - 1;
+        if (resolved < 0 || resolved >= static_cast<long>(count))
+            return false;
+        result = static_cast<uint32_t>(resolved);
+        return true;
+    }
+
+    // Positions, normals and faces of any polygon count. Corners sharing position and normal become one vertex,
+    // vertices without a normal get the area weighted normal of their faces.
+    void decodeObj(const std::vector<char>& text, const std::string& path, std::vector<float>& vertices,
+                   std::vector<uint32_t>& indices)
+    {
+        std::vector<float> positions;
+        std::vector<float> normals;
+        std::unordered_map<uint64_t, uint32_t> corners;
+        std::vector<bool> missingNormals;
+        std::vector<uint32_t> polygon;
+        std::string line;
+        size_t lineNumber = 0;
+        for (size_t start = 0; start < text.size();)
+        {
+            size_t end = start;
+            while (end < text.size() && text[end] != '\n')
+                end++;
+            line.assign(text.data() + start, end - start);
+            start = end + 1;
+            lineNumber++;
+
+            const char* cursor = line.c_str();
+            while (*cursor == ' ' || *cursor == '\t')
+                cursor++;
+            if (cursor[0] == 'v' && (cursor[1] == ' ' || cursor[1] == '\t'))
+            {
+                float position[3] = {};
+                if (std::sscanf(cursor + 2, "%f %f %f", &position[0], &position[1], &position[2]) != 3)
+                    throw std::runtime_error("[Vulkan] Bad vertex in " + path + ":" + std::to_string(lineNumber));
+                positions.insert(positions.end(), position, position + 3);
+            }
+            else if (cursor[0] == 'v' && cursor[1] == 'n')
+            {
+                float normal[3] = {};
+                if (std::sscanf(cursor + 2, "%f %f %f", &normal[0], &normal[1], &normal[2]) != 3)
+                    throw std::runtime_error("[Vulkan] Bad normal in " + path + ":" + std::to_string(lineNumber));
+                normals.insert(normals.end(), normal, normal + 3);
+            }
+            else if (cursor[0] == 'f' && (cursor[1] == ' ' || cursor[1] == '\t'))
+            {
+                // Corners are v, v/vt, v//vn or v/vt/vn, texture coordinates are not used
+                polygon.clear();
+                char* token = const_cast<char*>(cursor + 1);
+                for (;;)
+                {
+                    while (*token == ' ' || *token == '\t' || *token == '\r')
+                        token++;
+                    if (*token == '\0')
+                        break;
+                    char* next;
+                    uint32_t position;
+                    uint32_t normal = UINT32_MAX;
+                    if (!resolveIndex(std::strtol(token, &next, 10), positions.size() / 3, position))
+                        throw std::runtime_error("[Vulkan] Bad face in " + path + ":" + std::to_string(lineNumber));
+                    if (*next == '/')
+                    {
+                        std::strtol(next + 1, &next, 10);
+                        if (*next == '/' && !resolveIndex(std::strtol(next + 1, &next, 10), normals.size() / 3,
+                                                          normal))
+                            throw std::runtime_error("[Vulkan] Bad face in " + path + ":" +
+                                std::to_string(lineNumber));
+                    }
+                    token = next;
+
+                    const uint64_t key = static_cast<uint64_t>(position) << 32 | normal;
+                    const auto corner = corners.find(key);
+                    if (corner != corners.end())
+                    {
+                        polygon.push_back(corner->second);
+                        continue;
+                    }
+                    const uint32_t vertex = static_cast<uint32_t>(vertices.size() / VERTEX_FLOATS);
+                    vertices.insert(vertices.end(), &positions[position * 3], &positions[position * 3] + 3);
+                    if (normal != UINT32_MAX)
+                        vertices.insert(vertices.end(), &normals[normal * 3], &normals[normal * 3] + 3);
+                    else
+                        vertices.insert(vertices.end(), 3, 0.0f);
+                    missingNormals.push_back(normal == UINT32_MAX);
+                    corners.emplace(key, vertex);
+                    polygon.push_back(vertex);
+                }
+                // Fan triangulation, fine for the convex polygons exporters write
+                for (size_t i = 2; i < polygon.size(); i++)
+                {
+                    indices.push_back(polygon[0]);
+                    indices.push_back(polygon[i - 1]);
+                    indices.push_back(polygon[i]);
+                }
+            }
+        }
+        if (indices.empty())
+        {
+            throw std::runtime_error("[Vulkan] No faces in " + path);
+        }
+
+        for (size_t i = 0; i < indices.size(); i += 3)
+        {
+            float* a = &vertices[indices[i] * VERTEX_FLOATS];
+            float* b = &vertices[indices[i + 1] * VERTEX_FLOATS];
+            float* c = &vertices[indices[i + 2] * VERTEX_FLOATS];
+            const float u[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+            const float v[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+            const float normal[3] = {u[1] * v[2] - u[2] * v[1], u[2] * v[0] - u[0] * v[2], u[0] * v[1] - u[1] * v[0]};
+            for (const uint32_t index : {indices[i], indices[i + 1], indices[i + 2]})
+                if (missingNormals[index])
+                    for (int axis = 0; axis < 3; axis++)
+                        vertices[index * VERTEX_FLOATS + 3 + axis] += normal[axis];
+        }
+        for (size_t vertex = 0; vertex < missingNormals.size(); vertex++)
+        {
+            if (!missingNormals[vertex])
+                continue;
+            float* normal = &vertices[vertex * VERTEX_FLOATS + 3];
+            const float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+            if (length > 0.0f)
+                for (int axis = 0; axis < 3; axis++)
+                    normal[axis] /= length;
+        }
+    }
+
+    // Binary PPM (P6) with 8-bit samples, expanded to RGBA
+    void decodePpm(const std::vector<char>& data, const std::string& path, uint32_t& width, uint32_t& height,
+                   std::vector<uint8_t>& pixels)
+    {
+        // Header fields are separated by whitespace, comments run to the end of the line
+        size_t offset = 2;
+        uint32_t fields[3] = {};
+        for (uint32_t& field : fields)
+        {
+            for (;;)
+            {
+                while (offset < data.size() && std::isspace(static_cast<unsigned char>(data[offset])))
+                    offset++;
+                if (offset >= data.size() || data[offset] != '#')
+                    break;
+                while (offset < data.size() && data[offset] != '\n')
+                    offset++;
+            }
+            uint32_t value = 0;
+            const size_t digits = offset;
+            while (offset < data.size() && data[offset] >= '0' && data[offset] <= '9' && value < 1000000)
+                value = value * 10 + static_cast<uint32_t>(data[offset++] - '0');
+            if (offset == digits)
+                throw std::runtime_error("[Vulkan] Bad PPM header in " + path);
+            field = value;
+        }
+        // A single whitespace character separates the header from the samples
+        offset++;
+        width = fields[0];
+        height = fields[1];
+        const size_t pixelCount = static_cast<size_t>(width) * height;
+        if (data.size() < 2 || data[0] != 'P' || data[1] != '6' || fields[2] == 0 || fields[2] > 255 ||
+            pixelCount == 0 || offset > data.size() || data.size() - offset < pixelCount * 3)
+        {
+            throw std::runtime_error("[Vulkan] Unsupported PPM " + path);
+        }
+
+        pixels.resize(pixelCount * 4);
+        const uint8_t* samples = reinterpret_cast<const uint8_t*>(data.data() + offset);
+        for (size_t i = 0; i < pixelCount; i++)
+        {
+            for (int channel = 0; channel < 3; channel++)
+                pixels[i * 4 + channel] = static_cast<uint8_t>(samples[i * 3 + channel] * 255u / fields[2]);
+            pixels[i * 4 + 3] = 255;
+        }
+    }
+}
+
+void AssetLoader::init(VulkanRenderer& vulkanRenderer)
+{
+    renderer = &vulkanRenderer;
+    device = renderer->getDevice();
+    allocator = renderer->getAllocator();
+}
+
+void AssetLoader::destroy()
+{
+    if (!renderer)
+        return;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        loadsDone.wait(lock, [this]
+        {
+            return activeJobs == 0;
+        });
+    }
+    vkDeviceWaitIdle(device);
+
+    // Results nobody collected still own their resources
+    for (Result& result : results)
+    {
+        Asset asset;
+        asset.mesh = result.mesh;
+        asset.texture = result.texture;
+        free(asset);
+    }
+    results.clear();
+    for (Asset& asset : assets)
+    {
+        if (asset.live && asset.state == AssetState::Ready && asset.type == Type::Texture)
+            renderer->getBindless().releaseImage(asset.texture.bindlessIndex);
+        free(asset);
+    }
+    for (Retired& old : retired)
+        free(old.asset);
+    assets.clear();
+    freeAssets.clear();
+    queue.clear();
+    retired.clear();
+    activeLoads = 0;
+    statistics = {};
+    renderer = nullptr;
+}
+
+AssetHandle AssetLoader::loadMesh(const std::string& path, const MeshCallback& callback)
+{
+    const AssetHandle handle = add(Type::Mesh, path);
+    assets[handle].meshCallback = callback;
+    return handle;
+}
+
+AssetHandle AssetLoader::loadTexture(const std::string& path, const TextureCallback& callback)
+{
+    const AssetHandle handle = add(Type::Texture, path);
+    assets[handle].textureCallback = callback;
+    return handle;
+}
+
+void AssetLoader::unload(AssetHandle handle)
+{
+    Asset& asset = assets.at(handle);
+    if (!asset.live || asset.unloading)
+        return;
+    switch (asset.state)
+    {
+    case AssetState::Queued:
+        queue.erase(std::find(queue.begin(), queue.end(), handle));
+        release(handle);
+        break;
+    case AssetState::Loading:
+        // The worker still writes its result, or the upload has not landed yet
+        asset.unloading = true;
+        if (asset.finishFrame != UINT64_MAX)
+        {
+            // The copies go out with the frame after the one that collected the result
+            retired.push_back({asset, asset.finishFrame + 1});
+            release(handle);
+        }
+        break;
+    case AssetState::Ready:
+        // Frames in flight may still read it
+        if (asset.type == Type::Texture)
+            renderer->getBindless().releaseImage(asset.texture.bindlessIndex);
+        retired.push_back({asset, renderer->getFrameNumber()});
+        release(handle);
+        break;
+    case AssetState::Failed:
+        release(handle);
+        break;
+    }
+}
+
+AssetState AssetLoader::getState(AssetHandle handle) const
+{
+    return assets.at(handle).state;
+}
+
+const MeshAsset* AssetLoader::getMesh(AssetHandle handle) const
+{
+    const Asset& asset = assets.at(handle);
+    return asset.type == Type::Mesh && asset.state == AssetState::Ready ? &asset.mesh : nullptr;
+}
+
+const TextureAsset* AssetLoader::getTexture(AssetHandle handle) const
+{
+    const Asset& asset = assets.at(handle);
+    return asset.type == Type::Texture && asset.state == AssetState::Ready ? &asset.texture : nullptr;
+}
+
+void AssetLoader::update()
+{
+    const uint64_t frameNumber = renderer->getFrameNumber();
+    const uint64_t framesInFlight = renderer->getFramesInFlight();
+
+    // Uploads staged before this point are submitted by the next beginFrame() at the latest, and acquired by the
+    // frame it begins, so resources they write are retired with that frame
+    const uint64_t uploadFrame = frameNumber + 1;
+    std::vector<Result> finished;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        finished.swap(results);
+    }
+    for (const Result& result : finished)
+    {
+        Asset& asset = assets[result.handle];
+        activeLoads--;
+        statistics.loadedBytes += result.bytes;
+        statistics.decodeMs += result.decodeMs;
+        asset.mesh = result.mesh;
+        asset.texture = result.texture;
+        if (asset.unloading)
+        {
+            retired.push_back({asset, uploadFrame});
+            release(result.handle);
+        }
+        else if (!result.success)
+        {
+            retired.push_back({asset, uploadFrame});
+            asset.mesh = {};
+            asset.texture = {};
+            // Copies, the callbacks may add assets and move this one
+            asset.state = AssetState::Failed;
+            const MeshCallback meshCallback = asset.meshCallback;
+            const TextureCallback textureCallback = asset.textureCallback;
+            if (meshCallback)
+                meshCallback(result.handle, nullptr);
+            if (textureCallback)
+                textureCallback(result.handle, nullptr);
+        }
+        else
+            asset.finishFrame = frameNumber;
+    }
+
+    // Indexed, callbacks may load or unload, which can move the assets
+    for (AssetHandle handle = 0; handle < assets.size(); handle++)
+        if (assets[handle].live && assets[handle].state == AssetState::Loading &&
+            assets[handle].finishFrame < frameNumber)
+            complete(assets[handle], handle);
+
+    for (size_t i = 0; i < retired.size();)
+    {
+        if (retired[i].frameNumber + framesInFlight <= frameNumber)
+        {
+            free(retired[i].asset);
+            retired[i] = retired.back();
+            retired.pop_back();
+            continue;
+        }
+        i++;
+    }
+
+    while (activeLoads < MAX_ACTIVE_LOADS && !queue.empty())
+    {
+        const AssetHandle handle = queue.front();
+        queue.pop_front();
+        Asset& asset = assets[handle];
+        asset.state = AssetState::Loading;
+        activeLoads++;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            activeJobs++;
+        }
+        renderer->getJobSystem().enqueue([this, handle, type = asset.type, path = asset.path](uint32_t)
+        {
+            load(handle, type, path);
+        });
+    }
+}
+
+AssetLoader::Statistics AssetLoader::getStatistics() const
+{
+    Statistics result = statistics;
+    for (const Asset& asset : assets)
+    {
+        if (!asset.live)
+            continue;
+        result.queuedCount += asset.state == AssetState::Queued;
+        result.loadingCount += asset.state == AssetState::Loading;
+        result.readyCount += asset.state == AssetState::Ready;
+        result.failedCount += asset.state == AssetState::Failed;
+    }
+    return result;
+}
+
+AssetHandle AssetLoader::add(Type type, const std::string& path)
+{
+    Asset asset;
+    asset.type = type;
+    asset.path = path;
+    asset.live = true;
+    AssetHandle handle;
+    if (!freeAssets.empty())
+    {
+        handle = freeAssets.back();
+        freeAssets.pop_back();
+        assets[handle] = asset;
+    }
+    else
+    {
+        handle = static_cast<AssetHandle>(assets.size());
+        assets.push_back(asset);
+    }
+    queue.push_back(handle);
+    return handle;
+}
+
+void AssetLoader::load(AssetHandle handle, Type type, const std::string& path)
+{
+    const auto start = std::chrono::steady_clock::now();
+    Result result = {};
+    result.handle = handle;
+    try
+    {
+        const std::vector<char> data = readFile(path);
+        result.bytes = data.size();
+        UploadManager& uploads = renderer->getUploadManager();
+        if (type == Type::Mesh)
+        {
+            std::vector<float> vertices;
+            std::vector<uint32_t> indices;
+            decodeObj(data, path, vertices, indices);
+            const VkDeviceSize vertexSize = vertices.size() * sizeof(float);
+            const VkDeviceSize indexSize = indices.size() * sizeof(uint32_t);
+            result.mesh.vertexCount = static_cast<uint32_t>(vertices.size() / VERTEX_FLOATS);
+            result.mesh.indexCount = static_cast<uint32_t>(indices.size());
+            result.mesh.vertexBuffer = renderer->createBuffer(
+                vertexSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+            result.mesh.indexBuffer = renderer->createBuffer(
+                indexSize, VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+            uploads.uploadBuffer(result.mesh.vertexBuffer.buffer, 0, vertices.data(), vertexSize);
+            uploads.uploadBuffer(result.mesh.indexBuffer.buffer, 0, indices.data(), indexSize);
+        }
+        else
+        {
+            std::vector<uint8_t> pixels;
+            decodePpm(data, path, result.texture.width, result.texture.height, pixels);
+            VkImageCreateInfo imageInfo = {};
+            imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+            imageInfo.imageType = VK_IMAGE_TYPE_2D;
+            imageInfo.format = VK_FORMAT_R8G8B8A8_UNORM;
+            imageInfo.extent = {result.texture.width, result.texture.height, 1};
+            imageInfo.mipLevels = 1;
+            imageInfo.arrayLayers = 1;
+            imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+            imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+            imageInfo.usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+            imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+            imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+            result.texture.image = renderer->createImage(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+            result.texture.bindlessIndex = UINT32_MAX;
+
+            const VkImageSubresourceRange range = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+            VkImageViewCreateInfo viewInfo = {};
+            viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+            viewInfo.image = result.texture.image.image;
+            viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+            viewInfo.format = imageInfo.format;
+            viewInfo.subresourceRange = range;
+            if (vkCreateImageView(device, &viewInfo, allocator, &result.texture.view) != VK_SUCCESS)
+            {
+                throw std::runtime_error("[Vulkan] Failed to create image view for " + path);
+            }
+            VkBufferImageCopy region = {};
+            region.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+            region.imageExtent = imageInfo.extent;
+            uploads.uploadImage(result.texture.image.image, range, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                pixels.data(), pixels.size(), &region, 1);
+        }
+        result.success = true;
+    }
+    catch (const std::exception& e)
+    {
+        // Copies into what was created may already be queued, the frame thread retires it
+        DebugConfig::warning("%s", e.what());
+    }
+    const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    result.decodeMs = elapsed.count();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    results.push_back(result);
+    activeJobs--;
+    loadsDone.notify_all();
+}
+
+void AssetLoader::complete(Asset& asset, AssetHandle handle)
+{
+    asset.state = AssetState::Ready;
+    asset.finishFrame = UINT64_MAX;
+    DebugConfig::verbose("[Vulkan] Asset %s loaded", asset.path.c_str());
+    if (asset.type == Type::Texture)
+    {
+        asset.texture.bindlessIndex = renderer->getBindless().registerImage(asset.texture.view);
+        if (asset.textureCallback)
+        {
+            // Copies, the callback may add assets and move this one
+            const TextureCallback callback = asset.textureCallback;
+            const TextureAsset texture = asset.texture;
+            callback(handle, &texture);
+        }
+    }
+    else if (asset.meshCallback)
+    {
+        const MeshCallback callback = asset.meshCallback;
+        const MeshAsset mesh = asset.mesh;
+        callback(handle, &mesh);
+    }
+}
+
+void AssetLoader::free(Asset& asset)
+{
+    renderer->destroyBuffer(asset.mesh.vertexBuffer);
+    renderer->destroyBuffer(asset.mesh.indexBuffer);
+    if (asset.texture.view != VK_NULL_HANDLE)
+    {
+        renderer->getDescriptorCache().invalidateImageView(asset.texture.view);
+        vkDestroyImageView(device, asset.texture.view, allocator);
+    }
+    asset.texture.view = VK_NULL_HANDLE;
+    renderer->destroyImage(asset.texture.image);
+}
+
+void AssetLoader::release(AssetHandle handle)
+{
+    assets[handle] = Asset();
+    freeAssets.push_back(handle);
+}
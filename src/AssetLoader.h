@@ -0,0 +1,158 @@
+//
+// Created by Batur on 18/10/2026.
+//
+
+#ifndef ASSETLOADER_H
+#define ASSETLOADER_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+#include "MemoryAllocator.h"
+
+class VulkanRenderer;
+
+// Index of the asset, recycled after unload()
+using AssetHandle = uint32_t;
+
+enum class AssetState
+{
+    Queued,
+    Loading,
+    Ready,
+    Failed,
+};
+
+// Indexed triangles, vertices are three floats of position followed by three of normal like GpuScene::Vertex
+struct MeshAsset
+{
+    MemoryAllocator::Buffer vertexBuffer;
+    MemoryAllocator::Buffer indexBuffer;
+    uint32_t vertexCount;
+    uint32_t indexCount;
+};
+
+// RGBA8 image in VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+struct TextureAsset
+{
+    MemoryAllocator::Image image;
+    VkImageView view;
+    uint32_t bindlessIndex;
+    uint32_t width;
+    uint32_t height;
+};
+
+// Loads meshes (Wavefront OBJ) and textures (binary PPM) off the frame.
+// Reading, parsing and decoding run on the job system, a few files at a time, and the results are staged through
+// the upload manager, whose transfer batches go out with the next frame. update() hands over what has landed: the
+// asset turns Ready and its callback runs on the calling thread, with everything bindable. A file that fails
+// to load turns Failed and gets its callback with null. Not thread safe, the workers only report back.
+class AssetLoader
+{
+public:
+    // Files read and decoded at the same time
+    static constexpr uint32_t MAX_ACTIVE_LOADS = 4;
+
+    using MeshCallback = std::function<void(AssetHandle handle, const MeshAsset* mesh)>;
+    using TextureCallback = std::function<void(AssetHandle handle, const TextureAsset* texture)>;
+
+    struct Statistics
+    {
+        uint32_t queuedCount;
+        uint32_t loadingCount;
+        uint32_t readyCount;
+        uint32_t failedCount;
+        // File bytes read and decoded, and the time the workers spent on it
+        uint64_t loadedBytes;
+        double decodeMs;
+    };
+
+    void init(VulkanRenderer& renderer);
+    // Waits for the loads in progress
+    void destroy();
+
+    AssetHandle loadMesh(const std::string& path, const MeshCallback& callback = MeshCallback());
+    AssetHandle loadTexture(const std::string& path, const TextureCallback& callback = TextureCallback());
+    // Frees the GPU resources, a load in progress is dropped once it finishes
+    void unload(AssetHandle handle);
+
+    AssetState getState(AssetHandle handle) const;
+    // Null unless the asset is Ready
+    const MeshAsset* getMesh(AssetHandle handle) const;
+    const TextureAsset* getTexture(AssetHandle handle) const;
+
+    // Starts queued loads and completes the ones that landed. Called every frame between beginFrame() and
+    // endFrame(), callbacks run from here.
+    void update();
+    Statistics getStatistics() const;
+
+private:
+    enum class Type
+    {
+        Mesh,
+        Texture,
+    };
+
+    struct Asset
+    {
+        Type type = Type::Mesh;
+        AssetState state = AssetState::Queued;
+        std::string path;
+        MeshAsset mesh = {};
+        TextureAsset texture = {};
+        MeshCallback meshCallback;
+        TextureCallback textureCallback;
+        // Frame that saw the worker finish, the uploads are visible to the frames after it
+        uint64_t finishFrame = UINT64_MAX;
+        bool unloading = false;
+        bool live = false;
+    };
+
+    // What a worker produced, handed over under the lock
+    struct Result
+    {
+        AssetHandle handle;
+        bool success;
+        MeshAsset mesh;
+        TextureAsset texture;
+        uint64_t bytes;
+        double decodeMs;
+    };
+
+    struct Retired
+    {
+        Asset asset;
+        // Last frame that may use it, it is freed once that frame completed
+        uint64_t frameNumber;
+    };
+
+    VulkanRenderer* renderer = nullptr;
+    VkDevice device = VK_NULL_HANDLE;
+    const VkAllocationCallbacks* allocator = nullptr;
+
+    std::vector<Asset> assets;
+    std::vector<AssetHandle> freeAssets;
+    std::deque<AssetHandle> queue;
+    std::vector<Retired> retired;
+    uint32_t activeLoads = 0;
+    Statistics statistics = {};
+
+    std::mutex mutex;
+    std::condition_variable loadsDone;
+    uint32_t activeJobs = 0;
+    std::vector<Result> results;
+
+    AssetHandle add(Type type, const std::string& path);
+    // Runs on a worker, every resource it creates ends up in the result
+    void load(AssetHandle handle, Type type, const std::string& path);
+    void complete(Asset& asset, AssetHandle handle);
+    void free(Asset& asset);
+    void release(AssetHandle handle);
+};
+
+#endif //ASSETLOADER_H
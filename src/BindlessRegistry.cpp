@@ -0,0 +1,282 @@
+//
+// Created by Batur on 18/10/2026.
+//
+
+#include "BindlessRegistry.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+#include "DebugConfig.h"
+#include "DeviceSelector.h"
+#include "VulkanRenderer.h"
+
+constexpr uint32_t BindlessRegistry::SAMPLED_IMAGE_BINDING;
+constexpr uint32_t BindlessRegistry::STORAGE_BUFFER_BINDING;
+constexpr uint32_t BindlessRegistry::SAMPLER_BINDING;
+constexpr uint32_t BindlessRegistry::INVALID_INDEX;
+
+namespace
+{
+    const char* const BINDING_NAMES[] = {"sampled image", "storage buffer", "sampler"};
+    const VkDescriptorType BINDING_TYPES[] = {
+        VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_DESCRIPTOR_TYPE_SAMPLER
+    };
+}
+
+void BindlessRegistry::addRequirements(DeviceRequirements& requirements)
+{
+    // Buffers are indexed with dynamically uniform indices, like pushed ones
+    requirements.features.shaderStorageBufferArrayDynamicIndexing = VK_TRUE;
+    VkPhysicalDeviceVulkan12Features& features = requirements.features12;
+    features.descriptorIndexing = VK_TRUE;
+    features.runtimeDescriptorArray = VK_TRUE;
+    features.descriptorBindingPartiallyBound = VK_TRUE;
+    features.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+    // Covers samplers as well as sampled images
+    features.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+    features.descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE;
+    features.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+    features.shaderStorageBufferArrayNonUniformIndexing = VK_TRUE;
+}
+
+void BindlessRegistry::init(VulkanRenderer& vulkanRenderer, uint32_t sampledImages, uint32_t storageBuffers,
+                            uint32_t samplers)
+{
+    renderer = &vulkanRenderer;
+    device = renderer->getDevice();
+    allocator = renderer->getAllocator();
+
+    VkPhysicalDeviceVulkan12Properties properties12 = {};
+    properties12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_PROPERTIES;
+    VkPhysicalDeviceProperties2 properties2 = {};
+    properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+    properties2.pNext = &properties12;
+    vkGetPhysicalDeviceProperties2(renderer->getPhysicalDevice(), &properties2);
+
+    slots[SAMPLED_IMAGE_BINDING].capacity = std::min({
+        sampledImages, properties12.maxDescriptorSetUpdateAfterBindSampledImages,
+        properties12.maxPerStageDescriptorUpdateAfterBindSampledImages
+    });
+    slots[STORAGE_BUFFER_BINDING].capacity = std::min({
+        storageBuffers, properties12.maxDescriptorSetUpdateAfterBindStorageBuffers,
+        properties12.maxPerStageDescriptorUpdateAfterBindStorageBuffers
+    });
+    slots[SAMPLER_BINDING].capacity = std::min({
+        samplers, properties12.maxDescriptorSetUpdateAfterBindSamplers,
+        properties12.maxPerStageDescriptorUpdateAfterBindSamplers
+    });
+
+    // Partially bound: unused indices may hold anything. Update unused while pending: registering a resource
+    // never waits for the frames that have the set bound.
+    const VkDescriptorBindingFlags bindingFlags = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT |
+        VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT;
+    VkDescriptorSetLayoutBinding bindings[3] = {};
+    VkDescriptorBindingFlags flags[3] = {};
+    VkDescriptorPoolSize poolSizes[3] = {};
+    for (uint32_t b = 0; b < 3; b++)
+    {
+        bindings[b].binding = b;
+        bindings[b].descriptorType = BINDING_TYPES[b];
+        bindings[b].descriptorCount = slots[b].capacity;
+        bindings[b].stageFlags = VK_SHADER_STAGE_ALL;
+        flags[b] = bindingFlags;
+        poolSizes[b] = {BINDING_TYPES[b], slots[b].capacity};
+    }
+
+    VkDescriptorSetLayoutBindingFlagsCreateInfo flagsInfo = {};
+    flagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+    flagsInfo.bindingCount = 3;
+    flagsInfo.pBindingFlags = flags;
+    VkDescriptorSetLayoutCreateInfo layoutInfo = {};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.pNext = &flagsInfo;
+    layoutInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+    layoutInfo.bindingCount = 3;
+    layoutInfo.pBindings = bindings;
+    if (vkCreateDescriptorSetLayout(device, &layoutInfo, allocator, &layout) != VK_SUCCESS)
+    {
+        throw std::runtime_error("[Vulkan] Failed to create bindless descriptor set layout!");
+    }
+
+    VkDescriptorPoolCreateInfo poolInfo = {};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+    poolInfo.maxSets = 1;
+    poolInfo.poolSizeCount = 3;
+    poolInfo.pPoolSizes = poolSizes;
+    if (vkCreateDescriptorPool(device, &poolInfo, allocator, &pool) != VK_SUCCESS)
+    {
+        throw std::runtime_error("[Vulkan] Failed to create bindless descriptor pool!");
+    }
+
+    VkDescriptorSetAllocateInfo setInfo = {};
+    setInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    setInfo.descriptorPool = pool;
+    setInfo.descriptorSetCount = 1;
+    setInfo.pSetLayouts = &layout;
+    if (vkAllocateDescriptorSets(device, &setInfo, &set) != VK_SUCCESS)
+    {
+        throw std::runtime_error("[Vulkan] Failed to allocate bindless descriptor set!");
+    }
+    DebugConfig::verbose("[Vulkan] Bindless set: %u sampled images, %u storage buffers, %u samplers",
+                         slots[SAMPLED_IMAGE_BINDING].capacity, slots[STORAGE_BUFFER_BINDING].capacity,
+                         slots[SAMPLER_BINDING].capacity);
+}
+
+void BindlessRegistry::destroy()
+{
+    if (!renderer)
+        return;
+    // Destroying the pool frees the set
+    vkDestroyDescriptorPool(device, pool, allocator);
+    vkDestroyDescriptorSetLayout(device, layout, allocator);
+    pool = VK_NULL_HANDLE;
+    layout = VK_NULL_HANDLE;
+    set = VK_NULL_HANDLE;
+    for (Slots& binding : slots)
+        binding = Slots();
+    renderer = nullptr;
+}
+
+uint32_t BindlessRegistry::registerImage(VkImageView imageView, VkImageLayout imageLayout)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    const uint32_t index = allocate(SAMPLED_IMAGE_BINDING);
+    VkDescriptorImageInfo imageInfo = {VK_NULL_HANDLE, imageView, imageLayout};
+    write(SAMPLED_IMAGE_BINDING, index, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, &imageInfo, nullptr);
+    return index;
+}
+
+uint32_t BindlessRegistry::registerBuffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    const uint32_t index = allocate(STORAGE_BUFFER_BINDING);
+    VkDescriptorBufferInfo bufferInfo = {buffer, offset, range};
+    write(STORAGE_BUFFER_BINDING, index, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, nullptr, &bufferInfo);
+    return index;
+}
+
+uint32_t BindlessRegistry::registerSampler(VkSampler sampler)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    const uint32_t index = allocate(SAMPLER_BINDING);
+    VkDescriptorImageInfo imageInfo = {sampler, VK_NULL_HANDLE, VK_IMAGE_LAYOUT_UNDEFINED};
+    write(SAMPLER_BINDING, index, VK_DESCRIPTOR_TYPE_SAMPLER, &imageInfo, nullptr);
+    return index;
+}
+
+void BindlessRegistry::releaseImage(uint32_t index)
+{
+    release(SAMPLED_IMAGE_BINDING, index);
+}
+
+void BindlessRegistry::releaseBuffer(uint32_t index)
+{
+    release(STORAGE_BUFFER_BINDING, index);
+}
+
+void BindlessRegistry::releaseSampler(uint32_t index)
+{
+    release(SAMPLER_BINDING, index);
+}
+
+void BindlessRegistry::collect()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!renderer)
+        return;
+    // Same rule as the renderer's deferred frees: every frame that could read the index has been waited for
+    const uint64_t frameNumber = renderer->getFrameNumber();
+    const uint64_t framesInFlight = renderer->getFramesInFlight();
+    for (Slots& binding : slots)
+    {
+        for (size_t i = 0; i < binding.pendingFrees.size();)
+        {
+            if (binding.pendingFrees[i].second + framesInFlight > frameNumber)
+            {
+                i++;
+                continue;
+            }
+            binding.freeIndices.push_back(binding.pendingFrees[i].first);
+            binding.pendingFrees[i] = binding.pendingFrees.back();
+            binding.pendingFrees.pop_back();
+        }
+    }
+}
+
+VkDescriptorSetLayout BindlessRegistry::getLayout() const
+{
+    return layout;
+}
+
+VkDescriptorSet BindlessRegistry::getSet() const
+{
+    return set;
+}
+
+void BindlessRegistry::bind(VkCommandBuffer commandBuffer, VkPipelineBindPoint bindPoint,
+                            VkPipelineLayout pipelineLayout, uint32_t setIndex) const
+{
+    vkCmdBindDescriptorSets(commandBuffer, bindPoint, pipelineLayout, setIndex, 1, &set, 0, nullptr);
+}
+
+BindlessRegistry::Statistics BindlessRegistry::getStatistics() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    Statistics statistics = {};
+    statistics.sampledImages = slots[SAMPLED_IMAGE_BINDING].live;
+    statistics.storageBuffers = slots[STORAGE_BUFFER_BINDING].live;
+    statistics.samplers = slots[SAMPLER_BINDING].live;
+    statistics.sampledImageCapacity = slots[SAMPLED_IMAGE_BINDING].capacity;
+    statistics.storageBufferCapacity = slots[STORAGE_BUFFER_BINDING].capacity;
+    statistics.samplerCapacity = slots[SAMPLER_BINDING].capacity;
+    return statistics;
+}
+
+uint32_t BindlessRegistry::allocate(uint32_t binding)
+{
+    Slots& bindingSlots = slots[binding];
+    uint32_t index;
+    if (!bindingSlots.freeIndices.empty())
+    {
+        index = bindingSlots.freeIndices.back();
+        bindingSlots.freeIndices.pop_back();
+    }
+    else if (bindingSlots.next < bindingSlots.capacity)
+    {
+        index = bindingSlots.next++;
+    }
+    else
+    {
+        throw std::runtime_error(std::string("[Vulkan] Bindless ") + BINDING_NAMES[binding] + " slots exhausted!");
+    }
+    bindingSlots.live++;
+    return index;
+}
+
+void BindlessRegistry::release(uint32_t binding, uint32_t index)
+{
+    if (index == INVALID_INDEX)
+        return;
+    std::lock_guard<std::mutex> lock(mutex);
+    Slots& bindingSlots = slots[binding];
+    bindingSlots.pendingFrees.emplace_back(index, renderer->getFrameNumber());
+    bindingSlots.live--;
+}
+
+void BindlessRegistry::write(uint32_t binding, uint32_t index, VkDescriptorType type,
+                             const VkDescriptorImageInfo* imageInfo, const VkDescriptorBufferInfo* bufferInfo)
+{
+    VkWriteDescriptorSet descriptorWrite = {};
+    descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptorWrite.dstSet = set;
+    descriptorWrite.dstBinding = binding;
+    descriptorWrite.dstArrayElement = index;
+    descriptorWrite.descriptorCount = 1;
+    descriptorWrite.descriptorType = type;
+    descriptorWrite.pImageInfo = imageInfo;
+    descriptorWrite.pBufferInfo = bufferInfo;
+    vkUpdateDescriptorSets(device, 1, &descriptorWrite, 0, nullptr);
+}
@@ -0,0 +1,88 @@
+//
+// Created by Batur on 18/10/2026.
+//
+
+#ifndef BINDLESSREGISTRY_H
+#define BINDLESSREGISTRY_H
+
+#include <mutex>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+struct DeviceRequirements;
+class VulkanRenderer;
+
+// One update-after-bind descriptor set holding every sampled image, storage buffer and sampler.
+// Resources are registered once and addressed by index from shaders (shaders/bindless.glsl), so a draw
+// only pushes indices instead of allocating and binding sets. Released indices are recycled once the
+// frames in flight that could still read them are done.
+class BindlessRegistry
+{
+public:
+    static constexpr uint32_t SAMPLED_IMAGE_BINDING = 0;
+    static constexpr uint32_t STORAGE_BUFFER_BINDING = 1;
+    static constexpr uint32_t SAMPLER_BINDING = 2;
+    static constexpr uint32_t INVALID_INDEX = UINT32_MAX;
+
+    struct Statistics
+    {
+        uint32_t sampledImages;
+        uint32_t storageBuffers;
+        uint32_t samplers;
+        uint32_t sampledImageCapacity;
+        uint32_t storageBufferCapacity;
+        uint32_t samplerCapacity;
+    };
+
+    // Adds the descriptor indexing features the set layout relies on
+    static void addRequirements(DeviceRequirements& requirements);
+
+    // Capacities are clamped to the device's update-after-bind limits
+    void init(VulkanRenderer& renderer, uint32_t sampledImages, uint32_t storageBuffers, uint32_t samplers);
+    void destroy();
+
+    // Thread safe. Indices stay valid until released.
+    uint32_t registerImage(VkImageView imageView, VkImageLayout layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    uint32_t registerBuffer(VkBuffer buffer, VkDeviceSize offset = 0, VkDeviceSize range = VK_WHOLE_SIZE);
+    uint32_t registerSampler(VkSampler sampler);
+    void releaseImage(uint32_t index);
+    void releaseBuffer(uint32_t index);
+    void releaseSampler(uint32_t index);
+    // Recycles the indices released at least framesInFlight frames ago, called by the renderer every frame
+    void collect();
+
+    VkDescriptorSetLayout getLayout() const;
+    VkDescriptorSet getSet() const;
+    void bind(VkCommandBuffer commandBuffer, VkPipelineBindPoint bindPoint, VkPipelineLayout layout,
+              uint32_t setIndex = 0) const;
+    Statistics getStatistics() const;
+
+private:
+    struct Slots
+    {
+        uint32_t capacity = 0;
+        // Indices below `next` were handed out at least once
+        uint32_t next = 0;
+        uint32_t live = 0;
+        std::vector<uint32_t> freeIndices;
+        std::vector<std::pair<uint32_t, uint64_t>> pendingFrees;
+    };
+
+    VulkanRenderer* renderer = nullptr;
+    VkDevice device = VK_NULL_HANDLE;
+    const VkAllocationCallbacks* allocator = nullptr;
+    mutable std::mutex mutex;
+
+    VkDescriptorSetLayout layout = VK_NULL_HANDLE;
+    VkDescriptorPool pool = VK_NULL_HANDLE;
+    VkDescriptorSet set = VK_NULL_HANDLE;
+    Slots slots[3];
+
+    uint32_t allocate(uint32_t binding);
+    void release(uint32_t binding, uint32_t index);
+    void write(uint32_t binding, uint32_t index, VkDescriptorType type, const VkDescriptorImageInfo* imageInfo,
+               const VkDescriptorBufferInfo* bufferInfo);
+};
+
+#endif //BINDLESSREGISTRY_H
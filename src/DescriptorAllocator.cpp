@@ -0,0 +1,365 @@
+//
+// Created by Batur on 18/10/2026.
+//
+
+#include "DescriptorAllocator.h"
+
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+
+#include "DebugConfig.h"
+
+namespace
+{
+    constexpr uint32_t MAX_SETS_PER_POOL = 4096;
+
+    // Descriptors per set of every type, a pool holds setsPerPool times as many
+    const std::pair<VkDescriptorType, float> POOL_RATIOS[] = {
+        {VK_DESCRIPTOR_TYPE_SAMPLER, 0.5f},
+        {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 4.0f},
+        {VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 4.0f},
+        {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1.0f},
+        {VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER, 1.0f},
+        {VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER, 1.0f},
+        {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 2.0f},
+        {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2.0f},
+        {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1.0f},
+        {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, 1.0f},
+        {VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, 0.5f},
+    };
+
+    template <typename T>
+    void hashCombine(size_t& seed, const T& value)
+    {
+        seed ^= std::hash<T>()(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    }
+
+    template <typename T>
+    uint64_t handleBits(T handle)
+    {
+        return reinterpret_cast<uint64_t>(handle);
+    }
+
+    bool isBufferType(VkDescriptorType type)
+    {
+        return type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER || type == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER ||
+            type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC || type == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+    }
+
+    bool sameResource(const DescriptorResource& a, const DescriptorResource& b)
+    {
+        if (a.binding != b.binding || a.type != b.type)
+            return false;
+        if (isBufferType(a.type))
+            return a.buffer.buffer == b.buffer.buffer && a.buffer.offset == b.buffer.offset &&
+                a.buffer.range == b.buffer.range;
+        return a.image.sampler == b.image.sampler && a.image.imageView == b.image.imageView &&
+            a.image.imageLayout == b.image.imageLayout;
+    }
+}
+
+void DescriptorAllocator::init(VkDevice deviceHandle, const VkAllocationCallbacks* allocationCallbacks,
+                               uint32_t initialSetsPerPool)
+{
+    device = deviceHandle;
+    allocator = allocationCallbacks;
+    setsPerPool = initialSetsPerPool;
+}
+
+void DescriptorAllocator::destroy()
+{
+    for (VkDescriptorPool pool : usedPools)
+        vkDestroyDescriptorPool(device, pool, allocator);
+    for (VkDescriptorPool pool : freePools)
+        vkDestroyDescriptorPool(device, pool, allocator);
+    usedPools.clear();
+    freePools.clear();
+    currentPool = VK_NULL_HANDLE;
+    allocatedSets = 0;
+}
+
+VkDescriptorSet DescriptorAllocator::allocate(VkDescriptorSetLayout layout)
+{
+    if (currentPool == VK_NULL_HANDLE)
+        currentPool = grabPool();
+
+    VkDescriptorSetAllocateInfo allocInfo = {};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = currentPool;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &layout;
+    VkDescriptorSet set = VK_NULL_HANDLE;
+    VkResult err = vkAllocateDescriptorSets(device, &allocInfo, &set);
+    if (err == VK_ERROR_OUT_OF_POOL_MEMORY || err == VK_ERROR_FRAGMENTED_POOL)
+    {
+        // The full pool stays in usedPools until the next reset
+        currentPool = grabPool();
+        allocInfo.descriptorPool = currentPool;
+        err = vkAllocateDescriptorSets(device, &allocInfo, &set);
+    }
+    if (err != VK_SUCCESS)
+    {
+        throw std::runtime_error("[Vulkan] Failed to allocate descriptor set!");
+    }
+    allocatedSets++;
+    return set;
+}
+
+void DescriptorAllocator::reset()
+{
+    for (VkDescriptorPool pool : usedPools)
+    {
+        vkResetDescriptorPool(device, pool, 0);
+        freePools.push_back(pool);
+    }
+    usedPools.clear();
+    currentPool = VK_NULL_HANDLE;
+    allocatedSets = 0;
+}
+
+uint32_t DescriptorAllocator::getPoolCount() const
+{
+    return static_cast<uint32_t>(usedPools.size() + freePools.size());
+}
+
+uint32_t DescriptorAllocator::getAllocatedSets() const
+{
+    return allocatedSets;
+}
+
+VkDescriptorPool DescriptorAllocator::grabPool()
+{
+    VkDescriptorPool pool = VK_NULL_HANDLE;
+    if (!freePools.empty())
+    {
+        pool = freePools.back();
+        freePools.pop_back();
+        usedPools.push_back(pool);
+        return pool;
+    }
+
+    VkDescriptorPoolSize poolSizes[sizeof(POOL_RATIOS) / sizeof(POOL_RATIOS[0])];
+    for (size_t i = 0; i < sizeof(POOL_RATIOS) / sizeof(POOL_RATIOS[0]); i++)
+    {
+        poolSizes[i].type = POOL_RATIOS[i].first;
+        poolSizes[i].descriptorCount = std::max(1u, static_cast<uint32_t>(POOL_RATIOS[i].second * setsPerPool));
+    }
+    VkDescriptorPoolCreateInfo poolInfo = {};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.maxSets = setsPerPool;
+    poolInfo.poolSizeCount = static_cast<uint32_t>(sizeof(poolSizes) / sizeof(poolSizes[0]));
+    poolInfo.pPoolSizes = poolSizes;
+    if (vkCreateDescriptorPool(device, &poolInfo, allocator, &pool) != VK_SUCCESS)
+    {
+        throw std::runtime_error("[Vulkan] Failed to create descriptor pool!");
+    }
+    usedPools.push_back(pool);
+    DebugConfig::verbose("[Vulkan] Descriptor pool %zu created with %u sets", usedPools.size() + freePools.size(),
+                         setsPerPool);
+    // Growing keeps the pool count logarithmic in the peak set count
+    setsPerPool = std::min(MAX_SETS_PER_POOL, setsPerPool + setsPerPool / 2);
+    return pool;
+}
+
+void DescriptorCache::init(VkDevice deviceHandle, const VkAllocationCallbacks* allocationCallbacks)
+{
+    device = deviceHandle;
+    allocator = allocationCallbacks;
+    setAllocator.init(device, allocator);
+}
+
+void DescriptorCache::destroy()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    sets.clear();
+    freeSets.clear();
+    setAllocator.destroy();
+    for (const auto& layout : layouts)
+        vkDestroyDescriptorSetLayout(device, layout.second, allocator);
+    layouts.clear();
+}
+
+VkDescriptorSetLayout DescriptorCache::getLayout(const VkDescriptorSetLayoutBinding* bindings, uint32_t bindingCount,
+                                                 VkDescriptorSetLayoutCreateFlags flags)
+{
+    LayoutKey key;
+    key.flags = flags;
+    key.bindings.assign(bindings, bindings + bindingCount);
+    // Binding order does not change the layout
+    std::sort(key.bindings.begin(), key.bindings.end(),
+              [](const VkDescriptorSetLayoutBinding& a, const VkDescriptorSetLayoutBinding& b)
+              {
+                  return a.binding < b.binding;
+              });
+    // The key owns its immutable samplers, they are compared by handle
+    key.samplers.resize(bindingCount);
+    for (uint32_t i = 0; i < bindingCount; i++)
+    {
+        VkDescriptorSetLayoutBinding& binding = key.bindings[i];
+        if (!binding.pImmutableSamplers)
+            continue;
+        key.samplers[i].assign(binding.pImmutableSamplers, binding.pImmutableSamplers + binding.descriptorCount);
+        binding.pImmutableSamplers = key.samplers[i].data();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    const auto it = layouts.find(key);
+    if (it != layouts.end())
+        return it->second;
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo = {};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.flags = flags;
+    layoutInfo.bindingCount = bindingCount;
+    layoutInfo.pBindings = key.bindings.data();
+    VkDescriptorSetLayout layout = VK_NULL_HANDLE;
+    if (vkCreateDescriptorSetLayout(device, &layoutInfo, allocator, &layout) != VK_SUCCESS)
+    {
+        throw std::runtime_error("[Vulkan] Failed to create descriptor set layout!");
+    }
+    layouts.emplace(std::move(key), layout);
+    return layout;
+}
+
+VkDescriptorSet DescriptorCache::getSet(VkDescriptorSetLayout layout, const DescriptorResource* resources,
+                                        uint32_t resourceCount)
+{
+    SetKey key;
+    key.layout = layout;
+    key.resources.assign(resources, resources + resourceCount);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    const auto it = sets.find(key);
+    if (it != sets.end())
+        return it->second;
+
+    VkDescriptorSet set = VK_NULL_HANDLE;
+    std::vector<VkDescriptorSet>& recycled = freeSets[layout];
+    if (!recycled.empty())
+    {
+        set = recycled.back();
+        recycled.pop_back();
+    }
+    else
+    {
+        set = setAllocator.allocate(layout);
+    }
+    std::vector<VkWriteDescriptorSet> writes(resourceCount);
+    for (uint32_t i = 0; i < resourceCount; i++)
+    {
+        writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[i].dstSet = set;
+        writes[i].dstBinding = resources[i].binding;
+        writes[i].descriptorCount = 1;
+        writes[i].descriptorType = resources[i].type;
+        if (isBufferType(resources[i].type))
+            writes[i].pBufferInfo = &resources[i].buffer;
+        else
+            writes[i].pImageInfo = &resources[i].image;
+    }
+    vkUpdateDescriptorSets(device, resourceCount, writes.data(), 0, nullptr);
+    sets.emplace(std::move(key), set);
+    return set;
+}
+
+template <typename Predicate>
+void DescriptorCache::dropSets(const Predicate& references)
+{
+    // The resource is no longer in use on the GPU, so neither are the sets referencing it
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto it = sets.begin(); it != sets.end();)
+    {
+        if (std::none_of(it->first.resources.begin(), it->first.resources.end(), references))
+        {
+            ++it;
+            continue;
+        }
+        freeSets[it->first.layout].push_back(it->second);
+        it = sets.erase(it);
+    }
+}
+
+void DescriptorCache::invalidateBuffer(VkBuffer buffer)
+{
+    dropSets([buffer](const DescriptorResource& resource)
+    {
+        return isBufferType(resource.type) && resource.buffer.buffer == buffer;
+    });
+}
+
+void DescriptorCache::invalidateImageView(VkImageView imageView)
+{
+    dropSets([imageView](const DescriptorResource& resource)
+    {
+        return !isBufferType(resource.type) && resource.image.imageView == imageView;
+    });
+}
+
+void DescriptorCache::invalidateSampler(VkSampler sampler)
+{
+    dropSets([sampler](const DescriptorResource& resource)
+    {
+        return !isBufferType(resource.type) && resource.image.sampler == sampler;
+    });
+}
+
+bool DescriptorCache::LayoutKey::operator==(const LayoutKey& other) const
+{
+    if (flags != other.flags || bindings.size() != other.bindings.size())
+        return false;
+    for (size_t i = 0; i < bindings.size(); i++)
+    {
+        const VkDescriptorSetLayoutBinding& a = bindings[i];
+        const VkDescriptorSetLayoutBinding& b = other.bindings[i];
+        if (a.binding != b.binding || a.descriptorType != b.descriptorType ||
+            a.descriptorCount != b.descriptorCount || a.stageFlags != b.stageFlags ||
+            samplers[i] != other.samplers[i])
+            return false;
+    }
+    return true;
+}
+
+bool DescriptorCache::SetKey::operator==(const SetKey& other) const
+{
+    if (layout != other.layout || resources.size() != other.resources.size())
+        return false;
+    for (size_t i = 0; i < resources.size(); i++)
+        if (!sameResource(resources[i], other.resources[i]))
+            return false;
+    return true;
+}
+
+size_t DescriptorCache::KeyHash::operator()(const LayoutKey& key) const
+{
+    size_t seed = key.flags;
+    for (const VkDescriptorSetLayoutBinding& binding : key.bindings)
+    {
+        hashCombine(seed, binding.binding);
+        hashCombine(seed, static_cast<uint32_t>(binding.descriptorType));
+        hashCombine(seed, binding.descriptorCount);
+        hashCombine(seed, binding.stageFlags);
+    }
+    return seed;
+}
+
+size_t DescriptorCache::KeyHash::operator()(const SetKey& key) const
+{
+    size_t seed = std::hash<uint64_t>()(handleBits(key.layout));
+    for (const DescriptorResource& resource : key.resources)
+    {
+        hashCombine(seed, resource.binding);
+        if (isBufferType(resource.type))
+        {
+            hashCombine(seed, handleBits(resource.buffer.buffer));
+            hashCombine(seed, resource.buffer.offset);
+        }
+        else
+        {
+            hashCombine(seed, handleBits(resource.image.imageView));
+            hashCombine(seed, handleBits(resource.image.sampler));
+        }
+    }
+    return seed;
+}
@@ -0,0 +1,111 @@
+//
+// Created by Batur on 18/10/2026.
+//
+
+#ifndef DESCRIPTORALLOCATOR_H
+#define DESCRIPTORALLOCATOR_H
+
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+// Descriptor sets from a growing list of pools.
+// A pool that runs out is retired and the next one comes from the free list or is created, each new pool
+// bigger than the last. Sets are never freed one by one: reset() gives every pool back at once, which is
+// how the per-frame allocators are recycled. Not thread safe.
+class DescriptorAllocator
+{
+public:
+    void init(VkDevice device, const VkAllocationCallbacks* allocator, uint32_t initialSetsPerPool = 64);
+    void destroy();
+
+    VkDescriptorSet allocate(VkDescriptorSetLayout layout);
+    // Every set allocated so far becomes invalid
+    void reset();
+
+    uint32_t getPoolCount() const;
+    uint32_t getAllocatedSets() const;
+
+private:
+    VkDevice device = VK_NULL_HANDLE;
+    const VkAllocationCallbacks* allocator = nullptr;
+    uint32_t setsPerPool = 0;
+    uint32_t allocatedSets = 0;
+
+    VkDescriptorPool currentPool = VK_NULL_HANDLE;
+    std::vector<VkDescriptorPool> usedPools;
+    std::vector<VkDescriptorPool> freePools;
+
+    VkDescriptorPool grabPool();
+};
+
+// One resource of an immutable set, only the member matching `type` is read
+struct DescriptorResource
+{
+    uint32_t binding;
+    VkDescriptorType type;
+    VkDescriptorImageInfo image;
+    VkDescriptorBufferInfo buffer;
+};
+
+// Set layouts and immutable sets deduplicated by content.
+// Equal binding lists always give the same layout, equal resource lists on a layout the same set, so both
+// can be requested where they are needed instead of being threaded around. A set is dropped when one of its
+// resources is invalidated, and its descriptor set reused by the next set of the same layout. Thread safe.
+class DescriptorCache
+{
+public:
+    void init(VkDevice device, const VkAllocationCallbacks* allocator);
+    void destroy();
+
+    VkDescriptorSetLayout getLayout(const VkDescriptorSetLayoutBinding* bindings, uint32_t bindingCount,
+                                    VkDescriptorSetLayoutCreateFlags flags = 0);
+    // Valid until one of the resources is invalidated
+    VkDescriptorSet getSet(VkDescriptorSetLayout layout, const DescriptorResource* resources, uint32_t resourceCount);
+    // Drops the sets referencing the resource, called when it is destroyed so a recycled handle never matches
+    // them. VulkanRenderer::destroyBuffer() does it for buffers, owners of image views and samplers in sets
+    // call it themselves.
+    void invalidateBuffer(VkBuffer buffer);
+    void invalidateImageView(VkImageView imageView);
+    void invalidateSampler(VkSampler sampler);
+
+private:
+    struct LayoutKey
+    {
+        VkDescriptorSetLayoutCreateFlags flags;
+        // pImmutableSamplers points into `samplers`, copied from the caller's arrays
+        std::vector<VkDescriptorSetLayoutBinding> bindings;
+        std::vector<std::vector<VkSampler>> samplers;
+
+        bool operator==(const LayoutKey& other) const;
+    };
+
+    struct SetKey
+    {
+        VkDescriptorSetLayout layout;
+        std::vector<DescriptorResource> resources;
+
+        bool operator==(const SetKey& other) const;
+    };
+
+    struct KeyHash
+    {
+        size_t operator()(const LayoutKey& key) const;
+        size_t operator()(const SetKey& key) const;
+    };
+
+    template <typename Predicate>
+    void dropSets(const Predicate& references);
+
+    VkDevice device = VK_NULL_HANDLE;
+    const VkAllocationCallbacks* allocator = nullptr;
+    std::mutex mutex;
+    std::unordered_map<LayoutKey, VkDescriptorSetLayout, KeyHash> layouts;
+    std::unordered_map<SetKey, VkDescriptorSet, KeyHash> sets;
+    // Sets of invalidated entries, rewritten for the next set of their layout
+    std::unordered_map<VkDescriptorSetLayout, std::vector<VkDescriptorSet>> freeSets;
+    DescriptorAllocator setAllocator;
+};
+
+#endif //DESCRIPTORALLOCATOR_H
@@ -0,0 +1,321 @@
+//
+// Created by Batur on 18/10/2026.
+//
+
+#include "DeviceSelector.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+#include "DebugConfig.h"
+#include "QueueFamilies.h"
+
+namespace
+{
+    // Vulkan feature structs are a list of VkBool32 behind the sType/pNext header
+    bool hasFeatures(const void* supported, const void* required, size_t size, size_t headerSize)
+    {
+        const size_t count = (size - headerSize) / sizeof(VkBool32);
+        const VkBool32* supportedFeatures = reinterpret_cast<const VkBool32*>(
+            static_cast<const char*>(supported) + headerSize);
+        const VkBool32* requiredFeatures = reinterpret_cast<const VkBool32*>(
+            static_cast<const char*>(required) + headerSize);
+        for (size_t i = 0; i < count; i++)
+            if (requiredFeatures[i] && !supportedFeatures[i])
+                return false;
+        return true;
+    }
+
+    template <typename T>
+    bool hasFeatures(const T& supported, const T& required, size_t headerSize)
+    {
+        return hasFeatures(&supported, &required, sizeof(T), headerSize);
+    }
+
+    // Structs folded into VkPhysicalDeviceVulkan11/12/13Features, the spec forbids chaining both
+    const VkStructureType PROMOTED_FEATURES[] = {
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_16BIT_STORAGE_FEATURES,
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MULTIVIEW_FEATURES,
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VARIABLE_POINTERS_FEATURES,
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROTECTED_MEMORY_FEATURES,
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SAMPLER_YCBCR_CONVERSION_FEATURES,
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_DRAW_PARAMETERS_FEATURES,
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_8BIT_STORAGE_FEATURES,
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_ATOMIC_INT64_FEATURES,
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_FLOAT16_INT8_FEATURES,
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES,
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SCALAR_BLOCK_LAYOUT_FEATURES,
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_IMAGELESS_FRAMEBUFFER_FEATURES,
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_UNIFORM_BUFFER_STANDARD_LAYOUT_FEATURES,
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_SUBGROUP_EXTENDED_TYPES_FEATURES,
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SEPARATE_DEPTH_STENCIL_LAYOUTS_FEATURES,
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_HOST_QUERY_RESET_FEATURES,
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES,
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_BUFFER_DEVICE_ADDRESS_FEATURES,
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_MEMORY_MODEL_FEATURES,
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_IMAGE_ROBUSTNESS_FEATURES,
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_INLINE_UNIFORM_BLOCK_FEATURES,
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PIPELINE_CREATION_CACHE_CONTROL_FEATURES,
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRIVATE_DATA_FEATURES,
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_DEMOTE_TO_HELPER_INVOCATION_FEATURES,
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_TERMINATE_INVOCATION_FEATURES,
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SUBGROUP_SIZE_CONTROL_FEATURES,
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES,
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TEXTURE_COMPRESSION_ASTC_HDR_FEATURES,
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ZERO_INITIALIZE_WORKGROUP_MEMORY_FEATURES,
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES,
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_INTEGER_DOT_PRODUCT_FEATURES,
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MAINTENANCE_4_FEATURES,
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_FEATURES,
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES,
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES,
+    };
+
+    bool hasExtension(const std::vector<VkExtensionProperties>& extensions, const char* name)
+    {
+        for (const VkExtensionProperties& extension : extensions)
+            if (std::strcmp(extension.extensionName, name) == 0)
+                return true;
+        return false;
+    }
+
+    std::vector<VkExtensionProperties> getExtensions(VkPhysicalDevice device)
+    {
+        uint32_t extensionCount = 0;
+        vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
+        std::vector<VkExtensionProperties> extensions(extensionCount);
+        vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, extensions.data());
+        return extensions;
+    }
+}
+
+VkPhysicalDevice DeviceSelector::select(VkInstance instance, const DeviceRequirements& requirements)
+{
+    for (const ExtensionFeatures& features : requirements.extensionFeatures)
+    {
+        const VkStructureType type = reinterpret_cast<const VkBaseInStructure*>(features.data.data())->sType;
+        for (const VkStructureType promoted : PROMOTED_FEATURES)
+            if (type == promoted)
+            {
+                throw std::runtime_error(std::string("[Vulkan] Features of ") + features.extension +
+                                         " are core, request them through the Vulkan 1.1-1.3 structs!");
+            }
+    }
+
+    uint32_t deviceCount = 0;
+    VkResult err = vkEnumeratePhysicalDevices(instance, &deviceCount, nullptr);
+    if (err != VK_SUCCESS || deviceCount <= 0)
+    {
+        throw std::runtime_error("[Vulkan] Failed to find GPUs with Vulkan support!");
+    }
+    std::vector<VkPhysicalDevice> devices(deviceCount);
+
+    err = vkEnumeratePhysicalDevices(instance, &deviceCount, devices.data());
+    if (err != VK_SUCCESS || deviceCount <= 0)
+    {
+        throw std::runtime_error("[Vulkan] Failed to retrieve devices with vulkan support!");
+    }
+
+    const char* override = std::getenv("SOLID_DEVICE");
+    const Candidate* best = nullptr;
+    const Candidate* forced = nullptr;
+    std::vector<Candidate> candidates;
+    candidates.reserve(deviceCount);
+    for (uint32_t i = 0; i < deviceCount; i++)
+    {
+        candidates.push_back(evaluate(devices[i], requirements));
+        const Candidate& candidate = candidates.back();
+        if (!candidate.rejection.empty())
+        {
+            DebugConfig::verbose("[Vulkan] Device %u %s rejected: %s", i, candidate.properties.deviceName,
+                                 candidate.rejection.c_str());
+            continue;
+        }
+        DebugConfig::verbose("[Vulkan] Device %u %s score %lld", i, candidate.properties.deviceName,
+                             static_cast<long long>(candidate.score));
+
+        if (!best || candidate.score > best->score)
+            best = &candidate;
+        if (!forced && override && matchesOverride(candidate, i, override))
+            forced = &candidate;
+    }
+
+    if (override && !forced)
+        DebugConfig::warning("[Vulkan] SOLID_DEVICE=%s matches no suitable device, using the best one", override);
+    if (forced)
+        best = forced;
+    if (!best)
+    {
+        throw std::runtime_error("[Vulkan] No physical device meets the renderer requirements!");
+    }
+    return best->device;
+}
+
+DeviceSelector::Candidate DeviceSelector::evaluate(VkPhysicalDevice device, const DeviceRequirements& requirements)
+{
+    Candidate candidate = {};
+    candidate.device = device;
+    vkGetPhysicalDeviceProperties(device, &candidate.properties);
+
+    VkPhysicalDeviceMemoryProperties memoryProperties;
+    vkGetPhysicalDeviceMemoryProperties(device, &memoryProperties);
+    for (uint32_t i = 0; i < memoryProperties.memoryHeapCount; i++)
+        if (memoryProperties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)
+            candidate.deviceLocalMemory += memoryProperties.memoryHeaps[i].size;
+
+    candidate.rejection = findMissingRequirement(candidate, requirements);
+    candidate.score = candidate.rejection.empty() ? score(candidate) : -1;
+    return candidate;
+}
+
+std::string DeviceSelector::findMissingRequirement(const Candidate& candidate, const DeviceRequirements& requirements)
+{
+    if (candidate.properties.apiVersion < requirements.minApiVersion)
+        return "Vulkan version too old";
+
+    if (candidate.deviceLocalMemory < requirements.minDeviceLocalMemory)
+        return "not enough device local memory";
+
+    const std::vector<VkExtensionProperties> extensions = getExtensions(candidate.device);
+    for (const char* required : requirements.extensions)
+    {
+        if (!hasExtension(extensions, required))
+            return std::string("missing extension ") + required;
+        if (!hasExtensionFeatures(candidate.device, requirements, required))
+            return std::string("missing required feature of ") + required;
+    }
+
+    VkPhysicalDeviceFeatures supported;
+    vkGetPhysicalDeviceFeatures(candidate.device, &supported);
+    if (!hasFeatures(supported, requirements.features, 0))
+        return "missing required feature";
+
+    // Feature structs of versions the device does not support stay zeroed, nothing in them is available.
+    // VkPhysicalDeviceVulkan11Features itself only exists from Vulkan 1.2 on.
+    VkPhysicalDeviceVulkan11Features supported11 = {};
+    supported11.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_FEATURES;
+    VkPhysicalDeviceVulkan12Features supported12 = {};
+    supported12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    VkPhysicalDeviceVulkan13Features supported13 = {};
+    supported13.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
+    if (candidate.properties.apiVersion >= VK_API_VERSION_1_2)
+    {
+        if (candidate.properties.apiVersion >= VK_API_VERSION_1_3)
+            supported12.pNext = &supported13;
+        VkPhysicalDeviceFeatures2 features2 = {};
+        features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        supported11.pNext = &supported12;
+        features2.pNext = &supported11;
+        vkGetPhysicalDeviceFeatures2(candidate.device, &features2);
+    }
+    if (!hasFeatures(supported11, requirements.features11, sizeof(VkBaseOutStructure)))
+        return "missing required Vulkan 1.1 feature";
+    if (!hasFeatures(supported12, requirements.features12, sizeof(VkBaseOutStructure)))
+        return "missing required Vulkan 1.2 feature";
+    if (!hasFeatures(supported13, requirements.features13, sizeof(VkBaseOutStructure)))
+        return "missing required Vulkan 1.3 feature";
+
+    try
+    {
+        const QueueFamilies families = QueueFamilies::find(candidate.device, requirements.presentSurface);
+        if (!QueueFamilies::canPresent(candidate.device, families.family[static_cast<uint32_t>(QueueType::Graphics)],
+                                       requirements.presentSurface))
+            return "cannot present to the surface";
+    }
+    catch (std::exception&)
+    {
+        return "no graphics queue";
+    }
+    return std::string();
+}
+
+std::vector<const char*> DeviceSelector::getEnabledExtensions(VkPhysicalDevice device,
+                                                             const DeviceRequirements& requirements)
+{
+    std::vector<const char*> enabled;
+    const auto isEnabled = [&enabled](const char* name)
+    {
+        for (const char* extension : enabled)
+            if (std::strcmp(extension, name) == 0)
+                return true;
+        return false;
+    };
+    for (const char* required : requirements.extensions)
+        if (!isEnabled(required))
+            enabled.push_back(required);
+
+    const std::vector<VkExtensionProperties> extensions = getExtensions(device);
+    for (const char* optional : requirements.optionalExtensions)
+    {
+        if (isEnabled(optional))
+            continue;
+        if (!hasExtension(extensions, optional))
+            DebugConfig::verbose("[Vulkan] Optional extension %s not supported", optional);
+        else if (!hasExtensionFeatures(device, requirements, optional))
+            DebugConfig::verbose("[Vulkan] Optional extension %s lacks a requested feature", optional);
+        else
+            enabled.push_back(optional);
+    }
+    return enabled;
+}
+
+bool DeviceSelector::hasExtensionFeatures(VkPhysicalDevice device, const DeviceRequirements& requirements,
+                                          const char* extension)
+{
+    for (const ExtensionFeatures& features : requirements.extensionFeatures)
+    {
+        if (std::strcmp(features.extension, extension) != 0)
+            continue;
+        // Queried into a copy of the struct with only its header kept
+        std::vector<uint8_t> supported(features.data.size(), 0);
+        VkBaseOutStructure* header = reinterpret_cast<VkBaseOutStructure*>(supported.data());
+        header->sType = reinterpret_cast<const VkBaseInStructure*>(features.data.data())->sType;
+        VkPhysicalDeviceFeatures2 features2 = {};
+        features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        features2.pNext = header;
+        vkGetPhysicalDeviceFeatures2(device, &features2);
+        if (!hasFeatures(supported.data(), features.data.data(), supported.size(), sizeof(VkBaseOutStructure)))
+            return false;
+    }
+    return true;
+}
+
+int64_t DeviceSelector::score(const Candidate& candidate)
+{
+    int64_t result = 0;
+    switch (candidate.properties.deviceType)
+    {
+    case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU:
+        result += 1000000;
+        break;
+    case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU:
+        result += 500000;
+        break;
+    case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU:
+        result += 200000;
+        break;
+    case VK_PHYSICAL_DEVICE_TYPE_CPU:
+        result += 10000;
+        break;
+    default:
+        break;
+    }
+
+    // One point per MiB of device local memory, then a nudge from the limits that matter to us
+    result += static_cast<int64_t>(candidate.deviceLocalMemory >> 20);
+    result += candidate.properties.limits.maxImageDimension2D / 1024;
+    result += candidate.properties.limits.maxComputeSharedMemorySize / 4096;
+    if (candidate.properties.apiVersion >= VK_API_VERSION_1_3)
+        result += 100;
+    return result;
+}
+
+bool DeviceSelector::matchesOverride(const Candidate& candidate, uint32_t index, const char* override)
+{
+    char* end = nullptr;
+    const unsigned long requestedIndex = std::strtoul(override, &end, 10);
+    if (end != override && *end == '\0')
+        return requestedIndex == index;
+    return std::strstr(candidate.properties.deviceName, override) != nullptr;
+}
@@ -0,0 +1,84 @@
+//
+// Created by Batur on 18/10/2026.
+//
+
+#ifndef DEVICESELECTOR_H
+#define DEVICESELECTOR_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+// Feature struct of a device extension, kept as bytes so the requirements hold any extension's struct
+struct ExtensionFeatures
+{
+    const char* extension;
+    std::vector<uint8_t> data;
+};
+
+// What a physical device must provide to be considered at all, and what it should provide if it can.
+// Subsystems add theirs from a static addRequirements() before the device is created.
+struct DeviceRequirements
+{
+    std::vector<const char*> extensions;
+    // Enabled when the device has them and their features, left out otherwise.
+    // VulkanRenderer::isExtensionEnabled() tells which fast paths can be taken.
+    std::vector<const char*> optionalExtensions;
+    // Chained to the device create info when their extension is enabled. Members set to VK_TRUE are required
+    // of the device for a required extension, and of an optional one for it to be enabled. Structs of the same
+    // type are merged.
+    std::vector<ExtensionFeatures> extensionFeatures;
+    // Every member set to VK_TRUE is required, and enabled on the logical device
+    VkPhysicalDeviceFeatures features = {};
+    // Same for the Vulkan 1.1 core features, pNext is ignored
+    VkPhysicalDeviceVulkan11Features features11 = {VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_FEATURES};
+    // The Vulkan 1.2 ones
+    VkPhysicalDeviceVulkan12Features features12 = {VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES};
+    // And the Vulkan 1.3 ones
+    VkPhysicalDeviceVulkan13Features features13 = {VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES};
+    VkDeviceSize minDeviceLocalMemory = 0;
+    uint32_t minApiVersion = VK_API_VERSION_1_1;
+    // The graphics queue family must be able to present to this surface
+    VkSurfaceKHR presentSurface = VK_NULL_HANDLE;
+
+    // `features` is the extension's VkPhysicalDevice*FeaturesKHR/EXT struct with its sType set, pNext is ignored.
+    // Structs promoted into the Vulkan 1.1-1.3 feature structs are rejected by the selector, set those instead.
+    template <typename T>
+    void addExtensionFeatures(const char* extension, const T& features)
+    {
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&features);
+        extensionFeatures.push_back({extension, std::vector<uint8_t>(bytes, bytes + sizeof(T))});
+    }
+};
+
+// Ranks the physical devices that satisfy a DeviceRequirements.
+// Device type dominates the score, then device local memory, then limits.
+// SOLID_DEVICE=<index or name substring> forces a device as long as it meets the requirements.
+class DeviceSelector
+{
+public:
+    static VkPhysicalDevice select(VkInstance instance, const DeviceRequirements& requirements);
+    // The required extensions of the selected device, followed by the optional ones it supports, without duplicates
+    static std::vector<const char*> getEnabledExtensions(VkPhysicalDevice device,
+                                                         const DeviceRequirements& requirements);
+
+private:
+    struct Candidate
+    {
+        VkPhysicalDevice device;
+        VkPhysicalDeviceProperties properties;
+        VkDeviceSize deviceLocalMemory;
+        int64_t score;
+        std::string rejection;
+    };
+
+    static Candidate evaluate(VkPhysicalDevice device, const DeviceRequirements& requirements);
+    static std::string findMissingRequirement(const Candidate& candidate, const DeviceRequirements& requirements);
+    static int64_t score(const Candidate& candidate);
+    static bool hasExtensionFeatures(VkPhysicalDevice device, const DeviceRequirements& requirements,
+                                     const char* extension);
+    static bool matchesOverride(const Candidate& candidate, uint32_t index, const char* override);
+};
+
+#endif //DEVICESELECTOR_H
@@ -0,0 +1,442 @@
+//
+// Created by Batur on 18/10/2026.
+//
+
+#include "DrawBatcher.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+
+#include "DebugConfig.h"
+#include "VulkanRenderer.h"
+
+namespace
+{
+    constexpr uint32_t VERTEX_STRIDE = 6 * sizeof(float);
+    // Keeps the color array at a multiple of 64 KiB, aligned for any minStorageBufferOffsetAlignment
+    constexpr uint32_t MIN_INSTANCE_CAPACITY = 1024;
+    // Fewer batches than this per thread are not worth a secondary command buffer of their own
+    constexpr uint32_t MIN_CHUNK_BATCHES = 64;
+
+    constexpr uint32_t PIPELINE_SHIFT = 56;
+    constexpr uint32_t MATERIAL_SHIFT = 40;
+    constexpr uint32_t MESH_SHIFT = 24;
+    constexpr uint64_t DEPTH_MASK = 0xFFFFFF;
+
+    struct BatchConstants
+    {
+        float viewProjection[16];
+        float color[4];
+        uint32_t transformBuffer;
+        uint32_t colorBuffer;
+    };
+
+    // Clip space w of the transform's origin, the view depth for a perspective projection. Positive floats sort
+    // like their bits, so the top 24 bits below the sign keep the order.
+    uint64_t getDepthKey(const float* viewProjection, const float* transform)
+    {
+        const float w = viewProjection[3] * transform[12] + viewProjection[7] * transform[13] +
+            viewProjection[11] * transform[14] + viewProjection[15] * transform[15];
+        const float depth = w > 0.0f ? w : 0.0f;
+        uint32_t bits;
+        std::memcpy(&bits, &depth, sizeof(bits));
+        return (bits >> 7) & DEPTH_MASK;
+    }
+
+    uint32_t getChunkCount(uint32_t batchCount, uint32_t threadCount)
+    {
+        return std::max(1u, std::min(threadCount, (batchCount + MIN_CHUNK_BATCHES - 1) / MIN_CHUNK_BATCHES));
+    }
+
+    uint32_t getMaterial(uint64_t key)
+    {
+        return static_cast<uint32_t>(key >> MATERIAL_SHIFT) & 0xFFFF;
+    }
+
+    uint32_t getMesh(uint64_t key)
+    {
+        return static_cast<uint32_t>(key >> MESH_SHIFT) & 0xFFFF;
+    }
+}
+
+void DrawBatcher::init(VulkanRenderer& vulkanRenderer)
+{
+    renderer = &vulkanRenderer;
+    device = renderer->getDevice();
+    depthFormat = renderer->getDepthFormat();
+    frames.resize(renderer->getFramesInFlight());
+
+    reloadListener = renderer->getShaderLibrary().addReloadListener([this](const std::string& name)
+    {
+        for (Pipeline& pipeline : pipelines)
+            if (name == pipeline.vertexShader || name == pipeline.fragmentShader)
+                requestPipeline(pipeline);
+    });
+    // Batches are skipped until their pipelines for the new format are compiled
+    formatListener = renderer->addFormatListener([this](VkFormat)
+    {
+        for (Pipeline& pipeline : pipelines)
+        {
+            pipeline.handle = 0;
+            requestPipeline(pipeline);
+        }
+    });
+    DebugConfig::verbose("[Vulkan] Draw batcher created: %u frame slots, depth format %d",
+                         static_cast<uint32_t>(frames.size()), static_cast<int>(depthFormat));
+}
+
+void DrawBatcher::destroy()
+{
+    if (!renderer)
+        return;
+    vkDeviceWaitIdle(device);
+
+    // Pipelines belong to the renderer's compiler, layouts to the shader library
+    renderer->getShaderLibrary().removeReloadListener(reloadListener);
+    reloadListener = 0;
+    renderer->removeFormatListener(formatListener);
+    formatListener = 0;
+    for (FrameData& frame : frames)
+    {
+        if (frame.capacity == 0)
+            continue;
+        renderer->getBindless().releaseBuffer(frame.transformBuffer);
+        renderer->getBindless().releaseBuffer(frame.colorBuffer);
+        renderer->destroyBuffer(frame.instances);
+    }
+    frames.clear();
+
+    pipelines.clear();
+    materials.clear();
+    meshes.clear();
+    requests.clear();
+    keys.clear();
+    order.clear();
+    sortKeys.clear();
+    sortOrder.clear();
+    batches.clear();
+    statistics = {};
+    renderer = nullptr;
+}
+
+uint32_t DrawBatcher::addPipeline(const std::string& vertexShader, const std::string& fragmentShader)
+{
+    if (pipelines.size() >= MAX_PIPELINES)
+    {
+        throw std::runtime_error("[Vulkan] Draw batcher pipeline limit reached!");
+    }
+    // Set 0 is the bindless set, the shaders reflect a runtime array of instance buffers
+    const ShaderLibrary::Layout layout = renderer->getShaderLibrary().getLayout({vertexShader, fragmentShader});
+    if (layout.setLayouts.size() != 1 || layout.setLayouts[0] != renderer->getBindless().getLayout())
+    {
+        throw std::runtime_error("[Vulkan] Draw batcher shaders must only use the bindless set!");
+    }
+    Pipeline pipeline = {vertexShader, fragmentShader, layout.pipelineLayout, 0};
+    requestPipeline(pipeline);
+    pipelines.push_back(pipeline);
+    return static_cast<uint32_t>(pipelines.size() - 1);
+}
+
+uint32_t DrawBatcher::addMaterial(uint32_t pipeline, const float color[4])
+{
+    if (pipeline >= pipelines.size())
+    {
+        throw std::runtime_error("[Vulkan] Unknown draw batcher pipeline!");
+    }
+    if (materials.size() >= MAX_MATERIALS)
+    {
+        throw std::runtime_error("[Vulkan] Draw batcher material limit reached!");
+    }
+    Material material = {};
+    material.pipeline = pipeline;
+    std::memcpy(material.color, color, sizeof(material.color));
+    materials.push_back(material);
+    return static_cast<uint32_t>(materials.size() - 1);
+}
+
+uint32_t DrawBatcher::addMesh(VkBuffer vertexBuffer, VkBuffer indexBuffer, uint32_t firstIndex, uint32_t indexCount,
+                              int32_t vertexOffset)
+{
+    if (meshes.size() >= MAX_MESHES)
+    {
+        throw std::runtime_error("[Vulkan] Draw batcher mesh limit reached!");
+    }
+    meshes.push_back({vertexBuffer, indexBuffer, firstIndex, indexCount, vertexOffset});
+    return static_cast<uint32_t>(meshes.size() - 1);
+}
+
+void DrawBatcher::setCamera(const float cameraViewProjection[16])
+{
+    std::memcpy(viewProjection, cameraViewProjection, sizeof(viewProjection));
+}
+
+void DrawBatcher::submit(uint32_t mesh, uint32_t material, const float transform[16], const float color[4])
+{
+    if (mesh >= meshes.size() || material >= materials.size())
+    {
+        throw std::runtime_error("[Vulkan] Unknown draw batcher mesh or material!");
+    }
+    // Pipeline, material and mesh ids grow in the order they were added, so equal state ends up next to each other
+    const uint64_t key = static_cast<uint64_t>(materials[material].pipeline) << PIPELINE_SHIFT |
+        static_cast<uint64_t>(material) << MATERIAL_SHIFT | static_cast<uint64_t>(mesh) << MESH_SHIFT |
+        getDepthKey(viewProjection, transform);
+    keys.push_back(key);
+    order.push_back(static_cast<uint32_t>(requests.size()));
+    requests.emplace_back();
+    Instance& instance = requests.back();
+    std::memcpy(instance.transform, transform, sizeof(instance.transform));
+    std::memcpy(instance.color, color, sizeof(instance.color));
+}
+
+void DrawBatcher::render()
+{
+    const uint32_t requestCount = static_cast<uint32_t>(requests.size());
+    statistics = {};
+    statistics.requestCount = requestCount;
+    batches.clear();
+    if (requestCount == 0)
+        return;
+
+    const auto start = std::chrono::steady_clock::now();
+    sort();
+    const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    statistics.sortMs = elapsed.count();
+
+    // The slot's previous frame has been waited for, its instance buffer is free to rewrite
+    FrameData& frame = frames[renderer->getFrameIndex()];
+    reserveInstances(frame, requestCount);
+    char* mapped = static_cast<char*>(frame.instances.allocation->mapped);
+    float* transforms = reinterpret_cast<float*>(mapped);
+    float* colors = reinterpret_cast<float*>(mapped + static_cast<VkDeviceSize>(frame.capacity) * 16 * sizeof(float));
+
+    // Sorted requests become the instances, runs of one mesh and material one instanced draw
+    uint32_t lastPipeline = UINT32_MAX;
+    uint32_t lastMaterial = UINT32_MAX;
+    VkBuffer lastVertexBuffer = VK_NULL_HANDLE;
+    VkBuffer lastIndexBuffer = VK_NULL_HANDLE;
+    for (uint32_t i = 0; i < requestCount; i++)
+    {
+        const Instance& instance = requests[order[i]];
+        std::memcpy(transforms + i * 16, instance.transform, sizeof(instance.transform));
+        std::memcpy(colors + i * 4, instance.color, sizeof(instance.color));
+
+        const uint32_t material = getMaterial(keys[i]);
+        const uint32_t mesh = getMesh(keys[i]);
+        if (!batches.empty() && batches.back().material == material && batches.back().mesh == mesh)
+        {
+            batches.back().instanceCount++;
+            continue;
+        }
+        batches.push_back({mesh, material, i, 1});
+
+        // The same state changes draw() makes
+        const uint32_t pipeline = materials[material].pipeline;
+        statistics.pipelineBinds += pipeline != lastPipeline;
+        statistics.materialBinds += material != lastMaterial;
+        statistics.meshBinds += meshes[mesh].vertexBuffer != lastVertexBuffer ||
+            meshes[mesh].indexBuffer != lastIndexBuffer;
+        lastPipeline = pipeline;
+        lastMaterial = material;
+        lastVertexBuffer = meshes[mesh].vertexBuffer;
+        lastIndexBuffer = meshes[mesh].indexBuffer;
+    }
+    renderer->getMemoryAllocator().flush(frame.instances.allocation);
+    statistics.drawCount = static_cast<uint32_t>(batches.size());
+    statistics.chunkCount = getChunkCount(statistics.drawCount, renderer->getJobSystem().getThreadCount());
+    requests.clear();
+    keys.clear();
+    order.clear();
+
+    // Host writes are visible to the frame's submission, only the attachments need the graph
+    RenderGraph* graph = &renderer->getRenderGraph();
+    const RenderGraphResource target = renderer->getBackbuffer();
+    const RenderGraphResource depth = graph->createImage(
+        "BatchDepth", {depthFormat, renderer->getRenderExtent(), VK_IMAGE_ASPECT_DEPTH_BIT});
+    graph->addPass("Batches", [=](RenderGraph::PassBuilder& builder)
+                   {
+                       builder.colorAttachment(target);
+                       builder.depthAttachment(depth, false);
+                   }, [this, graph, target, depth, &frame, sortedBatches = batches, camera = std::vector<float>(
+                       viewProjection, viewProjection + 16)](VkCommandBuffer commandBuffer)
+                   {
+                       draw(commandBuffer, frame, graph->getImageView(target), graph->getImageView(depth),
+                            sortedBatches, camera.data());
+                   });
+}
+
+DrawBatcher::Statistics DrawBatcher::getStatistics() const
+{
+    return statistics;
+}
+
+void DrawBatcher::requestPipeline(Pipeline& pipeline)
+{
+    ShaderLibrary& shaders = renderer->getShaderLibrary();
+    GraphicsPipelineDesc desc;
+    desc.stages.push_back(shaders.getStage(pipeline.vertexShader));
+    desc.stages.push_back(shaders.getStage(pipeline.fragmentShader));
+    desc.vertexBindings.push_back({0, VERTEX_STRIDE, VK_VERTEX_INPUT_RATE_VERTEX});
+    desc.vertexAttributes = {
+        {0, 0, VK_FORMAT_R32G32B32_SFLOAT, 0},
+        {1, 0, VK_FORMAT_R32G32B32_SFLOAT, 3 * sizeof(float)},
+    };
+    desc.cullMode = VK_CULL_MODE_BACK_BIT;
+    desc.depthTest = true;
+    desc.depthWrite = true;
+    VkPipelineColorBlendAttachmentState blendAttachment = {};
+    blendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT |
+        VK_COLOR_COMPONENT_A_BIT;
+    desc.blendAttachments.push_back(blendAttachment);
+    desc.layout = pipeline.layout;
+    desc.colorFormats.push_back(renderer->getRenderFormat());
+    desc.depthFormat = depthFormat;
+    pipeline.handle = renderer->getPipelineCompiler().requestGraphics(desc, pipeline.handle);
+}
+
+void DrawBatcher::sort()
+{
+    // Least significant digit first radix sort, a byte per pass. One counting sweep builds the histograms of all
+    // eight digits, and a digit every key shares, like the pipeline byte of most frames, costs no pass at all.
+    const size_t count = keys.size();
+    uint32_t histograms[8][256] = {};
+    for (const uint64_t key : keys)
+        for (uint32_t digit = 0; digit < 8; digit++)
+            histograms[digit][(key >> (digit * 8)) & 0xFF]++;
+
+    sortKeys.resize(count);
+    sortOrder.resize(count);
+    for (uint32_t digit = 0; digit < 8; digit++)
+    {
+        uint32_t* histogram = histograms[digit];
+        if (histogram[(keys[0] >> (digit * 8)) & 0xFF] == count)
+        {
+            statistics.skippedPasses++;
+            continue;
+        }
+        uint32_t offset = 0;
+        for (uint32_t bucket = 0; bucket < 256; bucket++)
+        {
+            const uint32_t bucketCount = histogram[bucket];
+            histogram[bucket] = offset;
+            offset += bucketCount;
+        }
+        for (size_t i = 0; i < count; i++)
+        {
+            const uint32_t target = histogram[(keys[i] >> (digit * 8)) & 0xFF]++;
+            sortKeys[target] = keys[i];
+            sortOrder[target] = order[i];
+        }
+        keys.swap(sortKeys);
+        order.swap(sortOrder);
+    }
+}
+
+void DrawBatcher::reserveInstances(FrameData& frame, uint32_t count)
+{
+    if (count <= frame.capacity)
+        return;
+    uint32_t capacity = std::max(frame.capacity, MIN_INSTANCE_CAPACITY);
+    while (capacity < count)
+        capacity *= 2;
+    // Only this slot's frames read its indices, and the registry holds them back until those are done
+    BindlessRegistry& bindless = renderer->getBindless();
+    if (frame.capacity > 0)
+    {
+        bindless.releaseBuffer(frame.transformBuffer);
+        bindless.releaseBuffer(frame.colorBuffer);
+        renderer->destroyBuffer(frame.instances);
+    }
+    frame.instances = renderer->createBuffer(static_cast<VkDeviceSize>(capacity) * sizeof(Instance),
+                                             VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                             VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+    frame.capacity = capacity;
+    const VkDeviceSize transformSize = static_cast<VkDeviceSize>(capacity) * 16 * sizeof(float);
+    frame.transformBuffer = bindless.registerBuffer(frame.instances.buffer, 0, transformSize);
+    frame.colorBuffer = bindless.registerBuffer(frame.instances.buffer, transformSize,
+                                                static_cast<VkDeviceSize>(capacity) * 4 * sizeof(float));
+    DebugConfig::verbose("[Vulkan] Draw batcher instance buffer grown to %u instances", capacity);
+}
+
+void DrawBatcher::draw(VkCommandBuffer commandBuffer, const FrameData& frame, VkImageView colorView,
+                       VkImageView depthView, const std::vector<Batch>& sortedBatches,
+                       const float* cameraViewProjection)
+{
+    const VkExtent2D extent = renderer->getRenderExtent();
+    // The batches are recorded by the job system into secondary command buffers, a chunk of them each
+    renderer->beginRendering(commandBuffer, colorView, depthView,
+                             VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT);
+
+    // Pipelines are resolved up front, skipped until compiled
+    std::vector<VkPipeline> pipelineHandles(pipelines.size(), VK_NULL_HANDLE);
+    for (uint32_t i = 0; i < pipelines.size(); i++)
+        pipelineHandles[i] = renderer->getPipelineCompiler().get(pipelines[i].handle);
+
+    const uint32_t batchCount = static_cast<uint32_t>(sortedBatches.size());
+    const uint32_t chunkCount = getChunkCount(batchCount, renderer->getJobSystem().getThreadCount());
+    renderer->recordParallel(chunkCount, [&](VkCommandBuffer chunkBuffer, uint32_t chunk)
+    {
+        const VkViewport viewport = {0.0f, 0.0f, static_cast<float>(extent.width),
+                                     static_cast<float>(extent.height), 0.0f, 1.0f};
+        const VkRect2D scissor = {{0, 0}, extent};
+        vkCmdSetViewport(chunkBuffer, 0, 1, &viewport);
+        vkCmdSetScissor(chunkBuffer, 0, 1, &scissor);
+
+        BatchConstants constants = {};
+        std::memcpy(constants.viewProjection, cameraViewProjection, sizeof(constants.viewProjection));
+        constants.transformBuffer = frame.transformBuffer;
+        constants.colorBuffer = frame.colorBuffer;
+        // Nothing is bound at the start of a secondary command buffer. The bindless set stays bound across
+        // pipelines of compatible layouts, in practice it is bound once per chunk.
+        VkPipelineLayout boundLayout = VK_NULL_HANDLE;
+        uint32_t boundPipeline = UINT32_MAX;
+        uint32_t boundMaterial = UINT32_MAX;
+        VkBuffer boundVertexBuffer = VK_NULL_HANDLE;
+        VkBuffer boundIndexBuffer = VK_NULL_HANDLE;
+        const uint32_t first = static_cast<uint32_t>(static_cast<uint64_t>(batchCount) * chunk / chunkCount);
+        const uint32_t last = static_cast<uint32_t>(static_cast<uint64_t>(batchCount) * (chunk + 1) / chunkCount);
+        for (uint32_t b = first; b < last; b++)
+        {
+            const Batch& batch = sortedBatches[b];
+            const Material& material = materials[batch.material];
+            const Pipeline& pipeline = pipelines[material.pipeline];
+            if (pipelineHandles[material.pipeline] == VK_NULL_HANDLE)
+                continue;
+            if (material.pipeline != boundPipeline)
+            {
+                vkCmdBindPipeline(chunkBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineHandles[material.pipeline]);
+                if (pipeline.layout != boundLayout)
+                {
+                    renderer->getBindless().bind(chunkBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline.layout);
+                    boundLayout = pipeline.layout;
+                }
+                boundPipeline = material.pipeline;
+                boundMaterial = UINT32_MAX;
+            }
+            if (batch.material != boundMaterial)
+            {
+                std::memcpy(constants.color, material.color, sizeof(constants.color));
+                vkCmdPushConstants(chunkBuffer, pipeline.layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(constants),
+                                   &constants);
+                boundMaterial = batch.material;
+            }
+
+            const Mesh& mesh = meshes[batch.mesh];
+            if (mesh.vertexBuffer != boundVertexBuffer)
+            {
+                const VkDeviceSize vertexOffset = 0;
+                vkCmdBindVertexBuffers(chunkBuffer, 0, 1, &mesh.vertexBuffer, &vertexOffset);
+                boundVertexBuffer = mesh.vertexBuffer;
+            }
+            if (mesh.indexBuffer != boundIndexBuffer)
+            {
+                vkCmdBindIndexBuffer(chunkBuffer, mesh.indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+                boundIndexBuffer = mesh.indexBuffer;
+            }
+            vkCmdDrawIndexed(chunkBuffer, mesh.indexCount, batch.instanceCount, mesh.firstIndex, mesh.vertexOffset,
+                             batch.firstInstance);
+        }
+    }, depthFormat);
+    vkCmdEndRendering(commandBuffer);
+}
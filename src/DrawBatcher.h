@@ -0,0 +1,142 @@
+//
+// Created by Batur on 18/10/2026.
+//
+
+#ifndef DRAWBATCHER_H
+#define DRAWBATCHER_H
+
+#include <string>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+#include "BindlessRegistry.h"
+#include "MemoryAllocator.h"
+#include "PipelineCompiler.h"
+
+class VulkanRenderer;
+
+// CPU side draw submission for scenes rebuilt every frame.
+// Draws are collected with a 64-bit sort key, pipeline then material then mesh then front to back depth, and radix
+// sorted once per frame. Runs of the same mesh and material become one instanced draw, and state is only bound where
+// the sorted order changes it, a pipeline once per frame. Instance transforms and colors go to separate arrays of a
+// per-frame instance buffer, registered with the BindlessRegistry and read by shaders/batch.vert through the pushed
+// indices and gl_InstanceIndex, so no descriptor set is allocated per frame. The sorted batches are split in
+// contiguous chunks recorded in parallel with VulkanRenderer::recordParallel(), a chunk per thread at most.
+// Vertices are three floats of position followed by three of normal, indices are 32 bit. Not thread safe.
+class DrawBatcher
+{
+public:
+    static constexpr uint32_t MAX_PIPELINES = 1u << 8;
+    static constexpr uint32_t MAX_MATERIALS = 1u << 16;
+    static constexpr uint32_t MAX_MESHES = 1u << 16;
+
+    struct Statistics
+    {
+        uint32_t requestCount;
+        uint32_t drawCount;
+        uint32_t pipelineBinds;
+        uint32_t materialBinds;
+        uint32_t meshBinds;
+        // Digit passes the sort could skip because every key had the same byte
+        uint32_t skippedPasses;
+        // Secondary command buffers the batches were recorded into, every chunk binds its first state again
+        uint32_t chunkCount;
+        double sortMs;
+    };
+
+    void init(VulkanRenderer& renderer);
+    void destroy();
+
+    // Vertex shader reading the bindless instance arrays and push constants like shaders/batch.vert
+    uint32_t addPipeline(const std::string& vertexShader, const std::string& fragmentShader);
+    uint32_t addMaterial(uint32_t pipeline, const float color[4]);
+    // The buffers must outlive the batcher
+    uint32_t addMesh(VkBuffer vertexBuffer, VkBuffer indexBuffer, uint32_t firstIndex, uint32_t indexCount,
+                     int32_t vertexOffset);
+
+    // Column major, clip space as Vulkan expects it. Set before submitting, the depth of the keys comes from it.
+    void setCamera(const float viewProjection[16]);
+    // Valid for the current frame only, color is multiplied with the material's
+    void submit(uint32_t mesh, uint32_t material, const float transform[16], const float color[4]);
+    // Sorts the frame's draws and adds their pass to the render graph, between beginFrame() and endFrame()
+    void render();
+    Statistics getStatistics() const;
+
+private:
+    struct Pipeline
+    {
+        std::string vertexShader;
+        std::string fragmentShader;
+        VkPipelineLayout layout;
+        PipelineHandle handle;
+    };
+
+    struct Material
+    {
+        uint32_t pipeline;
+        float color[4];
+    };
+
+    struct Mesh
+    {
+        VkBuffer vertexBuffer;
+        VkBuffer indexBuffer;
+        uint32_t firstIndex;
+        uint32_t indexCount;
+        int32_t vertexOffset;
+    };
+
+    struct Instance
+    {
+        float transform[16];
+        float color[4];
+    };
+
+    // One instanced draw after sorting
+    struct Batch
+    {
+        uint32_t mesh;
+        uint32_t material;
+        uint32_t firstInstance;
+        uint32_t instanceCount;
+    };
+
+    // Instance arrays of a frame slot, transforms first then colors, each registered as a bindless buffer
+    struct FrameData
+    {
+        MemoryAllocator::Buffer instances;
+        uint32_t capacity = 0;
+        uint32_t transformBuffer = BindlessRegistry::INVALID_INDEX;
+        uint32_t colorBuffer = BindlessRegistry::INVALID_INDEX;
+    };
+
+    VulkanRenderer* renderer = nullptr;
+    VkDevice device = VK_NULL_HANDLE;
+    VkFormat depthFormat = VK_FORMAT_UNDEFINED;
+
+    std::vector<Pipeline> pipelines;
+    std::vector<Material> materials;
+    std::vector<Mesh> meshes;
+    std::vector<FrameData> frames;
+    uint32_t reloadListener = 0;
+    uint32_t formatListener = 0;
+
+    float viewProjection[16] = {};
+
+    // Requests of the current frame, keys and indices are sorted together
+    std::vector<Instance> requests;
+    std::vector<uint64_t> keys;
+    std::vector<uint32_t> order;
+    std::vector<uint64_t> sortKeys;
+    std::vector<uint32_t> sortOrder;
+    std::vector<Batch> batches;
+    Statistics statistics = {};
+
+    void requestPipeline(Pipeline& pipeline);
+    void sort();
+    void reserveInstances(FrameData& frame, uint32_t count);
+    void draw(VkCommandBuffer commandBuffer, const FrameData& frame, VkImageView colorView, VkImageView depthView,
+              const std::vector<Batch>& sortedBatches, const float* cameraViewProjection);
+};
+
+#endif //DRAWBATCHER_H
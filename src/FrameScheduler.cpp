@@ -0,0 +1,162 @@
+//
+// Created by Batur on 18/10/2026.
+//
+
+#include "FrameScheduler.h"
+
+#include <cstring>
+#include <thread>
+
+#include "DebugConfig.h"
+
+FrameScheduler::FrameScheduler(Mode mode, uint32_t targetFps)
+    : mode(mode)
+{
+    setTargetFps(targetFps);
+    wakeEventType = SDL_RegisterEvents(1);
+}
+
+void FrameScheduler::setMode(Mode newMode)
+{
+    mode = newMode;
+    nextFrameNs = 0;
+    dirty = true;
+    DebugConfig::verbose("[Scheduler] Frame mode: %s", getModeName(mode));
+}
+
+FrameScheduler::Mode FrameScheduler::getMode() const
+{
+    return mode;
+}
+
+void FrameScheduler::cycleMode()
+{
+    switch (mode)
+    {
+    case Mode::Idle:
+        setMode(Mode::Paced);
+        break;
+    case Mode::Paced:
+        setMode(Mode::OnDirty);
+        break;
+    case Mode::OnDirty:
+        setMode(Mode::Idle);
+        break;
+    }
+}
+
+void FrameScheduler::setTargetFps(uint32_t fps)
+{
+    framePeriodNs = fps > 0 ? SDL_NS_PER_SECOND / fps : 0;
+    nextFrameNs = 0;
+}
+
+uint32_t FrameScheduler::getTargetFps() const
+{
+    return framePeriodNs > 0 ? static_cast<uint32_t>(SDL_NS_PER_SECOND / framePeriodNs) : 0;
+}
+
+void FrameScheduler::setIdleTimeout(int32_t milliseconds)
+{
+    idleTimeoutMs = milliseconds;
+}
+
+void FrameScheduler::markDirty()
+{
+    if (dirty.exchange(true))
+        return;
+
+    // Push a dummy event so a thread blocked in SDL_WaitEvent wakes up
+    if (wakeEventType != 0)
+    {
+        SDL_Event event = {};
+        event.type = wakeEventType;
+        SDL_PushEvent(&event);
+    }
+}
+
+bool FrameScheduler::waitForFrame(const std::function<void(const SDL_Event&)>& handler)
+{
+    SDL_Event event;
+    switch (mode)
+    {
+    case Mode::Paced:
+        {
+            const Uint64 now = SDL_GetTicksNS();
+            // Resynchronise instead of bursting frames when we fell more than one period behind
+            if (nextFrameNs == 0 || now > nextFrameNs + framePeriodNs)
+                nextFrameNs = now;
+            waitUntil(nextFrameNs);
+            nextFrameNs += framePeriodNs;
+            drainEvents(handler);
+            dirty = false;
+            return true;
+        }
+    case Mode::Idle:
+        if (SDL_WaitEventTimeout(&event, idleTimeoutMs))
+            dispatch(event, handler);
+        drainEvents(handler);
+        dirty = false;
+        return true;
+    case Mode::OnDirty:
+        if (!dirty && SDL_WaitEvent(&event))
+            dispatch(event, handler);
+        drainEvents(handler);
+        return dirty.exchange(false);
+    }
+    return true;
+}
+
+const char* FrameScheduler::getModeName(Mode mode)
+{
+    switch (mode)
+    {
+    case Mode::Idle:
+        return "idle";
+    case Mode::Paced:
+        return "paced";
+    case Mode::OnDirty:
+        return "dirty";
+    }
+    return "unknown";
+}
+
+bool FrameScheduler::parseMode(const char* name, Mode& mode)
+{
+    if (!name)
+        return false;
+    for (Mode candidate : {Mode::Idle, Mode::Paced, Mode::OnDirty})
+    {
+        if (std::strcmp(name, getModeName(candidate)) == 0)
+        {
+            mode = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+void FrameScheduler::waitUntil(Uint64 deadlineNs) const
+{
+    Uint64 now = SDL_GetTicksNS();
+    if (now + SPIN_THRESHOLD_NS < deadlineNs)
+        SDL_DelayNS(deadlineNs - now - SPIN_THRESHOLD_NS);
+
+    while (SDL_GetTicksNS() < deadlineNs)
+        std::this_thread::yield();
+}
+
+void FrameScheduler::dispatch(const SDL_Event& event, const std::function<void(const SDL_Event&)>& handler)
+{
+    if (event.type == wakeEventType)
+        return;
+    dirty = true;
+    handler(event);
+}
+
+void FrameScheduler::drainEvents(const std::function<void(const SDL_Event&)>& handler)
+{
+    SDL_Event event;
+    while (SDL_PollEvent(&event))
+        dispatch(event, handler);
+}
@@ -0,0 +1,61 @@
+//
+// Created by Batur on 18/10/2026.
+//
+
+#ifndef FRAMESCHEDULER_H
+#define FRAMESCHEDULER_H
+
+#include <atomic>
+#include <functional>
+#include <SDL3/SDL.h>
+
+// Decides when the main loop renders and blocks the thread in between, so an idle window does not burn a core.
+class FrameScheduler
+{
+public:
+    enum class Mode
+    {
+        // Blocks on events, renders on every event batch and at least once per idle timeout
+        Idle,
+        // Renders continuously at the target frame rate using a sleep + spin wait
+        Paced,
+        // Blocks until something marks the frame dirty (any event or markDirty())
+        OnDirty
+    };
+
+    explicit FrameScheduler(Mode mode = Mode::Idle, uint32_t targetFps = 60);
+
+    void setMode(Mode mode);
+    Mode getMode() const;
+    void cycleMode();
+    void setTargetFps(uint32_t fps);
+    uint32_t getTargetFps() const;
+    void setIdleTimeout(int32_t milliseconds);
+
+    // Thread safe, wakes up a blocked waitForFrame()
+    void markDirty();
+
+    // Waits according to the current mode, dispatches every pending event to `handler`
+    // and returns true when a frame should be rendered.
+    bool waitForFrame(const std::function<void(const SDL_Event&)>& handler);
+
+    static const char* getModeName(Mode mode);
+    static bool parseMode(const char* name, Mode& mode);
+
+private:
+    // Below this margin we stop trusting the OS sleep granularity and spin instead
+    static constexpr Uint64 SPIN_THRESHOLD_NS = 2000000;
+
+    Mode mode;
+    Uint64 framePeriodNs = 0;
+    Uint64 nextFrameNs = 0;
+    int32_t idleTimeoutMs = 250;
+    std::atomic<bool> dirty{ true };
+    Uint32 wakeEventType = 0;
+
+    void waitUntil(Uint64 deadlineNs) const;
+    void dispatch(const SDL_Event& event, const std::function<void(const SDL_Event&)>& handler);
+    void drainEvents(const std::function<void(const SDL_Event&)>& handler);
+};
+
+#endif //FRAMESCHEDULER_H
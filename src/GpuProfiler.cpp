@@ -0,0 +1,260 @@
+//
+// Created by Batur on 18/10/2026.
+//
+
+#include "GpuProfiler.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+#include <imgui.h>
+
+#include "DebugConfig.h"
+
+constexpr uint32_t GpuProfiler::MAX_SCOPES;
+constexpr uint32_t GpuProfiler::AVERAGE_WINDOW;
+
+void GpuProfiler::init(VkPhysicalDevice physicalDevice, VkDevice deviceHandle, uint32_t queueFamily,
+                       uint32_t framesInFlight, const VkAllocationCallbacks* allocationCallbacks)
+{
+    device = deviceHandle;
+    allocator = allocationCallbacks;
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+    uint32_t familyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &familyCount, nullptr);
+    std::vector<VkQueueFamilyProperties> families(familyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &familyCount, families.data());
+
+    const uint32_t validBits = queueFamily < familyCount ? families[queueFamily].timestampValidBits : 0;
+    supported = validBits > 0 && properties.limits.timestampPeriod > 0.0f;
+    if (!supported)
+    {
+        DebugConfig::warning("[Vulkan] Timestamps not supported on queue family %u, GPU profiler disabled",
+                             queueFamily);
+        return;
+    }
+    timestampPeriod = properties.limits.timestampPeriod;
+    timestampMask = validBits >= 64 ? ~0ull : (1ull << validBits) - 1;
+
+    frames.resize(framesInFlight);
+    for (FrameQueries& frame : frames)
+    {
+        VkQueryPoolCreateInfo poolInfo = {};
+        poolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        poolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+        poolInfo.queryCount = 2 * MAX_SCOPES;
+        if (vkCreateQueryPool(device, &poolInfo, allocator, &frame.queryPool) != VK_SUCCESS)
+        {
+            throw std::runtime_error("[Vulkan] Failed to create timestamp query pool!");
+        }
+        frame.scopes.reserve(MAX_SCOPES);
+    }
+    DebugConfig::verbose("[Vulkan] GPU profiler: %u valid timestamp bits, %.3f ns per tick", validBits,
+                         timestampPeriod);
+}
+
+void GpuProfiler::destroy()
+{
+    for (FrameQueries& frame : frames)
+        if (frame.queryPool != VK_NULL_HANDLE)
+            vkDestroyQueryPool(device, frame.queryPool, allocator);
+    frames.clear();
+    currentFrame = nullptr;
+    supported = false;
+}
+
+bool GpuProfiler::isSupported() const
+{
+    return supported;
+}
+
+void GpuProfiler::beginFrame(VkCommandBuffer commandBuffer, uint32_t frameIndex)
+{
+    if (!supported)
+        return;
+    currentFrame = &frames[frameIndex];
+    collect(*currentFrame);
+    currentFrame->scopes.clear();
+    openScopes.clear();
+    currentPath.clear();
+    vkCmdResetQueryPool(commandBuffer, currentFrame->queryPool, 0, 2 * MAX_SCOPES);
+}
+
+void GpuProfiler::beginScope(VkCommandBuffer commandBuffer, const char* name)
+{
+    if (!supported || !currentFrame)
+        return;
+
+    OpenScope open = {UINT32_MAX, currentPath.size()};
+    if (!currentPath.empty())
+        currentPath += '/';
+    currentPath += name;
+    if (currentFrame->scopes.size() < MAX_SCOPES)
+    {
+        open.scope = static_cast<uint32_t>(currentFrame->scopes.size());
+        currentFrame->scopes.push_back(getStatisticsIndex(name));
+        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, currentFrame->queryPool,
+                            2 * open.scope);
+    }
+    openScopes.push_back(open);
+}
+
+void GpuProfiler::endScope(VkCommandBuffer commandBuffer)
+{
+    if (!supported || openScopes.empty())
+        return;
+
+    const OpenScope open = openScopes.back();
+    openScopes.pop_back();
+    currentPath.resize(open.parentPathLength);
+    if (open.scope != UINT32_MAX)
+        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, currentFrame->queryPool,
+                            2 * open.scope + 1);
+}
+
+const std::vector<GpuProfiler::ScopeStatistics>& GpuProfiler::getStatistics() const
+{
+    return statistics;
+}
+
+void GpuProfiler::drawPanel() const
+{
+    if (!ImGui::CollapsingHeader("GPU timings", ImGuiTreeNodeFlags_DefaultOpen))
+        return;
+    if (!supported)
+    {
+        ImGui::TextUnformatted("Timestamps not supported");
+        return;
+    }
+    if (!ImGui::BeginTable("gpu_timings", 4, ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit))
+        return;
+    ImGui::TableSetupColumn("Scope", ImGuiTableColumnFlags_WidthStretch);
+    ImGui::TableSetupColumn("Avg ms");
+    ImGui::TableSetupColumn("Min ms");
+    ImGui::TableSetupColumn("Max ms");
+    ImGui::TableHeadersRow();
+    for (const ScopeStatistics& scope : statistics)
+    {
+        ImGui::TableNextRow();
+        ImGui::TableNextColumn();
+        ImGui::Indent(scope.depth * 10.0f + 0.001f);
+        ImGui::TextUnformatted(scope.name.c_str());
+        ImGui::Unindent(scope.depth * 10.0f + 0.001f);
+        ImGui::TableNextColumn();
+        ImGui::Text("%.3f", scope.averageMs);
+        ImGui::TableNextColumn();
+        ImGui::Text("%.3f", scope.minMs);
+        ImGui::TableNextColumn();
+        ImGui::Text("%.3f", scope.maxMs);
+    }
+    ImGui::EndTable();
+}
+
+bool GpuProfiler::writeCsv(const std::string& path) const
+{
+    FILE* file = std::fopen(path.c_str(), "w");
+    if (!file)
+        return false;
+    std::fprintf(file, "scope,depth,last_ms,avg_ms,min_ms,max_ms,samples\n");
+    for (const ScopeStatistics& scope : statistics)
+        std::fprintf(file, "%s,%u,%.6f,%.6f,%.6f,%.6f,%llu\n", scope.path.c_str(), scope.depth, scope.lastMs,
+                     scope.averageMs, scope.minMs, scope.maxMs, static_cast<unsigned long long>(scope.samples));
+    return std::fclose(file) == 0;
+}
+
+bool GpuProfiler::writeJson(const std::string& path) const
+{
+    FILE* file = std::fopen(path.c_str(), "w");
+    if (!file)
+        return false;
+    // Scope names are code literals, nothing in them needs escaping
+    std::fprintf(file, "{\n  \"timestampPeriodNs\": %.6f,\n  \"scopes\": [", timestampPeriod);
+    for (size_t i = 0; i < statistics.size(); i++)
+    {
+        const ScopeStatistics& scope = statistics[i];
+        std::fprintf(file,
+                     "%s\n    {\"path\": \"%s\", \"depth\": %u, \"lastMs\": %.6f, \"avgMs\": %.6f, \"minMs\": %.6f, "
+                     "\"maxMs\": %.6f, \"samples\": %llu}", i == 0 ? "" : ",", scope.path.c_str(), scope.depth,
+                     scope.lastMs, scope.averageMs, scope.minMs, scope.maxMs,
+                     static_cast<unsigned long long>(scope.samples));
+    }
+    std::fprintf(file, "\n  ]\n}\n");
+    return std::fclose(file) == 0;
+}
+
+void GpuProfiler::collect(FrameQueries& frame)
+{
+    if (frame.scopes.empty())
+        return;
+
+    // Value and availability per query, no wait: the slot's submission is known to be complete
+    const uint32_t queryCount = 2 * static_cast<uint32_t>(frame.scopes.size());
+    std::vector<uint64_t> results(2 * queryCount);
+    const VkResult err = vkGetQueryPoolResults(device, frame.queryPool, 0, queryCount,
+                                               results.size() * sizeof(uint64_t), results.data(),
+                                               2 * sizeof(uint64_t),
+                                               VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+    if (err != VK_SUCCESS && err != VK_NOT_READY)
+        return;
+
+    for (size_t i = 0; i < frame.scopes.size(); i++)
+    {
+        const uint64_t* begin = &results[4 * i];
+        const uint64_t* end = &results[4 * i + 2];
+        if (!begin[1] || !end[1])
+            continue;
+
+        // Masked difference stays correct across a counter wrap
+        const uint64_t ticks = (end[0] - begin[0]) & timestampMask;
+        const double ms = static_cast<double>(ticks) * timestampPeriod / 1000000.0;
+
+        ScopeStatistics& scope = statistics[frame.scopes[i]];
+        History& history = histories[frame.scopes[i]];
+        history.samples[history.next] = ms;
+        history.next = (history.next + 1) % AVERAGE_WINDOW;
+        history.count = std::min(history.count + 1, AVERAGE_WINDOW);
+
+        double sum = 0.0;
+        scope.minMs = history.samples[0];
+        scope.maxMs = history.samples[0];
+        for (uint32_t s = 0; s < history.count; s++)
+        {
+            sum += history.samples[s];
+            scope.minMs = std::min(scope.minMs, history.samples[s]);
+            scope.maxMs = std::max(scope.maxMs, history.samples[s]);
+        }
+        scope.lastMs = ms;
+        scope.averageMs = sum / history.count;
+        scope.samples++;
+    }
+}
+
+uint32_t GpuProfiler::getStatisticsIndex(const char* name)
+{
+    const auto it = statisticsIndices.find(currentPath);
+    if (it != statisticsIndices.end())
+        return it->second;
+
+    ScopeStatistics scope = {};
+    scope.path = currentPath;
+    scope.name = name;
+    scope.depth = static_cast<uint32_t>(openScopes.size());
+    const uint32_t index = static_cast<uint32_t>(statistics.size());
+    statistics.push_back(scope);
+    histories.push_back(History());
+    statisticsIndices.emplace(currentPath, index);
+    return index;
+}
+
+GpuScope::GpuScope(GpuProfiler& gpuProfiler, VkCommandBuffer buffer, const char* name)
+    : profiler(gpuProfiler), commandBuffer(buffer)
+{
+    profiler.beginScope(commandBuffer, name);
+}
+
+GpuScope::~GpuScope()
+{
+    profiler.endScope(commandBuffer);
+}
@@ -0,0 +1,104 @@
+//
+// Created by Batur on 18/10/2026.
+//
+
+#ifndef GPUPROFILER_H
+#define GPUPROFILER_H
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+// GPU timings from timestamp queries, one query pool per frame in flight.
+// Results of a frame slot are read when the slot comes around again, after the renderer already waited
+// for it, so reading never stalls. Scopes nest and are identified by their path ("Frame/ImGui").
+class GpuProfiler
+{
+public:
+    static constexpr uint32_t MAX_SCOPES = 128;
+    static constexpr uint32_t AVERAGE_WINDOW = 64;
+
+    struct ScopeStatistics
+    {
+        std::string path;
+        std::string name;
+        uint32_t depth;
+        double lastMs;
+        // Over the last AVERAGE_WINDOW samples
+        double averageMs;
+        double minMs;
+        double maxMs;
+        uint64_t samples;
+    };
+
+    void init(VkPhysicalDevice physicalDevice, VkDevice device, uint32_t queueFamily, uint32_t framesInFlight,
+              const VkAllocationCallbacks* allocator);
+    void destroy();
+    // False when the queue family has no timestamp support, every call is then a no-op
+    bool isSupported() const;
+
+    // Collects the previous results of the slot and resets its queries, outside of any rendering
+    void beginFrame(VkCommandBuffer commandBuffer, uint32_t frameIndex);
+    void beginScope(VkCommandBuffer commandBuffer, const char* name);
+    void endScope(VkCommandBuffer commandBuffer);
+
+    const std::vector<ScopeStatistics>& getStatistics() const;
+    void drawPanel() const;
+    bool writeCsv(const std::string& path) const;
+    bool writeJson(const std::string& path) const;
+
+private:
+    struct FrameQueries
+    {
+        VkQueryPool queryPool = VK_NULL_HANDLE;
+        // Statistics index of every scope recorded in the frame, scope i uses queries 2i and 2i+1
+        std::vector<uint32_t> scopes;
+    };
+
+    struct History
+    {
+        double samples[AVERAGE_WINDOW];
+        uint32_t next;
+        uint32_t count;
+    };
+
+    struct OpenScope
+    {
+        // UINT32_MAX when the frame ran out of queries
+        uint32_t scope;
+        size_t parentPathLength;
+    };
+
+    VkDevice device = VK_NULL_HANDLE;
+    const VkAllocationCallbacks* allocator = nullptr;
+    bool supported = false;
+    double timestampPeriod = 1.0;
+    uint64_t timestampMask = 0;
+
+    std::vector<FrameQueries> frames;
+    FrameQueries* currentFrame = nullptr;
+    std::vector<OpenScope> openScopes;
+    std::string currentPath;
+
+    std::vector<ScopeStatistics> statistics;
+    std::vector<History> histories;
+    std::unordered_map<std::string, uint32_t> statisticsIndices;
+
+    void collect(FrameQueries& frame);
+    uint32_t getStatisticsIndex(const char* name);
+};
+
+// Profiles everything recorded during its lifetime
+class GpuScope
+{
+public:
+    GpuScope(GpuProfiler& profiler, VkCommandBuffer commandBuffer, const char* name);
+    ~GpuScope();
+
+private:
+    GpuProfiler& profiler;
+    VkCommandBuffer commandBuffer;
+};
+
+#endif //GPUPROFILER_H
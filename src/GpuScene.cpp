@@ -0,0 +1,639 @@
+//
+// Created by Batur on 18/10/2026.
+//
+
+#include "GpuScene.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+
+#include "DebugConfig.h"
+#include "VulkanRenderer.h"
+
+namespace
+{
+    constexpr const char* CULL_SHADER = "cull.comp.spv";
+    constexpr uint32_t CULL_GROUP_SIZE = 64;
+
+    struct CullConstants
+    {
+        float planes[6][4];
+        uint32_t objectCount;
+    };
+
+    // Rows of a column major matrix combined as in Gribb and Hartmann, with Vulkan's 0..1 depth range
+    void getFrustumPlanes(const float* m, float planes[6][4])
+    {
+        for (int i = 0; i < 4; i++)
+        {
+            const float row0 = m[i * 4 + 0];
+            const float row1 = m[i * 4 + 1];
+            const float row2 = m[i * 4 + 2];
+            const float row3 = m[i * 4 + 3];
+            planes[0][i] = row3 + row0;
+            planes[1][i] = row3 - row0;
+            planes[2][i] = row3 + row1;
+            planes[3][i] = row3 - row1;
+            planes[4][i] = row2;
+            planes[5][i] = row3 - row2;
+        }
+        for (int p = 0; p < 6; p++)
+        {
+            const float length = std::sqrt(planes[p][0] * planes[p][0] + planes[p][1] * planes[p][1] +
+                planes[p][2] * planes[p][2]);
+            if (length > 0.0f)
+                for (float& value : planes[p])
+                    value /= length;
+        }
+    }
+
+    float getRadiusScale(const float* transform)
+    {
+        float scale = 0.0f;
+        for (int column = 0; column < 3; column++)
+        {
+            const float* axis = transform + column * 4;
+            scale = std::max(scale, std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]));
+        }
+        return scale;
+    }
+}
+
+void GpuScene::DirtyRange::add(uint32_t index)
+{
+    first = std::min(first, index);
+    last = std::max(last, index + 1);
+}
+
+void GpuScene::addRequirements(DeviceRequirements& requirements)
+{
+    requirements.features.multiDrawIndirect = VK_TRUE;
+    requirements.features.drawIndirectFirstInstance = VK_TRUE;
+    requirements.features12.drawIndirectCount = VK_TRUE;
+    requirements.optionalExtensions.push_back(VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME);
+}
+
+void GpuScene::init(VulkanRenderer& vulkanRenderer, uint32_t objectCapacity, uint32_t meshCapacity,
+                    uint32_t vertexCapacity, uint32_t indexCapacity)
+{
+    renderer = &vulkanRenderer;
+    device = renderer->getDevice();
+    allocator = renderer->getAllocator();
+    depthFormat = renderer->getDepthFormat();
+    maxObjects = objectCapacity;
+    maxMeshes = meshCapacity;
+    maxVertices = vertexCapacity;
+    maxIndices = indexCapacity;
+
+    vertexBuffer = renderer->createBuffer(static_cast<VkDeviceSize>(maxVertices) * sizeof(Vertex),
+                                          VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                          VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    indexBuffer = renderer->createBuffer(static_cast<VkDeviceSize>(maxIndices) * sizeof(uint32_t),
+                                         VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    objectBuffer = renderer->createBuffer(static_cast<VkDeviceSize>(maxObjects) * sizeof(ObjectData),
+                                          VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                          VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    meshBuffer = renderer->createBuffer(static_cast<VkDeviceSize>(maxMeshes) * sizeof(MeshData),
+                                        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    frames.resize(renderer->getFramesInFlight());
+    for (FrameData& frame : frames)
+    {
+        frame.objectStaging = renderer->createBuffer(static_cast<VkDeviceSize>(maxObjects) * sizeof(ObjectData),
+                                                     VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                                     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+        frame.meshStaging = renderer->createBuffer(static_cast<VkDeviceSize>(maxMeshes) * sizeof(MeshData),
+                                                   VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                                   VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+        frame.buckets = renderer->createBuffer(
+            sizeof(BucketData), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+        std::memset(frame.buckets.allocation->mapped, 0, sizeof(BucketData));
+        renderer->getMemoryAllocator().flush(frame.buckets.allocation);
+    }
+
+    ShaderLibrary& shaders = renderer->getShaderLibrary();
+    if (renderer->isExtensionEnabled(VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME))
+    {
+        vkCmdPushDescriptorSetKHR = reinterpret_cast<PFN_vkCmdPushDescriptorSetKHR>(
+            vkGetDeviceProcAddr(device, "vkCmdPushDescriptorSetKHR"));
+    }
+    const ShaderLibrary::Layout layout = shaders.getLayout({CULL_SHADER},
+                                                           vkCmdPushDescriptorSetKHR ? 0 : UINT32_MAX);
+    cullLayout = layout.pipelineLayout;
+    cullSetLayout = layout.setLayouts.at(0);
+    requestCullPipeline();
+    addMaterial("scene.vert.spv", "scene.frag.spv");
+
+    reloadListener = shaders.addReloadListener([this](const std::string& name)
+    {
+        if (name == CULL_SHADER)
+            requestCullPipeline();
+        for (Material& material : materials)
+            if (name == material.vertexShader || name == material.fragmentShader)
+                requestMaterialPipeline(material);
+    });
+    // Materials are skipped until their pipelines for the new format are compiled
+    formatListener = renderer->addFormatListener([this](VkFormat)
+    {
+        for (Material& material : materials)
+        {
+            material.pipeline = 0;
+            requestMaterialPipeline(material);
+        }
+    });
+    DebugConfig::verbose("[Vulkan] GPU scene created: %u objects, %u meshes, depth format %d", maxObjects,
+                         maxMeshes, static_cast<int>(depthFormat));
+}
+
+void GpuScene::destroy()
+{
+    if (!renderer)
+        return;
+    vkDeviceWaitIdle(device);
+
+    // Pipelines belong to the renderer's compiler, layouts to the shader library
+    renderer->getShaderLibrary().removeReloadListener(reloadListener);
+    reloadListener = 0;
+    renderer->removeFormatListener(formatListener);
+    formatListener = 0;
+    for (GeometryUpload& upload : geometryUploads)
+        renderer->destroyBuffer(upload.staging);
+    geometryUploads.clear();
+    for (FrameData& frame : frames)
+    {
+        renderer->destroyBuffer(frame.objectStaging);
+        renderer->destroyBuffer(frame.meshStaging);
+        renderer->destroyBuffer(frame.buckets);
+    }
+    frames.clear();
+    renderer->destroyBuffer(vertexBuffer);
+    renderer->destroyBuffer(indexBuffer);
+    renderer->destroyBuffer(objectBuffer);
+    renderer->destroyBuffer(meshBuffer);
+
+    objects.clear();
+    meshes.clear();
+    freeObjects.clear();
+    materials.clear();
+    dirtyObjects = DirtyRange();
+    dirtyMeshes = DirtyRange();
+    vertexCount = 0;
+    indexCount = 0;
+    cullPipeline = 0;
+    statistics = {};
+    renderer = nullptr;
+}
+
+MeshHandle GpuScene::addMesh(const Vertex* vertices, uint32_t meshVertexCount, const uint32_t* indices,
+                             uint32_t meshIndexCount)
+{
+    if (meshVertexCount == 0 || meshIndexCount == 0)
+    {
+        throw std::runtime_error("[Vulkan] GPU scene meshes can't be empty!");
+    }
+    if (meshes.size() >= maxMeshes || vertexCount + meshVertexCount > maxVertices ||
+        indexCount + meshIndexCount > maxIndices)
+    {
+        throw std::runtime_error("[Vulkan] GPU scene is out of mesh space!");
+    }
+
+    // Bounding sphere around the center of the bounding box, loose but cheap to test
+    float minimum[3] = {vertices[0].position[0], vertices[0].position[1], vertices[0].position[2]};
+    float maximum[3] = {minimum[0], minimum[1], minimum[2]};
+    for (uint32_t i = 0; i < meshVertexCount; i++)
+        for (int axis = 0; axis < 3; axis++)
+        {
+            minimum[axis] = std::min(minimum[axis], vertices[i].position[axis]);
+            maximum[axis] = std::max(maximum[axis], vertices[i].position[axis]);
+        }
+    MeshData mesh = {};
+    float radius = 0.0f;
+    for (int axis = 0; axis < 3; axis++)
+        mesh.sphere[axis] = (minimum[axis] + maximum[axis]) * 0.5f;
+    for (uint32_t i = 0; i < meshVertexCount; i++)
+    {
+        const float* position = vertices[i].position;
+        radius = std::max(radius, (position[0] - mesh.sphere[0]) * (position[0] - mesh.sphere[0]) +
+                          (position[1] - mesh.sphere[1]) * (position[1] - mesh.sphere[1]) +
+                          (position[2] - mesh.sphere[2]) * (position[2] - mesh.sphere[2]));
+    }
+    mesh.sphere[3] = std::sqrt(radius);
+    mesh.indexCount = meshIndexCount;
+    mesh.firstIndex = indexCount;
+    mesh.vertexOffset = static_cast<int32_t>(vertexCount);
+
+    GeometryUpload upload = {};
+    upload.vertexOffset = static_cast<VkDeviceSize>(vertexCount) * sizeof(Vertex);
+    upload.vertexSize = static_cast<VkDeviceSize>(meshVertexCount) * sizeof(Vertex);
+    upload.indexOffset = static_cast<VkDeviceSize>(indexCount) * sizeof(uint32_t);
+    upload.indexSize = static_cast<VkDeviceSize>(meshIndexCount) * sizeof(uint32_t);
+    upload.frameNumber = UINT64_MAX;
+    upload.staging = renderer->createBuffer(upload.vertexSize + upload.indexSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+    char* mapped = static_cast<char*>(upload.staging.allocation->mapped);
+    std::memcpy(mapped, vertices, upload.vertexSize);
+    std::memcpy(mapped + upload.vertexSize, indices, upload.indexSize);
+    renderer->getMemoryAllocator().flush(upload.staging.allocation);
+    geometryUploads.push_back(upload);
+
+    vertexCount += meshVertexCount;
+    indexCount += meshIndexCount;
+    meshes.push_back(mesh);
+    dirtyMeshes.add(static_cast<uint32_t>(meshes.size() - 1));
+    statistics.meshCount = static_cast<uint32_t>(meshes.size());
+    return static_cast<MeshHandle>(meshes.size() - 1);
+}
+
+MaterialHandle GpuScene::addMaterial(const std::string& vertexShader, const std::string& fragmentShader)
+{
+    if (materials.size() >= MAX_MATERIALS)
+    {
+        throw std::runtime_error("[Vulkan] GPU scene material limit reached!");
+    }
+    const ShaderLibrary::Layout layout = renderer->getShaderLibrary().getLayout({vertexShader, fragmentShader});
+    Material material = {vertexShader, fragmentShader, layout.pipelineLayout, layout.setLayouts.at(0), 0, 0};
+    requestMaterialPipeline(material);
+    materials.push_back(material);
+    statistics.materialCount = static_cast<uint32_t>(materials.size());
+    return static_cast<MaterialHandle>(materials.size() - 1);
+}
+
+ObjectHandle GpuScene::addObject(MeshHandle mesh, MaterialHandle material, const float transform[16],
+                                 const float color[4])
+{
+    if (mesh >= meshes.size() || material >= materials.size())
+    {
+        throw std::runtime_error("[Vulkan] Unknown GPU scene mesh or material!");
+    }
+    ObjectHandle handle;
+    if (!freeObjects.empty())
+    {
+        handle = freeObjects.back();
+        freeObjects.pop_back();
+    }
+    else
+    {
+        if (objects.size() >= maxObjects)
+        {
+            throw std::runtime_error("[Vulkan] GPU scene object limit reached!");
+        }
+        handle = static_cast<ObjectHandle>(objects.size());
+        objects.emplace_back();
+    }
+
+    ObjectData& object = objects[handle];
+    std::memcpy(object.transform, transform, sizeof(object.transform));
+    std::memcpy(object.color, color, sizeof(object.color));
+    object.mesh = mesh;
+    object.bucket = material;
+    object.radiusScale = getRadiusScale(transform);
+    object.enabled = 1;
+    dirtyObjects.add(handle);
+    materials[material].objectCount++;
+    statistics.objectCount++;
+    return handle;
+}
+
+void GpuScene::setTransform(ObjectHandle handle, const float transform[16])
+{
+    ObjectData& object = objects.at(handle);
+    std::memcpy(object.transform, transform, sizeof(object.transform));
+    object.radiusScale = getRadiusScale(transform);
+    dirtyObjects.add(handle);
+}
+
+void GpuScene::removeObject(ObjectHandle handle)
+{
+    ObjectData& object = objects.at(handle);
+    if (!object.enabled)
+        return;
+    // Culling skips disabled objects, the slot is handed out again by addObject()
+    object.enabled = 0;
+    dirtyObjects.add(handle);
+    materials[object.bucket].objectCount--;
+    statistics.objectCount--;
+    freeObjects.push_back(handle);
+}
+
+void GpuScene::setCamera(const float cameraViewProjection[16])
+{
+    std::memcpy(viewProjection, cameraViewProjection, sizeof(viewProjection));
+}
+
+void GpuScene::render()
+{
+    FrameData& frame = frames[renderer->getFrameIndex()];
+    MemoryAllocator& memory = renderer->getMemoryAllocator();
+
+    // The slot's previous frame has been waited for, its counts are the visible objects
+    BucketData* buckets = static_cast<BucketData*>(frame.buckets.allocation->mapped);
+    memory.invalidate(frame.buckets.allocation);
+    statistics.visibleCount = 0;
+    for (size_t m = 0; m < materials.size(); m++)
+        statistics.visibleCount += buckets->counts[m];
+
+    // Materials get consecutive ranges of the draw buffer, sized for all their objects
+    BucketData ranges = {};
+    uint32_t drawCount = 0;
+    for (size_t m = 0; m < materials.size(); m++)
+    {
+        ranges.offsets[m] = drawCount;
+        ranges.counts[m] = materials[m].objectCount;
+        drawCount += materials[m].objectCount;
+    }
+    std::memset(buckets->counts, 0, sizeof(buckets->counts));
+    std::memcpy(buckets->offsets, ranges.offsets, sizeof(ranges.offsets));
+    memory.flush(frame.buckets.allocation);
+
+    // Staging of a finished frame can go, geometry added since the last frame is copied by this one
+    const uint64_t frameNumber = renderer->getFrameNumber();
+    const uint64_t framesInFlight = renderer->getFramesInFlight();
+    std::vector<GeometryUpload> geometry;
+    for (size_t i = 0; i < geometryUploads.size();)
+    {
+        GeometryUpload& upload = geometryUploads[i];
+        if (upload.frameNumber == UINT64_MAX)
+        {
+            upload.frameNumber = frameNumber;
+            geometry.push_back(upload);
+        }
+        else if (upload.frameNumber + framesInFlight <= frameNumber)
+        {
+            renderer->destroyBuffer(upload.staging);
+            geometryUploads[i] = geometryUploads.back();
+            geometryUploads.pop_back();
+            continue;
+        }
+        i++;
+    }
+
+    // Changed table entries go through the slot's staging buffer at their final offset
+    statistics.uploadedBytes = 0;
+    const DirtyRange objectRange = dirtyObjects;
+    const DirtyRange meshRange = dirtyMeshes;
+    if (objectRange.first < objectRange.last)
+    {
+        const VkDeviceSize offset = objectRange.first * sizeof(ObjectData);
+        const VkDeviceSize size = (objectRange.last - objectRange.first) * sizeof(ObjectData);
+        std::memcpy(static_cast<char*>(frame.objectStaging.allocation->mapped) + offset, &objects[objectRange.first],
+                    size);
+        memory.flush(frame.objectStaging.allocation, offset, size);
+        statistics.uploadedBytes += size;
+    }
+    if (meshRange.first < meshRange.last)
+    {
+        const VkDeviceSize offset = meshRange.first * sizeof(MeshData);
+        const VkDeviceSize size = (meshRange.last - meshRange.first) * sizeof(MeshData);
+        std::memcpy(static_cast<char*>(frame.meshStaging.allocation->mapped) + offset, &meshes[meshRange.first],
+                    size);
+        memory.flush(frame.meshStaging.allocation, offset, size);
+        statistics.uploadedBytes += size;
+    }
+    for (const GeometryUpload& upload : geometry)
+        statistics.uploadedBytes += upload.vertexSize + upload.indexSize;
+    dirtyObjects = DirtyRange();
+    dirtyMeshes = DirtyRange();
+
+    // Buffers written this frame wait for the reads of the frames before, the others need no barrier at all
+    RenderGraph* graph = &renderer->getRenderGraph();
+    const bool writeObjects = objectRange.first < objectRange.last;
+    const bool writeMeshes = meshRange.first < meshRange.last;
+    const bool writeGeometry = !geometry.empty();
+    const auto importTable = [graph](const char* name, VkBuffer buffer, bool written, VkPipelineStageFlags2 readers)
+    {
+        const RenderGraphState initial = {VK_IMAGE_LAYOUT_UNDEFINED, written ? readers : VK_PIPELINE_STAGE_2_NONE, 0};
+        const RenderGraphState final = {VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_2_NONE, 0};
+        return graph->importBuffer(name, buffer, VK_WHOLE_SIZE, initial, final);
+    };
+    const RenderGraphResource objectTable = importTable(
+        "SceneObjects", objectBuffer.buffer, writeObjects,
+        VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT);
+    const RenderGraphResource meshTable = importTable("SceneMeshes", meshBuffer.buffer, writeMeshes,
+                                                      VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT);
+    const RenderGraphResource vertices = importTable("SceneVertices", vertexBuffer.buffer, writeGeometry,
+                                                     VK_PIPELINE_STAGE_2_VERTEX_ATTRIBUTE_INPUT_BIT);
+    const RenderGraphResource indices = importTable("SceneIndices", indexBuffer.buffer, writeGeometry,
+                                                    VK_PIPELINE_STAGE_2_INDEX_INPUT_BIT);
+    // Counted by the GPU, read back by the host when the slot comes around again
+    const RenderGraphResource bucketTable = graph->importBuffer(
+        "SceneBuckets", frame.buckets.buffer, sizeof(BucketData),
+        {VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_2_NONE, 0},
+        {VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_2_HOST_BIT, VK_ACCESS_2_HOST_READ_BIT});
+
+    if (writeObjects || writeMeshes || writeGeometry)
+    {
+        graph->addPass("SceneUpload", [=](RenderGraph::PassBuilder& builder)
+                       {
+                           const VkPipelineStageFlags2 stage = VK_PIPELINE_STAGE_2_TRANSFER_BIT;
+                           const VkAccessFlags2 access = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+                           if (writeObjects)
+                               builder.writeBuffer(objectTable, stage, access);
+                           if (writeMeshes)
+                               builder.writeBuffer(meshTable, stage, access);
+                           if (writeGeometry)
+                           {
+                               builder.writeBuffer(vertices, stage, access);
+                               builder.writeBuffer(indices, stage, access);
+                           }
+                       }, [this, &frame, geometry, objectRange, meshRange](VkCommandBuffer commandBuffer)
+                       {
+                           uploadTables(commandBuffer, frame, geometry, objectRange, meshRange);
+                       });
+    }
+    if (objects.empty() || drawCount == 0)
+        return;
+
+    const uint32_t objectCount = static_cast<uint32_t>(objects.size());
+    // Sized for every object so the graph keeps its shape, and its transients, while objects come and go
+    const RenderGraphResource draws = graph->createBuffer(
+        "SceneDraws", static_cast<VkDeviceSize>(maxObjects) * sizeof(VkDrawIndexedIndirectCommand));
+    graph->addPass("SceneCull", [=](RenderGraph::PassBuilder& builder)
+                   {
+                       const VkPipelineStageFlags2 stage = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+                       builder.readBuffer(objectTable, stage, VK_ACCESS_2_SHADER_STORAGE_READ_BIT);
+                       builder.readBuffer(meshTable, stage, VK_ACCESS_2_SHADER_STORAGE_READ_BIT);
+                       builder.writeBuffer(draws, stage, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT);
+                       builder.writeBuffer(bucketTable, stage,
+                                           VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT);
+                   }, [this, graph, draws, &frame, objectCount, camera = std::vector<float>(viewProjection,
+                       viewProjection + 16)](VkCommandBuffer commandBuffer)
+                   {
+                       cull(commandBuffer, graph->getBuffer(draws), frame, objectCount, camera.data());
+                   });
+
+    const RenderGraphResource target = renderer->getBackbuffer();
+    const RenderGraphResource depth = graph->createImage(
+        "SceneDepth", {depthFormat, renderer->getRenderExtent(), VK_IMAGE_ASPECT_DEPTH_BIT});
+    graph->addPass("Scene", [=](RenderGraph::PassBuilder& builder)
+                   {
+                       const VkPipelineStageFlags2 indirect = VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT;
+                       builder.readBuffer(draws, indirect, VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT);
+                       builder.readBuffer(bucketTable, indirect, VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT);
+                       builder.readBuffer(objectTable, VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT,
+                                          VK_ACCESS_2_SHADER_STORAGE_READ_BIT);
+                       builder.readBuffer(vertices, VK_PIPELINE_STAGE_2_VERTEX_ATTRIBUTE_INPUT_BIT,
+                                          VK_ACCESS_2_VERTEX_ATTRIBUTE_READ_BIT);
+                       builder.readBuffer(indices, VK_PIPELINE_STAGE_2_INDEX_INPUT_BIT, VK_ACCESS_2_INDEX_READ_BIT);
+                       builder.colorAttachment(target);
+                       builder.depthAttachment(depth, false);
+                   }, [this, graph, draws, target, depth, &frame, ranges, camera = std::vector<float>(
+                       viewProjection, viewProjection + 16)](VkCommandBuffer commandBuffer)
+                   {
+                       draw(commandBuffer, graph->getBuffer(draws), frame, graph->getImageView(target),
+                            graph->getImageView(depth), ranges, camera.data());
+                   });
+}
+
+GpuScene::Statistics GpuScene::getStatistics() const
+{
+    return statistics;
+}
+
+void GpuScene::requestCullPipeline()
+{
+    ComputePipelineDesc desc;
+    desc.stage = renderer->getShaderLibrary().getStage(CULL_SHADER);
+    desc.layout = cullLayout;
+    cullPipeline = renderer->getPipelineCompiler().requestCompute(desc, cullPipeline);
+}
+
+void GpuScene::requestMaterialPipeline(Material& material)
+{
+    ShaderLibrary& shaders = renderer->getShaderLibrary();
+    GraphicsPipelineDesc desc;
+    desc.stages.push_back(shaders.getStage(material.vertexShader));
+    desc.stages.push_back(shaders.getStage(material.fragmentShader));
+    desc.vertexBindings.push_back({0, sizeof(Vertex), VK_VERTEX_INPUT_RATE_VERTEX});
+    desc.vertexAttributes = {
+        {0, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Vertex, position)},
+        {1, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Vertex, normal)},
+    };
+    desc.cullMode = VK_CULL_MODE_BACK_BIT;
+    desc.depthTest = true;
+    desc.depthWrite = true;
+    VkPipelineColorBlendAttachmentState blendAttachment = {};
+    blendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT |
+        VK_COLOR_COMPONENT_A_BIT;
+    desc.blendAttachments.push_back(blendAttachment);
+    desc.layout = material.layout;
+    desc.colorFormats.push_back(renderer->getRenderFormat());
+    desc.depthFormat = depthFormat;
+    material.pipeline = renderer->getPipelineCompiler().requestGraphics(desc, material.pipeline);
+}
+
+void GpuScene::uploadTables(VkCommandBuffer commandBuffer, const FrameData& frame,
+                            const std::vector<GeometryUpload>& geometry, const DirtyRange& objectRange,
+                            const DirtyRange& meshRange)
+{
+    for (const GeometryUpload& upload : geometry)
+    {
+        const VkBufferCopy vertexRegion = {0, upload.vertexOffset, upload.vertexSize};
+        const VkBufferCopy indexRegion = {upload.vertexSize, upload.indexOffset, upload.indexSize};
+        vkCmdCopyBuffer(commandBuffer, upload.staging.buffer, vertexBuffer.buffer, 1, &vertexRegion);
+        vkCmdCopyBuffer(commandBuffer, upload.staging.buffer, indexBuffer.buffer, 1, &indexRegion);
+    }
+    if (objectRange.first < objectRange.last)
+    {
+        const VkDeviceSize offset = objectRange.first * sizeof(ObjectData);
+        const VkBufferCopy region = {offset, offset, (objectRange.last - objectRange.first) * sizeof(ObjectData)};
+        vkCmdCopyBuffer(commandBuffer, frame.objectStaging.buffer, objectBuffer.buffer, 1, &region);
+    }
+    if (meshRange.first < meshRange.last)
+    {
+        const VkDeviceSize offset = meshRange.first * sizeof(MeshData);
+        const VkBufferCopy region = {offset, offset, (meshRange.last - meshRange.first) * sizeof(MeshData)};
+        vkCmdCopyBuffer(commandBuffer, frame.meshStaging.buffer, meshBuffer.buffer, 1, &region);
+    }
+}
+
+void GpuScene::cull(VkCommandBuffer commandBuffer, VkBuffer draws, const FrameData& frame, uint32_t objectCount,
+                    const float* cameraViewProjection)
+{
+    // Without the pipeline nothing is counted, so nothing is drawn either
+    const VkPipeline pipeline = renderer->getPipelineCompiler().get(cullPipeline);
+    if (pipeline == VK_NULL_HANDLE)
+        return;
+
+    // The draw buffer is a transient, its handle is only known now
+    const VkDescriptorSet descriptorSet = vkCmdPushDescriptorSetKHR
+                                              ? VK_NULL_HANDLE
+                                              : renderer->getFrameDescriptors().allocate(cullSetLayout);
+    const VkDescriptorBufferInfo bufferInfos[] = {
+        {objectBuffer.buffer, 0, VK_WHOLE_SIZE},
+        {meshBuffer.buffer, 0, VK_WHOLE_SIZE},
+        {draws, 0, VK_WHOLE_SIZE},
+        {frame.buckets.buffer, 0, VK_WHOLE_SIZE},
+    };
+    VkWriteDescriptorSet writes[4] = {};
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[i].dstSet = descriptorSet;
+        writes[i].dstBinding = i;
+        writes[i].descriptorCount = 1;
+        writes[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        writes[i].pBufferInfo = &bufferInfos[i];
+    }
+
+    CullConstants constants = {};
+    getFrustumPlanes(cameraViewProjection, constants.planes);
+    constants.objectCount = objectCount;
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+    if (vkCmdPushDescriptorSetKHR)
+    {
+        vkCmdPushDescriptorSetKHR(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, cullLayout, 0, 4, writes);
+    }
+    else
+    {
+        vkUpdateDescriptorSets(device, 4, writes, 0, nullptr);
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, cullLayout, 0, 1, &descriptorSet, 0,
+                                nullptr);
+    }
+    vkCmdPushConstants(commandBuffer, cullLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(constants), &constants);
+    vkCmdDispatch(commandBuffer, (objectCount + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE, 1, 1);
+}
+
+void GpuScene::draw(VkCommandBuffer commandBuffer, VkBuffer draws, const FrameData& frame, VkImageView colorView,
+                    VkImageView depthView, const BucketData& ranges, const float* cameraViewProjection)
+{
+    const VkExtent2D extent = renderer->getRenderExtent();
+    renderer->beginRendering(commandBuffer, colorView, depthView);
+
+    const VkViewport viewport = {0.0f, 0.0f, static_cast<float>(extent.width), static_cast<float>(extent.height),
+                                 0.0f, 1.0f};
+    const VkRect2D scissor = {{0, 0}, extent};
+    vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+    vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+    const VkDeviceSize vertexOffset = 0;
+    vkCmdBindVertexBuffers(commandBuffer, 0, 1, &vertexBuffer.buffer, &vertexOffset);
+    vkCmdBindIndexBuffer(commandBuffer, indexBuffer.buffer, 0, VK_INDEX_TYPE_UINT32);
+
+    for (uint32_t m = 0; m < materials.size(); m++)
+    {
+        const Material& material = materials[m];
+        const VkPipeline pipeline = renderer->getPipelineCompiler().get(material.pipeline);
+        if (ranges.counts[m] == 0 || pipeline == VK_NULL_HANDLE)
+            continue;
+        DescriptorResource objectResource = {};
+        objectResource.binding = 0;
+        objectResource.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        objectResource.buffer = {objectBuffer.buffer, 0, VK_WHOLE_SIZE};
+        const VkDescriptorSet descriptorSet = renderer->getDescriptorCache().getSet(material.setLayout,
+                                                                                    &objectResource, 1);
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, material.layout, 0, 1,
+                                &descriptorSet, 0, nullptr);
+        vkCmdPushConstants(commandBuffer, material.layout, VK_SHADER_STAGE_VERTEX_BIT, 0, 16 * sizeof(float),
+                           cameraViewProjection);
+        vkCmdDrawIndexedIndirectCount(commandBuffer, draws,
+                                      ranges.offsets[m] * sizeof(VkDrawIndexedIndirectCommand), frame.buckets.buffer,
+                                      offsetof(BucketData, counts) + m * sizeof(uint32_t), ranges.counts[m],
+                                      sizeof(VkDrawIndexedIndirectCommand));
+    }
+    vkCmdEndRendering(commandBuffer);
+}
@@ -0,0 +1,193 @@
+//
+// Created by Batur on 18/10/2026.
+//
+
+#ifndef GPUSCENE_H
+#define GPUSCENE_H
+
+#include <string>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+#include "DeviceSelector.h"
+#include "MemoryAllocator.h"
+#include "PipelineCompiler.h"
+
+class VulkanRenderer;
+
+using MeshHandle = uint32_t;
+// Index of the object on the GPU, recycled after removeObject()
+using ObjectHandle = uint32_t;
+// Index of the material's draw bucket
+using MaterialHandle = uint32_t;
+
+// GPU driven rendering of many objects.
+// Meshes share one vertex and one index buffer, objects live in a storage buffer. Every frame a compute pass culls
+// the objects against the camera frustum and writes one indexed indirect command per visible object into its
+// material's range of the draw buffer, counting them per material. Drawing is then a single
+// vkCmdDrawIndexedIndirectCount per material, whatever the number of objects.
+// Changes are written to a staging buffer of the frame slot and copied by the frame itself, the CPU never touches
+// what a frame in flight reads. Material shaders follow shaders/scene.vert: the objects at set 0 binding 0, the
+// view projection as push constant, gl_InstanceIndex as object index. Not thread safe.
+class GpuScene
+{
+public:
+    static constexpr uint32_t MAX_MATERIALS = 64;
+
+    struct Vertex
+    {
+        float position[3];
+        float normal[3];
+    };
+
+    struct Statistics
+    {
+        uint32_t meshCount;
+        uint32_t objectCount;
+        uint32_t materialCount;
+        // Objects that passed culling, read back from the last frame of the slot
+        uint32_t visibleCount;
+        // Bytes copied to the GPU by the last frame
+        VkDeviceSize uploadedBytes;
+    };
+
+    // Adds the indirect drawing features the draw pass relies on, and push descriptors for culling if available.
+    // Left to the application, they must be in the requirements given to createDevice() before init().
+    static void addRequirements(DeviceRequirements& requirements);
+
+    void init(VulkanRenderer& renderer, uint32_t maxObjects, uint32_t maxMeshes, uint32_t maxVertices,
+              uint32_t maxIndices);
+    void destroy();
+
+    // Meshes need at least one vertex and one index
+    MeshHandle addMesh(const Vertex* vertices, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount);
+    // Material 0 is shaders/scene.vert and shaders/scene.frag
+    MaterialHandle addMaterial(const std::string& vertexShader, const std::string& fragmentShader);
+    // Column major transform, color is linear RGBA
+    ObjectHandle addObject(MeshHandle mesh, MaterialHandle material, const float transform[16],
+                           const float color[4]);
+    void setTransform(ObjectHandle object, const float transform[16]);
+    void removeObject(ObjectHandle object);
+
+    // Column major, clip space as Vulkan expects it
+    void setCamera(const float viewProjection[16]);
+    // Adds the upload, cull and draw passes to the frame's render graph, between beginFrame() and endFrame()
+    void render();
+    Statistics getStatistics() const;
+
+private:
+    struct ObjectData
+    {
+        float transform[16];
+        float color[4];
+        uint32_t mesh;
+        uint32_t bucket;
+        float radiusScale;
+        uint32_t enabled;
+    };
+
+    struct MeshData
+    {
+        float sphere[4];
+        uint32_t indexCount;
+        uint32_t firstIndex;
+        int32_t vertexOffset;
+        uint32_t padding;
+    };
+
+    // Draw counts written by the cull pass, and where each material's commands start
+    struct BucketData
+    {
+        uint32_t counts[MAX_MATERIALS];
+        uint32_t offsets[MAX_MATERIALS];
+    };
+
+    struct Material
+    {
+        std::string vertexShader;
+        std::string fragmentShader;
+        VkPipelineLayout layout;
+        VkDescriptorSetLayout setLayout;
+        PipelineHandle pipeline;
+        uint32_t objectCount;
+    };
+
+    // Everything a frame slot writes from the host
+    struct FrameData
+    {
+        MemoryAllocator::Buffer objectStaging;
+        MemoryAllocator::Buffer meshStaging;
+        MemoryAllocator::Buffer buckets;
+    };
+
+    // Geometry staged by addMesh(), copied by the next frame and freed once it completed
+    struct GeometryUpload
+    {
+        MemoryAllocator::Buffer staging;
+        VkDeviceSize vertexOffset;
+        VkDeviceSize vertexSize;
+        VkDeviceSize indexOffset;
+        VkDeviceSize indexSize;
+        uint64_t frameNumber;
+    };
+
+    // Element range changed since the last upload, empty when first >= last
+    struct DirtyRange
+    {
+        uint32_t first = UINT32_MAX;
+        uint32_t last = 0;
+
+        void add(uint32_t index);
+    };
+
+    VulkanRenderer* renderer = nullptr;
+    VkDevice device = VK_NULL_HANDLE;
+    const VkAllocationCallbacks* allocator = nullptr;
+    VkFormat depthFormat = VK_FORMAT_UNDEFINED;
+
+    uint32_t maxObjects = 0;
+    uint32_t maxMeshes = 0;
+    uint32_t maxVertices = 0;
+    uint32_t maxIndices = 0;
+    uint32_t vertexCount = 0;
+    uint32_t indexCount = 0;
+
+    MemoryAllocator::Buffer vertexBuffer;
+    MemoryAllocator::Buffer indexBuffer;
+    MemoryAllocator::Buffer objectBuffer;
+    MemoryAllocator::Buffer meshBuffer;
+    std::vector<FrameData> frames;
+
+    // Host copies of the GPU tables
+    std::vector<ObjectData> objects;
+    std::vector<MeshData> meshes;
+    std::vector<ObjectHandle> freeObjects;
+    DirtyRange dirtyObjects;
+    DirtyRange dirtyMeshes;
+    std::vector<GeometryUpload> geometryUploads;
+
+    std::vector<Material> materials;
+    VkPipelineLayout cullLayout = VK_NULL_HANDLE;
+    VkDescriptorSetLayout cullSetLayout = VK_NULL_HANDLE;
+    // Set when VK_KHR_push_descriptor is enabled, the cull buffers are pushed instead of written to a frame set
+    PFN_vkCmdPushDescriptorSetKHR vkCmdPushDescriptorSetKHR = nullptr;
+    PipelineHandle cullPipeline = 0;
+    uint32_t reloadListener = 0;
+    uint32_t formatListener = 0;
+
+    float viewProjection[16] = {};
+    Statistics statistics = {};
+
+    void requestCullPipeline();
+    void requestMaterialPipeline(Material& material);
+    void uploadTables(VkCommandBuffer commandBuffer, const FrameData& frame,
+                      const std::vector<GeometryUpload>& geometry, const DirtyRange& objectRange,
+                      const DirtyRange& meshRange);
+    void cull(VkCommandBuffer commandBuffer, VkBuffer draws, const FrameData& frame, uint32_t objectCount,
+              const float* cameraViewProjection);
+    // Ranges holds the largest draw count and the first command of every material
+    void draw(VkCommandBuffer commandBuffer, VkBuffer draws, const FrameData& frame, VkImageView colorView,
+              VkImageView depthView, const BucketData& ranges, const float* cameraViewProjection);
+};
+
+#endif //GPUSCENE_H
@@ -0,0 +1,94 @@
+//
+// Created by Batur on 18/10/2026.
+//
+
+#include "GpuTimeline.h"
+
+#include <stdexcept>
+
+void GpuTimeline::init(VkDevice deviceHandle, const VkAllocationCallbacks* allocationCallbacks)
+{
+    device = deviceHandle;
+    allocator = allocationCallbacks;
+
+    VkSemaphoreTypeCreateInfo typeInfo = {};
+    typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+    typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+    typeInfo.initialValue = 0;
+    VkSemaphoreCreateInfo semaphoreInfo = {};
+    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    semaphoreInfo.pNext = &typeInfo;
+    if (vkCreateSemaphore(device, &semaphoreInfo, allocator, &semaphore) != VK_SUCCESS)
+    {
+        throw std::runtime_error("[Vulkan] Failed to create timeline semaphore!");
+    }
+    submittedValue = 0;
+    completedValue = 0;
+}
+
+void GpuTimeline::destroy()
+{
+    if (semaphore != VK_NULL_HANDLE)
+    {
+        vkDestroySemaphore(device, semaphore, allocator);
+        semaphore = VK_NULL_HANDLE;
+    }
+}
+
+VkSemaphore GpuTimeline::getSemaphore() const
+{
+    return semaphore;
+}
+
+uint64_t GpuTimeline::advance()
+{
+    return ++submittedValue;
+}
+
+uint64_t GpuTimeline::getSubmittedValue() const
+{
+    return submittedValue;
+}
+
+uint64_t GpuTimeline::getCompletedValue()
+{
+    uint64_t value = 0;
+    if (vkGetSemaphoreCounterValue(device, semaphore, &value) == VK_SUCCESS)
+    {
+        uint64_t known = completedValue;
+        while (value > known && !completedValue.compare_exchange_weak(known, value))
+        {
+        }
+    }
+    return completedValue;
+}
+
+bool GpuTimeline::isComplete(uint64_t value)
+{
+    return value <= completedValue || value <= getCompletedValue();
+}
+
+bool GpuTimeline::waitFor(uint64_t value, uint64_t timeout)
+{
+    if (value <= completedValue)
+        return true;
+
+    VkSemaphoreWaitInfo waitInfo = {};
+    waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+    waitInfo.semaphoreCount = 1;
+    waitInfo.pSemaphores = &semaphore;
+    waitInfo.pValues = &value;
+    const VkResult err = vkWaitSemaphores(device, &waitInfo, timeout);
+    if (err == VK_TIMEOUT)
+        return false;
+    if (err != VK_SUCCESS)
+    {
+        throw std::runtime_error("[Vulkan] Failed to wait on timeline semaphore!");
+    }
+
+    uint64_t known = completedValue;
+    while (value > known && !completedValue.compare_exchange_weak(known, value))
+    {
+    }
+    return true;
+}
@@ -0,0 +1,58 @@
+//
+// Created by Batur on 18/10/2026.
+//
+
+#ifndef GPUTIMELINE_H
+#define GPUTIMELINE_H
+
+#include <atomic>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+#include "QueueFamilies.h"
+
+// Monotonic GPU progress counter of one queue, backed by a timeline semaphore.
+// Every submission signals the next value, so "is this work done" is a single integer compare
+// and no fence has to be reset or recycled.
+class GpuTimeline
+{
+public:
+    void init(VkDevice device, const VkAllocationCallbacks* allocator);
+    void destroy();
+
+    VkSemaphore getSemaphore() const;
+    // Reserves the value the next submission signals, callers serialize this with the submission itself
+    uint64_t advance();
+    uint64_t getSubmittedValue() const;
+    uint64_t getCompletedValue();
+    bool isComplete(uint64_t value);
+    // Blocks the calling thread until the GPU reached `value`, returns false on timeout
+    bool waitFor(uint64_t value, uint64_t timeout = UINT64_MAX);
+
+private:
+    VkDevice device = VK_NULL_HANDLE;
+    const VkAllocationCallbacks* allocator = nullptr;
+    VkSemaphore semaphore = VK_NULL_HANDLE;
+    std::atomic<uint64_t> submittedValue{ 0 };
+    std::atomic<uint64_t> completedValue{ 0 };
+};
+
+// Dependency on a point of another (or the same) queue timeline
+struct TimelineWait
+{
+    QueueType queue;
+    uint64_t value;
+    VkPipelineStageFlags stage;
+};
+
+struct QueueSubmission
+{
+    std::vector<VkCommandBuffer> commandBuffers;
+    std::vector<TimelineWait> waits;
+    // Binary semaphores are still needed around the swapchain
+    VkSemaphore binaryWait = VK_NULL_HANDLE;
+    VkPipelineStageFlags binaryWaitStage = 0;
+    VkSemaphore binarySignal = VK_NULL_HANDLE;
+};
+
+#endif //GPUTIMELINE_H
@@ -0,0 +1,401 @@
+//
+// Created by Batur on 18/10/2026.
+//
+
+#include "HostAllocator.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+
+#include "DebugConfig.h"
+
+namespace
+{
+    std::atomic<uint64_t> nextAllocatorId{ 1 };
+
+    uintptr_t alignUp(uintptr_t value, size_t alignment)
+    {
+        return (value + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+    }
+}
+
+HostAllocator::HostAllocator()
+{
+    id = nextAllocatorId.fetch_add(1);
+    callbacks.pUserData = this;
+    callbacks.pfnAllocation = vkAllocation;
+    callbacks.pfnReallocation = vkReallocation;
+    callbacks.pfnFree = vkFree;
+    callbacks.pfnInternalAllocation = vkInternalAllocation;
+    callbacks.pfnInternalFree = vkInternalFree;
+}
+
+HostAllocator::~HostAllocator()
+{
+    for (SizeClass& sizeClass : sizeClasses)
+        for (void* slab : sizeClass.slabs)
+            std::free(slab);
+    for (ThreadCache* cache : threadCaches)
+    {
+        for (char* block : cache->blocks)
+            std::free(block);
+        delete cache;
+    }
+}
+
+VkAllocationCallbacks* HostAllocator::getCallbacks()
+{
+    return &callbacks;
+}
+
+HostAllocator::Statistics HostAllocator::getStatistics(VkSystemAllocationScope scope) const
+{
+    return scopeCounters[scope].snapshot();
+}
+
+HostAllocator::Statistics HostAllocator::getInternalStatistics() const
+{
+    return internalCounters.snapshot();
+}
+
+void HostAllocator::logStatistics() const
+{
+    for (size_t scope = 0; scope < SCOPE_COUNT; scope++)
+    {
+        const Statistics stats = scopeCounters[scope].snapshot();
+        DebugConfig::verbose("[Vulkan] Host memory %-8s: %llu bytes live in %llu allocations, peak %llu bytes, "
+                             "%llu allocations total", getScopeName(scope),
+                             static_cast<unsigned long long>(stats.bytes),
+                             static_cast<unsigned long long>(stats.allocations),
+                             static_cast<unsigned long long>(stats.peakBytes),
+                             static_cast<unsigned long long>(stats.totalAllocations));
+    }
+    const Statistics internal = internalCounters.snapshot();
+    DebugConfig::verbose("[Vulkan] Host memory internal: %llu bytes live, peak %llu bytes",
+                         static_cast<unsigned long long>(internal.bytes),
+                         static_cast<unsigned long long>(internal.peakBytes));
+}
+
+void* HostAllocator::allocate(size_t size, size_t alignment, VkSystemAllocationScope scope)
+{
+    if (size == 0)
+        return nullptr;
+    if (alignment < MIN_ALIGNMENT)
+        alignment = MIN_ALIGNMENT;
+
+    void* memory;
+    uint16_t source;
+    const size_t sizeClass = getSizeClass(size);
+    if (alignment == MIN_ALIGNMENT && sizeClass < SIZE_CLASS_COUNT)
+    {
+        memory = allocatePool(sizeClass);
+        source = static_cast<uint16_t>(SOURCE_POOL + sizeClass);
+    }
+    else if (scope == VK_SYSTEM_ALLOCATION_SCOPE_COMMAND && size + alignment <= ARENA_BLOCK_SIZE / 2)
+    {
+        memory = allocateArena(size, alignment);
+        source = SOURCE_ARENA;
+    }
+    else
+    {
+        memory = allocateSystem(size, alignment);
+        source = SOURCE_SYSTEM;
+    }
+    if (!memory)
+        return nullptr;
+
+    Header* header = getHeader(memory);
+    header->size = size;
+    header->source = source;
+    header->scope = static_cast<uint16_t>(scope);
+    scopeCounters[scope].add(size);
+    return memory;
+}
+
+void* HostAllocator::reallocate(void* original, size_t size, size_t alignment, VkSystemAllocationScope scope)
+{
+    if (!original)
+        return allocate(size, alignment, scope);
+    if (size == 0)
+    {
+        free(original);
+        return nullptr;
+    }
+
+    Header* header = getHeader(original);
+    if (header->source >= SOURCE_POOL && size <= getSizeClassBytes(header->source - SOURCE_POOL))
+    {
+        // Still fits the chunk, only the accounting changes
+        scopeCounters[header->scope].remove(header->size);
+        header->size = size;
+        header->scope = static_cast<uint16_t>(scope);
+        scopeCounters[scope].add(size);
+        return original;
+    }
+
+    void* memory = allocate(size, alignment, scope);
+    if (!memory)
+        return nullptr;
+    std::memcpy(memory, original, size < header->size ? size : header->size);
+    free(original);
+    return memory;
+}
+
+void HostAllocator::free(void* memory)
+{
+    if (!memory)
+        return;
+
+    Header* header = getHeader(memory);
+    scopeCounters[header->scope].remove(header->size);
+    if (header->source >= SOURCE_POOL)
+        freePool(header);
+    else if (header->source == SOURCE_ARENA)
+        freeArena(header);
+    else
+        freeSystem(header);
+}
+
+HostAllocator::ThreadCache& HostAllocator::getThreadCache()
+{
+    thread_local std::vector<std::pair<uint64_t, ThreadCache*>> caches;
+    for (const std::pair<uint64_t, ThreadCache*>& cache : caches)
+        if (cache.first == id)
+            return *cache.second;
+
+    ThreadCache* cache = new ThreadCache();
+    {
+        std::lock_guard<std::mutex> lock(threadMutex);
+        threadCaches.push_back(cache);
+    }
+    caches.emplace_back(id, cache);
+    return *cache;
+}
+
+void* HostAllocator::allocatePool(size_t sizeClass)
+{
+    ThreadCache& cache = getThreadCache();
+    if (!cache.freeLists[sizeClass] && !refillCache(cache, sizeClass))
+        return nullptr;
+
+    void* chunk = cache.freeLists[sizeClass];
+    cache.freeLists[sizeClass] = *static_cast<void**>(chunk);
+    cache.freeCounts[sizeClass]--;
+    return static_cast<char*>(chunk) + sizeof(Header);
+}
+
+void HostAllocator::freePool(Header* header)
+{
+    // Chunks of a class are interchangeable, one freed by another thread than its allocating one joins its cache
+    const size_t sizeClass = header->source - SOURCE_POOL;
+    ThreadCache& cache = getThreadCache();
+    *reinterpret_cast<void**>(header) = cache.freeLists[sizeClass];
+    cache.freeLists[sizeClass] = header;
+    if (++cache.freeCounts[sizeClass] > 2 * CACHE_BATCH)
+        flushCache(cache, sizeClass, CACHE_BATCH);
+}
+
+bool HostAllocator::refillCache(ThreadCache& cache, size_t sizeClass)
+{
+    SizeClass& pool = sizeClasses[sizeClass];
+    std::lock_guard<std::mutex> lock(pool.mutex);
+    if (!pool.freeList)
+    {
+        // malloc alignment is at least 16 bytes, and every chunk stride is a multiple of 16
+        char* slab = static_cast<char*>(std::malloc(SLAB_SIZE));
+        if (!slab)
+            return false;
+        pool.slabs.push_back(slab);
+
+        const size_t stride = sizeof(Header) + getSizeClassBytes(sizeClass);
+        for (size_t offset = 0; offset + stride <= SLAB_SIZE; offset += stride)
+        {
+            void* chunk = slab + offset;
+            *static_cast<void**>(chunk) = pool.freeList;
+            pool.freeList = chunk;
+        }
+    }
+
+    for (size_t i = 0; i < CACHE_BATCH && pool.freeList; i++)
+    {
+        void* chunk = pool.freeList;
+        pool.freeList = *static_cast<void**>(chunk);
+        *static_cast<void**>(chunk) = cache.freeLists[sizeClass];
+        cache.freeLists[sizeClass] = chunk;
+        cache.freeCounts[sizeClass]++;
+    }
+    return true;
+}
+
+void HostAllocator::flushCache(ThreadCache& cache, size_t sizeClass, size_t count)
+{
+    SizeClass& pool = sizeClasses[sizeClass];
+    std::lock_guard<std::mutex> lock(pool.mutex);
+    for (size_t i = 0; i < count && cache.freeLists[sizeClass]; i++)
+    {
+        void* chunk = cache.freeLists[sizeClass];
+        cache.freeLists[sizeClass] = *static_cast<void**>(chunk);
+        cache.freeCounts[sizeClass]--;
+        *static_cast<void**>(chunk) = pool.freeList;
+        pool.freeList = chunk;
+    }
+}
+
+void* HostAllocator::allocateArena(size_t size, size_t alignment)
+{
+    // Only this thread moves its arena. Command scoped memory dies with the command, so once every allocation
+    // was freed, from whichever thread, nothing in the blocks is live and the arena starts over.
+    ThreadCache& cache = getThreadCache();
+    if (cache.live.load(std::memory_order_acquire) == 0)
+    {
+        cache.block = 0;
+        cache.offset = MIN_ALIGNMENT;
+    }
+
+    for (;;)
+    {
+        if (cache.block == cache.blocks.size())
+        {
+            char* block = static_cast<char*>(std::malloc(ARENA_BLOCK_SIZE));
+            if (!block)
+                return nullptr;
+            *reinterpret_cast<ThreadCache**>(block) = &cache;
+            cache.blocks.push_back(block);
+        }
+
+        const uintptr_t base = reinterpret_cast<uintptr_t>(cache.blocks[cache.block]);
+        const uintptr_t memory = alignUp(base + cache.offset + sizeof(Header), alignment);
+        if (memory + size <= base + ARENA_BLOCK_SIZE)
+        {
+            cache.offset = static_cast<size_t>(memory + size - base);
+            cache.live.fetch_add(1, std::memory_order_relaxed);
+            getHeader(reinterpret_cast<void*>(memory))->offset = static_cast<uint32_t>(memory - base);
+            return reinterpret_cast<void*>(memory);
+        }
+
+        cache.block++;
+        cache.offset = MIN_ALIGNMENT;
+    }
+}
+
+void HostAllocator::freeArena(Header* header)
+{
+    // The owning thread rewinds the arena on its next allocation after the count reached zero
+    char* memory = reinterpret_cast<char*>(header) + sizeof(Header);
+    ThreadCache* cache = *reinterpret_cast<ThreadCache**>(memory - header->offset);
+    cache->live.fetch_sub(1, std::memory_order_release);
+}
+
+void* HostAllocator::allocateSystem(size_t size, size_t alignment)
+{
+    char* block = static_cast<char*>(std::malloc(size + alignment + sizeof(Header)));
+    if (!block)
+        return nullptr;
+
+    const uintptr_t memory = alignUp(reinterpret_cast<uintptr_t>(block) + sizeof(Header), alignment);
+    getHeader(reinterpret_cast<void*>(memory))->offset =
+        static_cast<uint32_t>(memory - reinterpret_cast<uintptr_t>(block));
+    return reinterpret_cast<void*>(memory);
+}
+
+void HostAllocator::freeSystem(Header* header)
+{
+    char* memory = reinterpret_cast<char*>(header) + sizeof(Header);
+    std::free(memory - header->offset);
+}
+
+size_t HostAllocator::getSizeClass(size_t size)
+{
+    size_t sizeClass = 0;
+    while (sizeClass < SIZE_CLASS_COUNT && getSizeClassBytes(sizeClass) < size)
+        sizeClass++;
+    return sizeClass;
+}
+
+size_t HostAllocator::getSizeClassBytes(size_t sizeClass)
+{
+    return MIN_ALIGNMENT << sizeClass;
+}
+
+HostAllocator::Header* HostAllocator::getHeader(void* memory)
+{
+    return reinterpret_cast<Header*>(static_cast<char*>(memory) - sizeof(Header));
+}
+
+const char* HostAllocator::getScopeName(size_t scope)
+{
+    switch (scope)
+    {
+    case VK_SYSTEM_ALLOCATION_SCOPE_COMMAND:
+        return "command";
+    case VK_SYSTEM_ALLOCATION_SCOPE_OBJECT:
+        return "object";
+    case VK_SYSTEM_ALLOCATION_SCOPE_CACHE:
+        return "cache";
+    case VK_SYSTEM_ALLOCATION_SCOPE_DEVICE:
+        return "device";
+    case VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE:
+        return "instance";
+    default:
+        return "unknown";
+    }
+}
+
+void HostAllocator::Counters::add(uint64_t size)
+{
+    const uint64_t current = bytes.fetch_add(size) + size;
+    allocations.fetch_add(1);
+    totalAllocations.fetch_add(1);
+
+    uint64_t peak = peakBytes.load();
+    while (current > peak && !peakBytes.compare_exchange_weak(peak, current))
+    {
+    }
+}
+
+void HostAllocator::Counters::remove(uint64_t size)
+{
+    bytes.fetch_sub(size);
+    allocations.fetch_sub(1);
+}
+
+HostAllocator::Statistics HostAllocator::Counters::snapshot() const
+{
+    Statistics stats = {};
+    stats.bytes = bytes.load();
+    stats.peakBytes = peakBytes.load();
+    stats.allocations = allocations.load();
+    stats.totalAllocations = totalAllocations.load();
+    return stats;
+}
+
+VKAPI_ATTR void* VKAPI_CALL HostAllocator::vkAllocation(void* userData, size_t size, size_t alignment,
+                                                        VkSystemAllocationScope scope)
+{
+    return static_cast<HostAllocator*>(userData)->allocate(size, alignment, scope);
+}
+
+VKAPI_ATTR void* VKAPI_CALL HostAllocator::vkReallocation(void* userData, void* original, size_t size,
+                                                          size_t alignment, VkSystemAllocationScope scope)
+{
+    return static_cast<HostAllocator*>(userData)->reallocate(original, size, alignment, scope);
+}
+
+VKAPI_ATTR void VKAPI_CALL HostAllocator::vkFree(void* userData, void* memory)
+{
+    static_cast<HostAllocator*>(userData)->free(memory);
+}
+
+VKAPI_ATTR void VKAPI_CALL HostAllocator::vkInternalAllocation(void* userData, size_t size,
+                                                               VkInternalAllocationType type,
+                                                               VkSystemAllocationScope scope)
+{
+    static_cast<HostAllocator*>(userData)->internalCounters.add(size);
+}
+
+VKAPI_ATTR void VKAPI_CALL HostAllocator::vkInternalFree(void* userData, size_t size, VkInternalAllocationType type,
+                                                         VkSystemAllocationScope scope)
+{
+    static_cast<HostAllocator*>(userData)->internalCounters.remove(size);
+}
@@ -0,0 +1,138 @@
+//
+// Created by Batur on 18/10/2026.
+//
+
+#ifndef HOSTALLOCATOR_H
+#define HOSTALLOCATOR_H
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+// Host memory handed to the Vulkan driver through VkAllocationCallbacks.
+// Small allocations come from per-thread free lists, refilled from and flushed to shared size-class pools in
+// batches, so the pool locks are taken once per batch. Command scoped allocations come from a linear arena per
+// thread that its thread rewinds once everything in it was freed, and everything else falls back to malloc.
+// Thread caches live as long as the allocator. Every allocation is tracked per VkSystemAllocationScope.
+class HostAllocator
+{
+public:
+    struct Statistics
+    {
+        uint64_t bytes;
+        uint64_t peakBytes;
+        uint64_t allocations;
+        uint64_t totalAllocations;
+    };
+
+    HostAllocator();
+    ~HostAllocator();
+
+    HostAllocator(const HostAllocator&) = delete;
+    HostAllocator& operator=(const HostAllocator&) = delete;
+
+    VkAllocationCallbacks* getCallbacks();
+    Statistics getStatistics(VkSystemAllocationScope scope) const;
+    Statistics getInternalStatistics() const;
+    void logStatistics() const;
+
+private:
+    static constexpr size_t SCOPE_COUNT = VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE + 1;
+    static constexpr size_t MIN_ALIGNMENT = 16;
+    static constexpr size_t SIZE_CLASS_COUNT = 8; // 16 bytes .. 2 KiB
+    static constexpr size_t SLAB_SIZE = 64 * 1024;
+    // Chunks moved between a thread cache and its pool at once, a cache holds at most twice that per class
+    static constexpr size_t CACHE_BATCH = 32;
+    static constexpr size_t ARENA_BLOCK_SIZE = 256 * 1024;
+
+    enum Source : uint16_t
+    {
+        SOURCE_SYSTEM = 0,
+        SOURCE_ARENA = 1,
+        SOURCE_POOL = 2 // + size class index
+    };
+
+    // Stored in the 16 bytes right before every pointer returned to the driver
+    struct Header
+    {
+        uint64_t size;
+        uint16_t source;
+        uint16_t scope;
+        uint32_t offset; // From the start of the system or arena block
+    };
+    static_assert(sizeof(Header) == MIN_ALIGNMENT, "Header must keep the payload 16 byte aligned");
+
+    struct Counters
+    {
+        std::atomic<uint64_t> bytes{ 0 };
+        std::atomic<uint64_t> peakBytes{ 0 };
+        std::atomic<uint64_t> allocations{ 0 };
+        std::atomic<uint64_t> totalAllocations{ 0 };
+
+        void add(uint64_t size);
+        void remove(uint64_t size);
+        Statistics snapshot() const;
+    };
+
+    struct SizeClass
+    {
+        std::mutex mutex;
+        void* freeList = nullptr;
+        std::vector<void*> slabs;
+    };
+
+    // Only touched by its thread, except for `live` which any thread freeing arena memory counts down
+    struct ThreadCache
+    {
+        void* freeLists[SIZE_CLASS_COUNT] = {};
+        size_t freeCounts[SIZE_CLASS_COUNT] = {};
+        // Every arena block starts with a pointer back to its cache
+        std::vector<char*> blocks;
+        size_t block = 0;
+        size_t offset = 0;
+        std::atomic<size_t> live{ 0 };
+    };
+
+    VkAllocationCallbacks callbacks = {};
+    // Thread caches are looked up by it, a new allocator at a destroyed one's address never sees its caches
+    uint64_t id = 0;
+    SizeClass sizeClasses[SIZE_CLASS_COUNT];
+    std::mutex threadMutex;
+    std::vector<ThreadCache*> threadCaches;
+    Counters scopeCounters[SCOPE_COUNT];
+    Counters internalCounters;
+
+    void* allocate(size_t size, size_t alignment, VkSystemAllocationScope scope);
+    void* reallocate(void* original, size_t size, size_t alignment, VkSystemAllocationScope scope);
+    void free(void* memory);
+
+    ThreadCache& getThreadCache();
+    void* allocatePool(size_t sizeClass);
+    void freePool(Header* header);
+    // Moves up to CACHE_BATCH chunks from the pool to the cache, false when none could be had
+    bool refillCache(ThreadCache& cache, size_t sizeClass);
+    void flushCache(ThreadCache& cache, size_t sizeClass, size_t count);
+    void* allocateArena(size_t size, size_t alignment);
+    void freeArena(Header* header);
+    void* allocateSystem(size_t size, size_t alignment);
+    void freeSystem(Header* header);
+
+    static size_t getSizeClass(size_t size);
+    static size_t getSizeClassBytes(size_t sizeClass);
+    static Header* getHeader(void* memory);
+    static const char* getScopeName(size_t scope);
+
+    static VKAPI_ATTR void* VKAPI_CALL vkAllocation(void* userData, size_t size, size_t alignment,
+                                                    VkSystemAllocationScope scope);
+    static VKAPI_ATTR void* VKAPI_CALL vkReallocation(void* userData, void* original, size_t size, size_t alignment,
+                                                      VkSystemAllocationScope scope);
+    static VKAPI_ATTR void VKAPI_CALL vkFree(void* userData, void* memory);
+    static VKAPI_ATTR void VKAPI_CALL vkInternalAllocation(void* userData, size_t size,
+                                                           VkInternalAllocationType type,
+                                                           VkSystemAllocationScope scope);
+    static VKAPI_ATTR void VKAPI_CALL vkInternalFree(void* userData, size_t size, VkInternalAllocationType type,
+                                                     VkSystemAllocationScope scope);
+};
+
+#endif //HOSTALLOCATOR_H
@@ -0,0 +1,494 @@
+//
+// Created by Batur on 18/10/2026.
+//
+
+#include "ImGuiRenderer.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <backends/imgui_impl_sdl3.h>
+
+#include "DebugConfig.h"
+#include "VulkanRenderer.h"
+
+namespace
+{
+    // Smallest ring size, enough for a few windows of text without growing
+    constexpr VkDeviceSize MIN_BUFFER_SIZE = 64 * 1024;
+
+    VkDeviceSize growCapacity(VkDeviceSize capacity, VkDeviceSize required)
+    {
+        if (capacity < MIN_BUFFER_SIZE)
+            capacity = MIN_BUFFER_SIZE;
+        while (capacity < required)
+            capacity *= 2;
+        return capacity;
+    }
+
+    constexpr const char* VERTEX_SHADER = "imgui.vert.spv";
+    constexpr const char* FRAGMENT_SHADER = "imgui.frag.spv";
+
+    struct PushConstants
+    {
+        float scale[2];
+        float translate[2];
+    };
+}
+
+void ImGuiRenderer::init(VulkanRenderer& vulkanRenderer, SDL_Window* window)
+{
+    renderer = &vulkanRenderer;
+    device = renderer->getDevice();
+    allocator = renderer->getAllocator();
+
+    IMGUI_CHECKVERSION();
+    ImGui::CreateContext();
+    ImGuiIO& io = ImGui::GetIO();
+    io.BackendRendererName = "solid_vulkan";
+    io.BackendFlags |= ImGuiBackendFlags_RendererHasVtxOffset;
+    if (window)
+    {
+        if (!ImGui_ImplSDL3_InitForVulkan(window))
+        {
+            throw std::runtime_error("[ImGui] Failed to initialize the SDL3 backend!");
+        }
+        platformBackend = true;
+    }
+
+    setupPipeline();
+    frameBuffers.resize(renderer->getFramesInFlight());
+    uploadFonts();
+    // The UI is drawn from the first frame on, only the font upload overlaps the compilation
+    if (renderer->getPipelineCompiler().wait(pipelineHandle) == VK_NULL_HANDLE)
+    {
+        throw std::runtime_error("[ImGui] Failed to create graphics pipeline!");
+    }
+    DebugConfig::verbose("[ImGui] Renderer initialized");
+}
+
+void ImGuiRenderer::destroy()
+{
+    if (!renderer)
+        return;
+    vkDeviceWaitIdle(device);
+
+    // Descriptor sets belong to the renderer's descriptor cache, the ones of views still registered go too
+    for (const TextureKey& texture : textures)
+        releasedViews.push_back({texture.imageView, 0});
+    invalidateReleasedViews(true);
+    textures.clear();
+    freeTextures.clear();
+    textureIds.clear();
+
+    for (FrameBuffers& buffers : frameBuffers)
+    {
+        if (buffers.vertexBuffer.buffer != VK_NULL_HANDLE)
+            renderer->destroyBuffer(buffers.vertexBuffer);
+        if (buffers.indexBuffer.buffer != VK_NULL_HANDLE)
+            renderer->destroyBuffer(buffers.indexBuffer);
+    }
+    frameBuffers.clear();
+
+    if (fontView != VK_NULL_HANDLE)
+        vkDestroyImageView(device, fontView, allocator);
+    fontView = VK_NULL_HANDLE;
+    if (fontImage.image != VK_NULL_HANDLE)
+        renderer->destroyImage(fontImage);
+
+    // The pipeline belongs to the renderer's compiler, its layout and shaders to the shader library
+    renderer->getShaderLibrary().removeReloadListener(reloadListener);
+    reloadListener = 0;
+    renderer->removeFormatListener(formatListener);
+    formatListener = 0;
+    vkDestroySampler(device, sampler, allocator);
+    sampler = VK_NULL_HANDLE;
+    pipelineHandle = 0;
+    pipelineLayout = VK_NULL_HANDLE;
+    descriptorSetLayout = VK_NULL_HANDLE;
+
+    if (platformBackend)
+        ImGui_ImplSDL3_Shutdown();
+    platformBackend = false;
+    ImGui::DestroyContext();
+    renderer = nullptr;
+    DebugConfig::verbose("[ImGui] Renderer destroyed");
+}
+
+bool ImGuiRenderer::processEvent(const SDL_Event& event)
+{
+    if (!platformBackend)
+        return false;
+    ImGui_ImplSDL3_ProcessEvent(&event);
+    const ImGuiIO& io = ImGui::GetIO();
+    return io.WantCaptureMouse || io.WantCaptureKeyboard;
+}
+
+void ImGuiRenderer::newFrame()
+{
+    if (platformBackend)
+    {
+        ImGui_ImplSDL3_NewFrame();
+    }
+    else
+    {
+        // Fixed time step keeps headless runs reproducible
+        ImGuiIO& io = ImGui::GetIO();
+        const VkExtent2D extent = renderer->getRenderExtent();
+        io.DisplaySize = ImVec2(static_cast<float>(extent.width), static_cast<float>(extent.height));
+        io.DeltaTime = 1.0f / 60.0f;
+    }
+    ImGui::NewFrame();
+}
+
+void ImGuiRenderer::render()
+{
+    invalidateReleasedViews(false);
+    ImGui::Render();
+    ImDrawData* drawData = ImGui::GetDrawData();
+    const float fbWidth = drawData->DisplaySize.x * drawData->FramebufferScale.x;
+    const float fbHeight = drawData->DisplaySize.y * drawData->FramebufferScale.y;
+    if (fbWidth <= 0.0f || fbHeight <= 0.0f)
+        return;
+
+    FrameBuffers& buffers = frameBuffers[renderer->getFrameIndex()];
+    if (drawData->TotalVtxCount > 0)
+    {
+        const VkDeviceSize vertexSize = drawData->TotalVtxCount * sizeof(ImDrawVert);
+        const VkDeviceSize indexSize = drawData->TotalIdxCount * sizeof(ImDrawIdx);
+        reserveFrameBuffers(buffers, vertexSize, indexSize);
+
+        ImDrawVert* vertices = static_cast<ImDrawVert*>(buffers.vertexBuffer.allocation->mapped);
+        ImDrawIdx* indices = static_cast<ImDrawIdx*>(buffers.indexBuffer.allocation->mapped);
+        for (int n = 0; n < drawData->CmdListsCount; n++)
+        {
+            const ImDrawList* drawList = drawData->CmdLists[n];
+            std::memcpy(vertices, drawList->VtxBuffer.Data, drawList->VtxBuffer.Size * sizeof(ImDrawVert));
+            std::memcpy(indices, drawList->IdxBuffer.Data, drawList->IdxBuffer.Size * sizeof(ImDrawIdx));
+            vertices += drawList->VtxBuffer.Size;
+            indices += drawList->IdxBuffer.Size;
+        }
+        renderer->getMemoryAllocator().flush(buffers.vertexBuffer.allocation, 0, vertexSize);
+        renderer->getMemoryAllocator().flush(buffers.indexBuffer.allocation, 0, indexSize);
+    }
+
+    const RenderGraphResource target = renderer->getBackbuffer();
+    renderer->getRenderGraph().addPass("ImGui", [target](RenderGraph::PassBuilder& builder)
+                                       {
+                                           builder.colorAttachment(target);
+                                       }, [this, drawData, &buffers](VkCommandBuffer commandBuffer)
+                                       {
+                                           recordDrawData(commandBuffer, drawData, buffers);
+                                       });
+}
+
+void ImGuiRenderer::recordDrawData(VkCommandBuffer commandBuffer, ImDrawData* drawData, FrameBuffers& buffers)
+{
+    const float fbWidth = drawData->DisplaySize.x * drawData->FramebufferScale.x;
+    const float fbHeight = drawData->DisplaySize.y * drawData->FramebufferScale.y;
+    renderer->beginRendering();
+    if (drawData->TotalVtxCount > 0)
+    {
+        const VkPipeline pipeline = renderer->getPipelineCompiler().get(pipelineHandle);
+        const auto setupRenderState = [&]()
+        {
+            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+            const VkDeviceSize offset = 0;
+            vkCmdBindVertexBuffers(commandBuffer, 0, 1, &buffers.vertexBuffer.buffer, &offset);
+            vkCmdBindIndexBuffer(commandBuffer, buffers.indexBuffer.buffer, 0,
+                                 sizeof(ImDrawIdx) == 2 ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32);
+
+            VkViewport viewport = {};
+            viewport.width = fbWidth;
+            viewport.height = fbHeight;
+            viewport.maxDepth = 1.0f;
+            vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+
+            PushConstants constants;
+            constants.scale[0] = 2.0f / drawData->DisplaySize.x;
+            constants.scale[1] = 2.0f / drawData->DisplaySize.y;
+            constants.translate[0] = -1.0f - drawData->DisplayPos.x * constants.scale[0];
+            constants.translate[1] = -1.0f - drawData->DisplayPos.y * constants.scale[1];
+            vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(constants),
+                               &constants);
+        };
+        setupRenderState();
+
+        const ImVec2 clipOffset = drawData->DisplayPos;
+        const ImVec2 clipScale = drawData->FramebufferScale;
+        uint32_t boundTexture = 0;
+        uint32_t globalVertexOffset = 0;
+        uint32_t globalIndexOffset = 0;
+        for (int n = 0; n < drawData->CmdListsCount; n++)
+        {
+            const ImDrawList* drawList = drawData->CmdLists[n];
+            for (int i = 0; i < drawList->CmdBuffer.Size; i++)
+            {
+                const ImDrawCmd& drawCmd = drawList->CmdBuffer[i];
+                if (drawCmd.UserCallback)
+                {
+                    if (drawCmd.UserCallback == ImDrawCallback_ResetRenderState)
+                    {
+                        setupRenderState();
+                        boundTexture = 0;
+                    }
+                    else
+                        drawCmd.UserCallback(drawList, &drawCmd);
+                    continue;
+                }
+
+                ImVec2 clipMin((drawCmd.ClipRect.x - clipOffset.x) * clipScale.x,
+                               (drawCmd.ClipRect.y - clipOffset.y) * clipScale.y);
+                ImVec2 clipMax((drawCmd.ClipRect.z - clipOffset.x) * clipScale.x,
+                               (drawCmd.ClipRect.w - clipOffset.y) * clipScale.y);
+                if (clipMin.x < 0.0f)
+                    clipMin.x = 0.0f;
+                if (clipMin.y < 0.0f)
+                    clipMin.y = 0.0f;
+                if (clipMax.x > fbWidth)
+                    clipMax.x = fbWidth;
+                if (clipMax.y > fbHeight)
+                    clipMax.y = fbHeight;
+                if (clipMax.x <= clipMin.x || clipMax.y <= clipMin.y)
+                    continue;
+
+                VkRect2D scissor;
+                scissor.offset.x = static_cast<int32_t>(clipMin.x);
+                scissor.offset.y = static_cast<int32_t>(clipMin.y);
+                scissor.extent.width = static_cast<uint32_t>(clipMax.x - clipMin.x);
+                scissor.extent.height = static_cast<uint32_t>(clipMax.y - clipMin.y);
+                vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+
+                // Consecutive commands mostly share the font atlas, only rebind on change
+                const uint32_t textureId = static_cast<uint32_t>((intptr_t)drawCmd.GetTexID());
+                if (textureId != boundTexture)
+                {
+                    const VkDescriptorSet descriptorSet = getSet(textureId);
+                    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1,
+                                            &descriptorSet, 0, nullptr);
+                    boundTexture = textureId;
+                }
+                vkCmdDrawIndexed(commandBuffer, drawCmd.ElemCount, 1, drawCmd.IdxOffset + globalIndexOffset,
+                                 static_cast<int32_t>(drawCmd.VtxOffset + globalVertexOffset), 0);
+            }
+            globalVertexOffset += drawList->VtxBuffer.Size;
+            globalIndexOffset += drawList->IdxBuffer.Size;
+        }
+    }
+    renderer->endRendering();
+}
+
+ImTextureID ImGuiRenderer::getTextureId(VkImageView imageView, VkSampler textureSampler)
+{
+    const TextureKey key = {imageView, textureSampler != VK_NULL_HANDLE ? textureSampler : sampler};
+    const auto it = textureIds.find(key);
+    if (it != textureIds.end())
+        return (ImTextureID)(intptr_t)it->second;
+
+    uint32_t textureId;
+    if (!freeTextures.empty())
+    {
+        textureId = freeTextures.back();
+        freeTextures.pop_back();
+        textures[textureId - 1] = key;
+    }
+    else
+    {
+        textures.push_back(key);
+        textureId = static_cast<uint32_t>(textures.size());
+    }
+    textureIds.emplace(key, textureId);
+    return (ImTextureID)(intptr_t)textureId;
+}
+
+void ImGuiRenderer::releaseTexture(VkImageView imageView, VkSampler textureSampler)
+{
+    const TextureKey key = {imageView, textureSampler != VK_NULL_HANDLE ? textureSampler : sampler};
+    const auto it = textureIds.find(key);
+    if (it == textureIds.end())
+        return;
+    // Frames in flight may still bind its set, the id can be handed out again right away
+    releasedViews.push_back({imageView, renderer->getFrameNumber()});
+    freeTextures.push_back(it->second);
+    textureIds.erase(it);
+}
+
+VkDescriptorSet ImGuiRenderer::getSet(uint32_t textureId)
+{
+    if (textureId == 0 || textureId > textures.size())
+    {
+        throw std::runtime_error("[ImGui] Unknown texture id!");
+    }
+
+    DescriptorResource resource = {};
+    resource.binding = 0;
+    resource.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    resource.image.sampler = textures[textureId - 1].sampler;
+    resource.image.imageView = textures[textureId - 1].imageView;
+    resource.image.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    return renderer->getDescriptorCache().getSet(descriptorSetLayout, &resource, 1);
+}
+
+void ImGuiRenderer::invalidateReleasedViews(bool all)
+{
+    const uint64_t frameNumber = renderer->getFrameNumber();
+    const uint64_t framesInFlight = renderer->getFramesInFlight();
+    for (size_t i = 0; i < releasedViews.size();)
+    {
+        if (!all && releasedViews[i].second + framesInFlight > frameNumber)
+        {
+            i++;
+            continue;
+        }
+        // A view registered again, possibly with another sampler, keeps its sets
+        const VkImageView imageView = releasedViews[i].first;
+        bool registered = false;
+        if (!all)
+            for (const auto& texture : textureIds)
+                registered = registered || texture.first.imageView == imageView;
+        if (!registered)
+            renderer->getDescriptorCache().invalidateImageView(imageView);
+        releasedViews[i] = releasedViews.back();
+        releasedViews.pop_back();
+    }
+}
+
+void ImGuiRenderer::setupPipeline()
+{
+    VkSamplerCreateInfo samplerInfo = {};
+    samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    samplerInfo.magFilter = VK_FILTER_LINEAR;
+    samplerInfo.minFilter = VK_FILTER_LINEAR;
+    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+    samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.minLod = -1000.0f;
+    samplerInfo.maxLod = 1000.0f;
+    samplerInfo.maxAnisotropy = 1.0f;
+    if (vkCreateSampler(device, &samplerInfo, allocator, &sampler) != VK_SUCCESS)
+    {
+        throw std::runtime_error("[ImGui] Failed to create sampler!");
+    }
+
+    // The set and push constant layout come from the shaders
+    const ShaderLibrary::Layout layout = renderer->getShaderLibrary().getLayout({VERTEX_SHADER, FRAGMENT_SHADER});
+    pipelineLayout = layout.pipelineLayout;
+    descriptorSetLayout = layout.setLayouts.at(0);
+
+    requestPipeline();
+    reloadListener = renderer->getShaderLibrary().addReloadListener([this](const std::string& name)
+    {
+        if (name == VERTEX_SHADER || name == FRAGMENT_SHADER)
+            requestPipeline();
+    });
+    // The UI is drawn every frame, so the new pipeline is waited for like the first one
+    formatListener = renderer->addFormatListener([this](VkFormat)
+    {
+        pipelineHandle = 0;
+        requestPipeline();
+        if (renderer->getPipelineCompiler().wait(pipelineHandle) == VK_NULL_HANDLE)
+        {
+            throw std::runtime_error("[ImGui] Failed to create graphics pipeline!");
+        }
+    });
+}
+
+void ImGuiRenderer::requestPipeline()
+{
+    ShaderLibrary& shaders = renderer->getShaderLibrary();
+    GraphicsPipelineDesc desc;
+    desc.stages.push_back(shaders.getStage(VERTEX_SHADER));
+    desc.stages.push_back(shaders.getStage(FRAGMENT_SHADER));
+    desc.vertexBindings.push_back({0, sizeof(ImDrawVert), VK_VERTEX_INPUT_RATE_VERTEX});
+    desc.vertexAttributes = {
+        {0, 0, VK_FORMAT_R32G32_SFLOAT, offsetof(ImDrawVert, pos)},
+        {1, 0, VK_FORMAT_R32G32_SFLOAT, offsetof(ImDrawVert, uv)},
+        {2, 0, VK_FORMAT_R8G8B8A8_UNORM, offsetof(ImDrawVert, col)},
+    };
+
+    VkPipelineColorBlendAttachmentState blendAttachment = {};
+    blendAttachment.blendEnable = VK_TRUE;
+    blendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+    blendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+    blendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
+    blendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+    blendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+    blendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
+    blendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT |
+        VK_COLOR_COMPONENT_A_BIT;
+    desc.blendAttachments.push_back(blendAttachment);
+    desc.layout = pipelineLayout;
+    desc.colorFormats.push_back(renderer->getRenderFormat());
+    pipelineHandle = renderer->getPipelineCompiler().requestGraphics(desc, pipelineHandle);
+}
+
+void ImGuiRenderer::uploadFonts()
+{
+    ImGuiIO& io = ImGui::GetIO();
+    unsigned char* pixels = nullptr;
+    int width = 0;
+    int height = 0;
+    io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+    const VkDeviceSize size = static_cast<VkDeviceSize>(width) * height * 4;
+
+    VkImageCreateInfo imageInfo = {};
+    imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageInfo.format = VK_FORMAT_R8G8B8A8_UNORM;
+    imageInfo.extent = {static_cast<uint32_t>(width), static_cast<uint32_t>(height), 1};
+    imageInfo.mipLevels = 1;
+    imageInfo.arrayLayers = 1;
+    imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imageInfo.usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+    imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    fontImage = renderer->createImage(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+    const VkImageSubresourceRange range = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+    VkImageViewCreateInfo viewInfo = {};
+    viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    viewInfo.image = fontImage.image;
+    viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    viewInfo.format = VK_FORMAT_R8G8B8A8_UNORM;
+    viewInfo.subresourceRange = range;
+    if (vkCreateImageView(device, &viewInfo, allocator, &fontView) != VK_SUCCESS)
+    {
+        throw std::runtime_error("[ImGui] Failed to create font image view!");
+    }
+
+    // The acquire onto the graphics queue is recorded by the renderer's next beginFrame()
+    VkBufferImageCopy region = {};
+    region.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+    region.imageExtent = imageInfo.extent;
+    renderer->getUploadManager().uploadImage(fontImage.image, range, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, pixels,
+                                             size, &region, 1);
+
+    io.Fonts->SetTexID(getTextureId(fontView));
+    DebugConfig::verbose("[ImGui] Font atlas %dx%d uploaded through the %s queue", width, height,
+                         QueueFamilies::getName(QueueType::Transfer));
+}
+
+void ImGuiRenderer::reserveFrameBuffers(FrameBuffers& buffers, VkDeviceSize vertexSize, VkDeviceSize indexSize)
+{
+    // beginFrame() waited for the previous use of this slot, so its buffers can be replaced right away
+    if (vertexSize > buffers.vertexCapacity)
+    {
+        if (buffers.vertexBuffer.buffer != VK_NULL_HANDLE)
+            renderer->destroyBuffer(buffers.vertexBuffer);
+        buffers.vertexCapacity = growCapacity(buffers.vertexCapacity, vertexSize);
+        buffers.vertexBuffer = renderer->createBuffer(buffers.vertexCapacity, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                                                      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+    }
+    if (indexSize > buffers.indexCapacity)
+    {
+        if (buffers.indexBuffer.buffer != VK_NULL_HANDLE)
+            renderer->destroyBuffer(buffers.indexBuffer);
+        buffers.indexCapacity = growCapacity(buffers.indexCapacity, indexSize);
+        buffers.indexBuffer = renderer->createBuffer(buffers.indexCapacity, VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+                                                     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+    }
+}
@@ -0,0 +1,108 @@
+//
+// Created by Batur on 18/10/2026.
+//
+
+#ifndef IMGUIRENDERER_H
+#define IMGUIRENDERER_H
+
+#include <functional>
+#include <unordered_map>
+#include <vector>
+#include <vulkan/vulkan.h>
+#include <SDL3/SDL.h>
+#include <imgui.h>
+
+#include "MemoryAllocator.h"
+#include "PipelineCompiler.h"
+
+class VulkanRenderer;
+
+// Dear ImGui on top of VulkanRenderer.
+// Vertices and indices go to a persistently mapped buffer pair per frame in flight that only ever grows,
+// the font atlas goes through the renderer's upload manager. Texture ids index a table of image view/sampler
+// pairs, their descriptor sets come from the renderer's descriptor cache and are written once per pair.
+class ImGuiRenderer
+{
+public:
+    // Creates the ImGui context, the SDL3 platform backend and every Vulkan object, after createSwapchain().
+    // Without a window (headless) the display size follows the offscreen images and there is no input.
+    void init(VulkanRenderer& renderer, SDL_Window* window);
+    void destroy();
+
+    // Returns true when ImGui wants the event for itself
+    bool processEvent(const SDL_Event& event);
+    void newFrame();
+    // Finalizes the ImGui frame and adds it as the "ImGui" pass of the frame's render graph,
+    // between VulkanRenderer::beginFrame() and endFrame()
+    void render();
+
+    // The id stays valid until releaseTexture(), a null sampler uses the linear one
+    ImTextureID getTextureId(VkImageView imageView, VkSampler sampler = VK_NULL_HANDLE);
+    // The view's sets leave the descriptor cache once the frames in flight are done with them
+    void releaseTexture(VkImageView imageView, VkSampler sampler = VK_NULL_HANDLE);
+
+private:
+    struct FrameBuffers
+    {
+        MemoryAllocator::Buffer vertexBuffer;
+        MemoryAllocator::Buffer indexBuffer;
+        VkDeviceSize vertexCapacity = 0;
+        VkDeviceSize indexCapacity = 0;
+    };
+
+    struct TextureKey
+    {
+        VkImageView imageView;
+        VkSampler sampler;
+
+        bool operator==(const TextureKey& other) const
+        {
+            return imageView == other.imageView && sampler == other.sampler;
+        }
+    };
+
+    struct TextureKeyHash
+    {
+        size_t operator()(const TextureKey& key) const
+        {
+            const size_t h = std::hash<const void*>()(reinterpret_cast<const void*>(key.imageView));
+            return h ^ (std::hash<const void*>()(reinterpret_cast<const void*>(key.sampler)) + 0x9e3779b9 + (h << 6) +
+                (h >> 2));
+        }
+    };
+
+    VulkanRenderer* renderer = nullptr;
+    VkDevice device = VK_NULL_HANDLE;
+    const VkAllocationCallbacks* allocator = nullptr;
+    bool platformBackend = false;
+
+    VkDescriptorSetLayout descriptorSetLayout = VK_NULL_HANDLE;
+    VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+    PipelineHandle pipelineHandle = 0;
+    uint32_t reloadListener = 0;
+    uint32_t formatListener = 0;
+    VkSampler sampler = VK_NULL_HANDLE;
+
+    std::vector<FrameBuffers> frameBuffers;
+    // Texture id n is textures[n - 1], 0 is never handed out
+    std::vector<TextureKey> textures;
+    std::vector<uint32_t> freeTextures;
+    std::unordered_map<TextureKey, uint32_t, TextureKeyHash> textureIds;
+    // Views released by releaseTexture() and the frame they were released in
+    std::vector<std::pair<VkImageView, uint64_t>> releasedViews;
+
+    MemoryAllocator::Image fontImage;
+    VkImageView fontView = VK_NULL_HANDLE;
+
+    void setupPipeline();
+    // Requests the pipeline from the current shaders, the previous one stays in use until it is ready
+    void requestPipeline();
+    void uploadFonts();
+    VkDescriptorSet getSet(uint32_t textureId);
+    // Drops the cached sets of the released views no frame in flight can bind anymore, or all of them
+    void invalidateReleasedViews(bool all);
+    void reserveFrameBuffers(FrameBuffers& buffers, VkDeviceSize vertexSize, VkDeviceSize indexSize);
+    void recordDrawData(VkCommandBuffer commandBuffer, ImDrawData* drawData, FrameBuffers& buffers);
+};
+
+#endif //IMGUIRENDERER_H
@@ -0,0 +1,163 @@
+//
+// Created by Batur on 18/10/2026.
+//
+
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+#include "DebugConfig.h"
+
+namespace
+{
+    // Shared by the helpers of one parallelFor(), they may start after it already returned
+    struct ParallelState
+    {
+        JobSystem::ParallelJob job;
+        uint32_t count;
+        std::atomic<uint32_t> next{ 0 };
+        std::atomic<uint32_t> finished{ 0 };
+        std::mutex mutex;
+        std::condition_variable done;
+        // First exception thrown by an index, the others are dropped
+        std::exception_ptr error;
+    };
+
+    void drain(ParallelState& state, uint32_t thread)
+    {
+        uint32_t ran = 0;
+        for (uint32_t i = state.next++; i < state.count; i = state.next++)
+        {
+            try
+            {
+                state.job(i, thread);
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(state.mutex);
+                if (!state.error)
+                    state.error = std::current_exception();
+            }
+            ran++;
+        }
+        if (ran == 0)
+            return;
+        if (state.finished.fetch_add(ran) + ran == state.count)
+        {
+            std::lock_guard<std::mutex> lock(state.mutex);
+            state.done.notify_all();
+        }
+    }
+}
+
+void JobSystem::init(uint32_t workerCount)
+{
+    if (workerCount == 0)
+        workerCount = std::max(1u, std::thread::hardware_concurrency()) - 1;
+    stopping = false;
+    workers.reserve(workerCount);
+    for (uint32_t i = 0; i < workerCount; i++)
+        workers.emplace_back(&JobSystem::run, this, i);
+    DebugConfig::verbose("[Jobs] %u worker threads", workerCount);
+}
+
+void JobSystem::destroy()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& worker : workers)
+        worker.join();
+    workers.clear();
+}
+
+void JobSystem::enqueue(Job job)
+{
+    // Without workers the job runs right away
+    if (workers.empty())
+    {
+        job(0);
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queue.push_back(std::move(job));
+    }
+    wake.notify_one();
+}
+
+void JobSystem::parallelFor(uint32_t count, const ParallelJob& job)
+{
+    if (count == 0)
+        return;
+    const uint32_t caller = getWorkerCount();
+    if (count == 1 || workers.empty())
+    {
+        for (uint32_t i = 0; i < count; i++)
+            job(i, caller);
+        return;
+    }
+
+    std::shared_ptr<ParallelState> state = std::make_shared<ParallelState>();
+    state->job = job;
+    state->count = count;
+    // The caller takes one share itself
+    const uint32_t helpers = std::min(count - 1, getWorkerCount());
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (uint32_t i = 0; i < helpers; i++)
+            queue.push_back([state](uint32_t thread) { drain(*state, thread); });
+    }
+    if (helpers == 1)
+        wake.notify_one();
+    else
+        wake.notify_all();
+
+    drain(*state, caller);
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->done.wait(lock, [&state]() { return state->finished.load() == state->count; });
+    if (state->error)
+        std::rethrow_exception(state->error);
+}
+
+uint32_t JobSystem::getWorkerCount() const
+{
+    return static_cast<uint32_t>(workers.size());
+}
+
+uint32_t JobSystem::getThreadCount() const
+{
+    return getWorkerCount() + 1;
+}
+
+void JobSystem::run(uint32_t thread)
+{
+    for (;;)
+    {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this]() { return stopping || !queue.empty(); });
+            if (queue.empty())
+                return;
+            job = std::move(queue.front());
+            queue.pop_front();
+        }
+        try
+        {
+            job(thread);
+        }
+        catch (const std::exception& exception)
+        {
+            DebugConfig::warning("[Jobs] Job failed on worker %u: %s", thread, exception.what());
+        }
+        catch (...)
+        {
+            DebugConfig::warning("[Jobs] Job failed on worker %u", thread);
+        }
+    }
+}
@@ -0,0 +1,52 @@
+//
+// Created by Batur on 18/10/2026.
+//
+
+#ifndef JOBSYSTEM_H
+#define JOBSYSTEM_H
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed pool of worker threads fed from one queue.
+// Every job gets the index of the thread running it, workers are 0 to getWorkerCount() - 1 and the thread
+// calling parallelFor() helps out as getWorkerCount(), so per-thread resources are sized getThreadCount().
+// Exceptions never leave a worker: parallelFor() rethrows the first one on the calling thread once every index
+// finished, a background job's is logged.
+class JobSystem
+{
+public:
+    using Job = std::function<void(uint32_t thread)>;
+    using ParallelJob = std::function<void(uint32_t index, uint32_t thread)>;
+
+    // 0 workers picks one per hardware thread except the calling one
+    void init(uint32_t workerCount = 0);
+    // Finishes the queued jobs first
+    void destroy();
+
+    // Fire and forget, for background work. Thread safe.
+    void enqueue(Job job);
+    // Runs job(i) for every i below count and returns once all of them finished. The calling thread takes
+    // part, so it makes progress even while every worker is busy. Not to be called from inside a job.
+    void parallelFor(uint32_t count, const ParallelJob& job);
+
+    uint32_t getWorkerCount() const;
+    // Workers plus the thread calling parallelFor()
+    uint32_t getThreadCount() const;
+
+private:
+    std::vector<std::thread> workers;
+    std::deque<Job> queue;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+
+    void run(uint32_t thread);
+};
+
+#endif //JOBSYSTEM_H
@@ -0,0 +1,617 @@
+//
+// Created by Batur on 18/10/2026.
+//
+
+#include "MemoryAllocator.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "DebugConfig.h"
+#include "DeviceSelector.h"
+
+struct MemoryAllocator::Block
+{
+    explicit Block(VkDeviceSize size)
+        : tlsf(size)
+    {
+    }
+
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    void* mapped = nullptr;
+    uint32_t memoryTypeIndex = 0;
+    TlsfAllocator tlsf;
+    std::unordered_set<Allocation*> allocations;
+};
+
+namespace
+{
+    constexpr VkDeviceSize LARGE_HEAP_BLOCK_SIZE = 256ull * 1024 * 1024;
+    constexpr VkDeviceSize SMALL_HEAP_LIMIT = 1024ull * 1024 * 1024;
+    // Without VK_EXT_memory_budget the process is assumed to get this share of every heap
+    constexpr VkDeviceSize ESTIMATED_BUDGET_PERCENT = 80;
+
+    VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    uint32_t countBits(uint32_t value)
+    {
+        uint32_t count = 0;
+        for (; value; value &= value - 1)
+            count++;
+        return count;
+    }
+}
+
+void MemoryAllocator::addRequirements(DeviceRequirements& requirements)
+{
+    requirements.optionalExtensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+    requirements.optionalExtensions.push_back(VK_EXT_MEMORY_PRIORITY_EXTENSION_NAME);
+    VkPhysicalDeviceMemoryPriorityFeaturesEXT priority = {};
+    priority.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PRIORITY_FEATURES_EXT;
+    priority.memoryPriority = VK_TRUE;
+    requirements.addExtensionFeatures(VK_EXT_MEMORY_PRIORITY_EXTENSION_NAME, priority);
+}
+
+void MemoryAllocator::init(VkPhysicalDevice gpu, VkDevice logicalDevice,
+                           const VkAllocationCallbacks* allocationCallbacks, bool memoryBudget,
+                           bool memoryPriority)
+{
+    physicalDevice = gpu;
+    device = logicalDevice;
+    budgetSupported = memoryBudget;
+    prioritySupported = memoryPriority;
+    allocator = allocationCallbacks;
+    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties);
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+    bufferImageGranularity = properties.limits.bufferImageGranularity;
+    nonCoherentAtomSize = properties.limits.nonCoherentAtomSize;
+    maxAllocationCount = properties.limits.maxMemoryAllocationCount;
+
+    for (uint32_t i = 0; i < memoryProperties.memoryHeapCount; i++)
+    {
+        DebugConfig::verbose("[Vulkan] Memory heap %u: %llu MiB%s", i,
+                             static_cast<unsigned long long>(memoryProperties.memoryHeaps[i].size >> 20),
+                             memoryProperties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT
+                                 ? " device local"
+                                 : "");
+    }
+    updateBudget();
+}
+
+void MemoryAllocator::destroy()
+{
+    if (device == VK_NULL_HANDLE)
+        return;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    uint32_t leaked = 0;
+    for (std::vector<Block*>& typeBlocks : blocks)
+    {
+        for (Block* block : typeBlocks)
+        {
+            for (Allocation* allocation : block->allocations)
+            {
+                delete allocation;
+                leaked++;
+            }
+            freeDeviceMemory(block->memory, block->tlsf.getSize(), block->memoryTypeIndex);
+            delete block;
+        }
+        typeBlocks.clear();
+    }
+    for (Allocation* allocation : dedicatedAllocations)
+    {
+        freeDeviceMemory(allocation->memory, allocation->size, allocation->memoryTypeIndex);
+        delete allocation;
+        leaked++;
+    }
+    dedicatedAllocations.clear();
+
+    if (leaked > 0)
+        DebugConfig::warning("[Vulkan] %u device memory allocations were never freed", leaked);
+    device = VK_NULL_HANDLE;
+}
+
+MemoryAllocator::Buffer MemoryAllocator::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage,
+                                                      VkMemoryPropertyFlags properties)
+{
+    Buffer buffer;
+    VkBufferCreateInfo bufferInfo = {};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = size;
+    bufferInfo.usage = usage;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    if (vkCreateBuffer(device, &bufferInfo, allocator, &buffer.buffer) != VK_SUCCESS)
+    {
+        throw std::runtime_error("[Vulkan] Failed to create buffer!");
+    }
+
+    VkBufferMemoryRequirementsInfo2 requirementsInfo = {};
+    requirementsInfo.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_REQUIREMENTS_INFO_2;
+    requirementsInfo.buffer = buffer.buffer;
+    VkMemoryDedicatedRequirements dedicatedRequirements = {};
+    dedicatedRequirements.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS;
+    VkMemoryRequirements2 requirements = {};
+    requirements.sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2;
+    requirements.pNext = &dedicatedRequirements;
+    vkGetBufferMemoryRequirements2(device, &requirementsInfo, &requirements);
+
+    buffer.allocation = allocateMemory(requirements.memoryRequirements, properties,
+                                       dedicatedRequirements.prefersDedicatedAllocation ||
+                                       dedicatedRequirements.requiresDedicatedAllocation,
+                                       buffer.buffer, VK_NULL_HANDLE);
+    if (!buffer.allocation)
+    {
+        vkDestroyBuffer(device, buffer.buffer, allocator);
+        throw std::runtime_error("[Vulkan] Failed to allocate buffer memory!");
+    }
+    if (vkBindBufferMemory(device, buffer.buffer, buffer.allocation->memory, buffer.allocation->offset) != VK_SUCCESS)
+    {
+        free(buffer.allocation);
+        vkDestroyBuffer(device, buffer.buffer, allocator);
+        throw std::runtime_error("[Vulkan] Failed to bind buffer memory!");
+    }
+    return buffer;
+}
+
+void MemoryAllocator::destroyBuffer(Buffer& buffer)
+{
+    if (buffer.buffer != VK_NULL_HANDLE)
+        vkDestroyBuffer(device, buffer.buffer, allocator);
+    free(buffer.allocation);
+    buffer = Buffer();
+}
+
+MemoryAllocator::Image MemoryAllocator::createImage(const VkImageCreateInfo& imageInfo,
+                                                    VkMemoryPropertyFlags properties)
+{
+    Image image;
+    if (vkCreateImage(device, &imageInfo, allocator, &image.image) != VK_SUCCESS)
+    {
+        throw std::runtime_error("[Vulkan] Failed to create image!");
+    }
+
+    VkImageMemoryRequirementsInfo2 requirementsInfo = {};
+    requirementsInfo.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_REQUIREMENTS_INFO_2;
+    requirementsInfo.image = image.image;
+    VkMemoryDedicatedRequirements dedicatedRequirements = {};
+    dedicatedRequirements.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS;
+    VkMemoryRequirements2 requirements = {};
+    requirements.sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2;
+    requirements.pNext = &dedicatedRequirements;
+    vkGetImageMemoryRequirements2(device, &requirementsInfo, &requirements);
+
+    image.allocation = allocateMemory(requirements.memoryRequirements, properties,
+                                      dedicatedRequirements.prefersDedicatedAllocation ||
+                                      dedicatedRequirements.requiresDedicatedAllocation,
+                                      VK_NULL_HANDLE, image.image);
+    if (!image.allocation)
+    {
+        vkDestroyImage(device, image.image, allocator);
+        throw std::runtime_error("[Vulkan] Failed to allocate image memory!");
+    }
+    if (vkBindImageMemory(device, image.image, image.allocation->memory, image.allocation->offset) != VK_SUCCESS)
+    {
+        free(image.allocation);
+        vkDestroyImage(device, image.image, allocator);
+        throw std::runtime_error("[Vulkan] Failed to bind image memory!");
+    }
+    return image;
+}
+
+void MemoryAllocator::destroyImage(Image& image)
+{
+    if (image.image != VK_NULL_HANDLE)
+        vkDestroyImage(device, image.image, allocator);
+    free(image.allocation);
+    image = Image();
+}
+
+MemoryAllocator::Allocation* MemoryAllocator::allocate(const VkMemoryRequirements& requirements,
+                                                       VkMemoryPropertyFlags properties)
+{
+    return allocateMemory(requirements, properties, false, VK_NULL_HANDLE, VK_NULL_HANDLE);
+}
+
+MemoryAllocator::Allocation* MemoryAllocator::allocateMemory(const VkMemoryRequirements& requirements,
+                                                             VkMemoryPropertyFlags properties,
+                                                             bool preferDedicated, VkBuffer buffer, VkImage image)
+{
+    const uint32_t memoryTypeIndex = findMemoryType(requirements.memoryTypeBits, properties);
+    if (memoryTypeIndex == UINT32_MAX)
+    {
+        DebugConfig::warning("[Vulkan] No memory type matches properties 0x%x", properties);
+        return nullptr;
+    }
+
+    // Keeping every sub-allocation on its own granularity page avoids linear/optimal aliasing rules entirely
+    VkDeviceSize size = requirements.size;
+    VkDeviceSize alignment = requirements.alignment;
+    if (bufferImageGranularity > 1)
+    {
+        alignment = std::max(alignment, bufferImageGranularity);
+        size = alignUp(size, bufferImageGranularity);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (preferDedicated || size > getBlockSize(memoryTypeIndex) / 2)
+        return allocateDedicated(requirements.size, memoryTypeIndex, buffer, image);
+
+    Allocation suballocation;
+    if (allocateFromBlocks(size, alignment, memoryTypeIndex, nullptr, suballocation))
+    {
+        Allocation* allocation = new Allocation(suballocation);
+        allocation->block->allocations.insert(allocation);
+        return allocation;
+    }
+
+    // A new block did not fit in the heap, a tight dedicated allocation still might
+    return allocateDedicated(requirements.size, memoryTypeIndex, buffer, image);
+}
+
+void MemoryAllocator::free(Allocation* allocation)
+{
+    if (!allocation)
+        return;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (allocation->block)
+    {
+        const uint32_t memoryTypeIndex = allocation->memoryTypeIndex;
+        releaseRange(allocation);
+        releaseEmptyBlocks(memoryTypeIndex, true);
+    }
+    else
+    {
+        freeDeviceMemory(allocation->memory, allocation->size, allocation->memoryTypeIndex);
+        dedicatedAllocations.erase(allocation);
+    }
+    delete allocation;
+}
+
+void MemoryAllocator::flush(const Allocation* allocation, VkDeviceSize offset, VkDeviceSize size)
+{
+    const VkMemoryPropertyFlags flags = memoryProperties.memoryTypes[allocation->memoryTypeIndex].propertyFlags;
+    if (flags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)
+        return;
+    const VkMappedMemoryRange range = getMappedRange(allocation, offset, size);
+    vkFlushMappedMemoryRanges(device, 1, &range);
+}
+
+void MemoryAllocator::invalidate(const Allocation* allocation, VkDeviceSize offset, VkDeviceSize size)
+{
+    const VkMemoryPropertyFlags flags = memoryProperties.memoryTypes[allocation->memoryTypeIndex].propertyFlags;
+    if (flags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)
+        return;
+    const VkMappedMemoryRange range = getMappedRange(allocation, offset, size);
+    vkInvalidateMappedMemoryRanges(device, 1, &range);
+}
+
+uint32_t MemoryAllocator::defragment(uint32_t maxMoves, const DefragmentationCallback& move)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    uint32_t moves = 0;
+    for (uint32_t type = 0; type < memoryProperties.memoryTypeCount && moves < maxMoves; type++)
+    {
+        std::vector<Block*>& typeBlocks = blocks[type];
+        if (typeBlocks.size() < 2)
+            continue;
+
+        // Empty the least used block into the others
+        Block* source = nullptr;
+        for (Block* block : typeBlocks)
+            if (!block->tlsf.isEmpty() &&
+                (!source || block->tlsf.getUsedSize() < source->tlsf.getUsedSize()))
+                source = block;
+        if (!source)
+            continue;
+
+        const std::vector<Allocation*> candidates(source->allocations.begin(), source->allocations.end());
+        for (Allocation* allocation : candidates)
+        {
+            if (moves >= maxMoves)
+                break;
+
+            Allocation destination;
+            if (!allocateFromBlocks(TlsfAllocator::getSize(allocation->range), allocation->alignment, type, source,
+                                    destination))
+                break;
+
+            DefragmentationMove defragmentationMove = {};
+            defragmentationMove.allocation = allocation;
+            defragmentationMove.srcMemory = allocation->memory;
+            defragmentationMove.srcOffset = allocation->offset;
+            defragmentationMove.dstMemory = destination.memory;
+            defragmentationMove.dstOffset = destination.offset;
+            defragmentationMove.size = allocation->size;
+            if (!move(defragmentationMove))
+            {
+                destination.block->tlsf.free(destination.range);
+                continue;
+            }
+
+            releaseRange(allocation);
+            allocation->memory = destination.memory;
+            allocation->offset = destination.offset;
+            allocation->mapped = destination.mapped;
+            allocation->block = destination.block;
+            allocation->range = destination.range;
+            destination.block->allocations.insert(allocation);
+            moves++;
+        }
+        releaseEmptyBlocks(type, false);
+    }
+
+    if (moves > 0)
+        DebugConfig::verbose("[Vulkan] Defragmentation moved %u allocations", moves);
+    return moves;
+}
+
+uint32_t MemoryAllocator::findMemoryType(uint32_t typeBits, VkMemoryPropertyFlags properties) const
+{
+    // Among the matching types prefer the one with the fewest extra flags, e.g. plain device local over ReBAR
+    uint32_t best = UINT32_MAX;
+    uint32_t bestExtraFlags = UINT32_MAX;
+    for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++)
+    {
+        const VkMemoryPropertyFlags flags = memoryProperties.memoryTypes[i].propertyFlags;
+        if (!(typeBits & (1u << i)) || (flags & properties) != properties)
+            continue;
+        const uint32_t extraFlags = countBits(flags & ~properties);
+        if (extraFlags < bestExtraFlags)
+        {
+            best = i;
+            bestExtraFlags = extraFlags;
+        }
+    }
+    return best;
+}
+
+MemoryAllocator::Statistics MemoryAllocator::getStatistics() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    Statistics stats = {};
+    for (const std::vector<Block*>& typeBlocks : blocks)
+    {
+        for (const Block* block : typeBlocks)
+        {
+            stats.blockCount++;
+            stats.allocationCount += block->tlsf.getAllocationCount();
+            stats.blockBytes += block->tlsf.getSize();
+            stats.usedBytes += block->tlsf.getUsedSize();
+        }
+    }
+    for (const Allocation* allocation : dedicatedAllocations)
+    {
+        stats.dedicatedCount++;
+        stats.dedicatedBytes += allocation->size;
+    }
+    return stats;
+}
+
+void MemoryAllocator::updateBudget()
+{
+    VkPhysicalDeviceMemoryBudgetPropertiesEXT budgetProperties = {};
+    budgetProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+    if (budgetSupported)
+    {
+        VkPhysicalDeviceMemoryProperties2 properties = {};
+        properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+        properties.pNext = &budgetProperties;
+        vkGetPhysicalDeviceMemoryProperties2(physicalDevice, &properties);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for (uint32_t i = 0; i < memoryProperties.memoryHeapCount; i++)
+    {
+        HeapBudget& heap = budgets[i];
+        heap.size = memoryProperties.memoryHeaps[i].size;
+        heap.flags = memoryProperties.memoryHeaps[i].flags;
+        heap.allocatedBytes = heapBytes[i];
+        if (budgetSupported)
+        {
+            heap.budget = budgetProperties.heapBudget[i];
+            heap.usage = budgetProperties.heapUsage[i];
+        }
+        else
+        {
+            heap.budget = heap.size / 100 * ESTIMATED_BUDGET_PERCENT;
+            heap.usage = heapBytes[i];
+        }
+    }
+}
+
+std::vector<MemoryAllocator::HeapBudget> MemoryAllocator::getBudgets() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return std::vector<HeapBudget>(budgets, budgets + memoryProperties.memoryHeapCount);
+}
+
+bool MemoryAllocator::isBudgetSupported() const
+{
+    return budgetSupported;
+}
+
+const VkPhysicalDeviceMemoryProperties& MemoryAllocator::getMemoryProperties() const
+{
+    return memoryProperties;
+}
+
+VkDeviceSize MemoryAllocator::getBlockSize(uint32_t memoryTypeIndex) const
+{
+    const VkDeviceSize heapSize = memoryProperties.memoryHeaps[memoryProperties.memoryTypes[memoryTypeIndex].heapIndex].
+        size;
+    return heapSize <= SMALL_HEAP_LIMIT ? heapSize / 8 : LARGE_HEAP_BLOCK_SIZE;
+}
+
+VkDeviceMemory MemoryAllocator::allocateDeviceMemory(VkDeviceSize size, uint32_t memoryTypeIndex, void** mapped,
+                                                     const void* next, float priority)
+{
+    if (deviceAllocationCount >= maxAllocationCount)
+    {
+        DebugConfig::warning("[Vulkan] maxMemoryAllocationCount (%u) reached", maxAllocationCount);
+        return VK_NULL_HANDLE;
+    }
+
+    VkMemoryPriorityAllocateInfoEXT priorityInfo = {};
+    priorityInfo.sType = VK_STRUCTURE_TYPE_MEMORY_PRIORITY_ALLOCATE_INFO_EXT;
+    priorityInfo.pNext = next;
+    priorityInfo.priority = priority;
+    VkMemoryAllocateInfo allocateInfo = {};
+    allocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocateInfo.pNext = prioritySupported ? &priorityInfo : next;
+    allocateInfo.allocationSize = size;
+    allocateInfo.memoryTypeIndex = memoryTypeIndex;
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    if (vkAllocateMemory(device, &allocateInfo, allocator, &memory) != VK_SUCCESS)
+        return VK_NULL_HANDLE;
+
+    *mapped = nullptr;
+    if (memoryProperties.memoryTypes[memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+    {
+        if (vkMapMemory(device, memory, 0, VK_WHOLE_SIZE, 0, mapped) != VK_SUCCESS)
+        {
+            vkFreeMemory(device, memory, allocator);
+            return VK_NULL_HANDLE;
+        }
+    }
+    deviceAllocationCount++;
+    heapBytes[memoryProperties.memoryTypes[memoryTypeIndex].heapIndex] += size;
+    return memory;
+}
+
+void MemoryAllocator::freeDeviceMemory(VkDeviceMemory memory, VkDeviceSize size, uint32_t memoryTypeIndex)
+{
+    // Freeing implicitly unmaps
+    vkFreeMemory(device, memory, allocator);
+    deviceAllocationCount--;
+    heapBytes[memoryProperties.memoryTypes[memoryTypeIndex].heapIndex] -= size;
+}
+
+bool MemoryAllocator::allocateFromBlocks(VkDeviceSize size, VkDeviceSize alignment, uint32_t memoryTypeIndex,
+                                         const Block* exclude, Allocation& allocation)
+{
+    Block* target = nullptr;
+    TlsfAllocator::Range* range = nullptr;
+    for (Block* block : blocks[memoryTypeIndex])
+    {
+        if (block == exclude)
+            continue;
+        range = block->tlsf.allocate(size, alignment);
+        if (range)
+        {
+            target = block;
+            break;
+        }
+    }
+
+    if (!target)
+    {
+        if (exclude)
+            return false;
+
+        const VkDeviceSize blockSize = getBlockSize(memoryTypeIndex);
+        void* mapped = nullptr;
+        const VkDeviceMemory memory = allocateDeviceMemory(blockSize, memoryTypeIndex, &mapped, nullptr);
+        if (memory == VK_NULL_HANDLE)
+            return false;
+
+        target = new Block(blockSize);
+        target->memory = memory;
+        target->mapped = mapped;
+        target->memoryTypeIndex = memoryTypeIndex;
+        blocks[memoryTypeIndex].push_back(target);
+        DebugConfig::verbose("[Vulkan] New %llu MiB memory block for type %u",
+                             static_cast<unsigned long long>(blockSize >> 20), memoryTypeIndex);
+
+        range = target->tlsf.allocate(size, alignment);
+        if (!range)
+            return false;
+    }
+
+    allocation.memory = target->memory;
+    allocation.offset = TlsfAllocator::getOffset(range);
+    allocation.size = size;
+    allocation.mapped = target->mapped ? static_cast<char*>(target->mapped) + allocation.offset : nullptr;
+    allocation.memoryTypeIndex = memoryTypeIndex;
+    allocation.block = target;
+    allocation.range = range;
+    allocation.alignment = alignment;
+    return true;
+}
+
+MemoryAllocator::Allocation* MemoryAllocator::allocateDedicated(VkDeviceSize size, uint32_t memoryTypeIndex,
+                                                                VkBuffer buffer, VkImage image)
+{
+    VkMemoryDedicatedAllocateInfo dedicatedInfo = {};
+    dedicatedInfo.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO;
+    dedicatedInfo.buffer = buffer;
+    dedicatedInfo.image = image;
+    const bool hasResource = buffer != VK_NULL_HANDLE || image != VK_NULL_HANDLE;
+
+    void* mapped = nullptr;
+    const VkDeviceMemory memory = allocateDeviceMemory(size, memoryTypeIndex, &mapped,
+                                                       hasResource ? &dedicatedInfo : nullptr,
+                                                       image != VK_NULL_HANDLE ? DEDICATED_IMAGE_PRIORITY : 0.5f);
+    if (memory == VK_NULL_HANDLE)
+        return nullptr;
+
+    Allocation* allocation = new Allocation();
+    allocation->memory = memory;
+    allocation->size = size;
+    allocation->mapped = mapped;
+    allocation->memoryTypeIndex = memoryTypeIndex;
+    dedicatedAllocations.insert(allocation);
+    return allocation;
+}
+
+void MemoryAllocator::releaseRange(Allocation* allocation)
+{
+    allocation->block->tlsf.free(allocation->range);
+    allocation->block->allocations.erase(allocation);
+    allocation->block = nullptr;
+    allocation->range = nullptr;
+}
+
+void MemoryAllocator::releaseEmptyBlocks(uint32_t memoryTypeIndex, bool keepOne)
+{
+    // One empty block is kept around so a free/allocate pattern at the boundary does not thrash vkAllocateMemory
+    std::vector<Block*>& typeBlocks = blocks[memoryTypeIndex];
+    bool kept = !keepOne;
+    for (auto it = typeBlocks.begin(); it != typeBlocks.end();)
+    {
+        Block* block = *it;
+        if (!block->tlsf.isEmpty() || !kept)
+        {
+            kept = kept || block->tlsf.isEmpty();
+            ++it;
+            continue;
+        }
+        freeDeviceMemory(block->memory, block->tlsf.getSize(), memoryTypeIndex);
+        delete block;
+        it = typeBlocks.erase(it);
+    }
+}
+
+VkMappedMemoryRange MemoryAllocator::getMappedRange(const Allocation* allocation, VkDeviceSize offset,
+                                                    VkDeviceSize size) const
+{
+    const VkDeviceSize memorySize = allocation->block ? allocation->block->tlsf.getSize() : allocation->size;
+    const VkDeviceSize begin = (allocation->offset + offset) / nonCoherentAtomSize * nonCoherentAtomSize;
+    VkDeviceSize end = size == VK_WHOLE_SIZE
+                           ? allocation->offset + allocation->size
+                           : allocation->offset + offset + size;
+    end = std::min(alignUp(end, nonCoherentAtomSize), memorySize);
+
+    VkMappedMemoryRange range = {};
+    range.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+    range.memory = allocation->memory;
+    range.offset = begin;
+    range.size = end - begin;
+    return range;
+}
@@ -0,0 +1,160 @@
+//
+// Created by Batur on 18/10/2026.
+//
+
+#ifndef MEMORYALLOCATOR_H
+#define MEMORYALLOCATOR_H
+
+#include <functional>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+#include "TlsfAllocator.h"
+
+struct DeviceRequirements;
+
+// Device memory sub-allocator.
+// Each memory type owns a list of large VkDeviceMemory blocks that are carved up with TLSF, so resources
+// share a handful of vkAllocateMemory calls. Resources the driver wants dedicated memory for, or that would
+// take more than half a block, get their own allocation. Host visible blocks stay persistently mapped.
+class MemoryAllocator
+{
+public:
+    struct Block;
+
+    struct Allocation
+    {
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        VkDeviceSize offset = 0;
+        VkDeviceSize size = 0;
+        // Null unless the memory type is host visible
+        void* mapped = nullptr;
+        uint32_t memoryTypeIndex = 0;
+        // Free slot for the owner, handed back in defragmentation moves
+        void* userData = nullptr;
+
+        Block* block = nullptr;
+        TlsfAllocator::Range* range = nullptr;
+        VkDeviceSize alignment = 1;
+    };
+
+    struct Buffer
+    {
+        VkBuffer buffer = VK_NULL_HANDLE;
+        Allocation* allocation = nullptr;
+    };
+
+    struct Image
+    {
+        VkImage image = VK_NULL_HANDLE;
+        Allocation* allocation = nullptr;
+    };
+
+    // The callback must copy `size` bytes from the source to the destination memory and rebind the resource.
+    // Returning false cancels the move and leaves the allocation where it was.
+    struct DefragmentationMove
+    {
+        Allocation* allocation;
+        VkDeviceMemory srcMemory;
+        VkDeviceSize srcOffset;
+        VkDeviceMemory dstMemory;
+        VkDeviceSize dstOffset;
+        VkDeviceSize size;
+    };
+
+    using DefragmentationCallback = std::function<bool(const DefragmentationMove&)>;
+
+    struct Statistics
+    {
+        uint32_t blockCount;
+        uint32_t dedicatedCount;
+        uint32_t allocationCount;
+        VkDeviceSize blockBytes;
+        VkDeviceSize usedBytes;
+        VkDeviceSize dedicatedBytes;
+    };
+
+    // Per heap, from VK_EXT_memory_budget when enabled and estimated from our own allocations otherwise
+    struct HeapBudget
+    {
+        VkDeviceSize size;
+        // What the process can allocate from the heap before the driver starts paging
+        VkDeviceSize budget;
+        // Everything the process allocated from it, other allocators included
+        VkDeviceSize usage;
+        // The part of the usage allocated here
+        VkDeviceSize allocatedBytes;
+        VkMemoryHeapFlags flags;
+    };
+
+    // Render targets and other images the driver wants in memory of their own are touched every frame, they are
+    // the last to be paged out under memory pressure when priorities are supported
+    static constexpr float DEDICATED_IMAGE_PRIORITY = 1.0f;
+
+    // Asks for VK_EXT_memory_budget, budgets are estimated without it, and VK_EXT_memory_priority
+    static void addRequirements(DeviceRequirements& requirements);
+    // `memoryBudget` and `memoryPriority` when their extensions are enabled on the device
+    void init(VkPhysicalDevice physicalDevice, VkDevice device, const VkAllocationCallbacks* allocator,
+              bool memoryBudget, bool memoryPriority);
+    void destroy();
+
+    Buffer createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags memoryProperties);
+    void destroyBuffer(Buffer& buffer);
+    Image createImage(const VkImageCreateInfo& imageInfo, VkMemoryPropertyFlags memoryProperties);
+    void destroyImage(Image& image);
+
+    Allocation* allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags memoryProperties);
+    void free(Allocation* allocation);
+    // Only needed for memory types without VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+    void flush(const Allocation* allocation, VkDeviceSize offset = 0, VkDeviceSize size = VK_WHOLE_SIZE);
+    void invalidate(const Allocation* allocation, VkDeviceSize offset = 0, VkDeviceSize size = VK_WHOLE_SIZE);
+
+    // Moves up to `maxMoves` allocations out of the emptiest blocks and releases the blocks left empty.
+    // Returns the number of moves performed. The callback runs under the allocator lock and must not call back into it.
+    uint32_t defragment(uint32_t maxMoves, const DefragmentationCallback& move);
+
+    uint32_t findMemoryType(uint32_t typeBits, VkMemoryPropertyFlags memoryProperties) const;
+    Statistics getStatistics() const;
+    // Queries the heap budgets, called by the renderer every frame
+    void updateBudget();
+    std::vector<HeapBudget> getBudgets() const;
+    bool isBudgetSupported() const;
+    const VkPhysicalDeviceMemoryProperties& getMemoryProperties() const;
+
+private:
+    VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
+    VkDevice device = VK_NULL_HANDLE;
+    const VkAllocationCallbacks* allocator = nullptr;
+    VkPhysicalDeviceMemoryProperties memoryProperties = {};
+    bool budgetSupported = false;
+    bool prioritySupported = false;
+    VkDeviceSize heapBytes[VK_MAX_MEMORY_HEAPS] = {};
+    HeapBudget budgets[VK_MAX_MEMORY_HEAPS] = {};
+    VkDeviceSize bufferImageGranularity = 1;
+    VkDeviceSize nonCoherentAtomSize = 1;
+    uint32_t maxAllocationCount = 0;
+    uint32_t deviceAllocationCount = 0;
+
+    std::vector<Block*> blocks[VK_MAX_MEMORY_TYPES];
+    std::unordered_set<Allocation*> dedicatedAllocations;
+    mutable std::mutex mutex;
+
+    VkDeviceSize getBlockSize(uint32_t memoryTypeIndex) const;
+    // `priority` is ignored without VK_EXT_memory_priority, 0.5 is the default
+    VkDeviceMemory allocateDeviceMemory(VkDeviceSize size, uint32_t memoryTypeIndex, void** mapped,
+                                        const void* next, float priority = 0.5f);
+    void freeDeviceMemory(VkDeviceMemory memory, VkDeviceSize size, uint32_t memoryTypeIndex);
+    // With `exclude` set no new block is created, this is the defragmentation path
+    bool allocateFromBlocks(VkDeviceSize size, VkDeviceSize alignment, uint32_t memoryTypeIndex,
+                            const Block* exclude, Allocation& allocation);
+    Allocation* allocateDedicated(VkDeviceSize size, uint32_t memoryTypeIndex, VkBuffer buffer, VkImage image);
+    Allocation* allocateMemory(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags memoryProperties,
+                               bool preferDedicated, VkBuffer buffer, VkImage image);
+    void releaseRange(Allocation* allocation);
+    void releaseEmptyBlocks(uint32_t memoryTypeIndex, bool keepOne);
+    VkMappedMemoryRange getMappedRange(const Allocation* allocation, VkDeviceSize offset, VkDeviceSize size) const;
+};
+
+#endif //MEMORYALLOCATOR_H
@@ -0,0 +1,132 @@
+//
+// Created by Batur on 18/10/2026.
+//
+
+#include "PipelineCacheFile.h"
+
+#include <cstdio>
+#include <cstring>
+
+#include "DebugConfig.h"
+
+std::vector<char> PipelineCacheFile::read(const std::string& path, const VkPhysicalDeviceProperties& properties)
+{
+    std::vector<char> data;
+    FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file)
+    {
+        DebugConfig::verbose("[Vulkan] No pipeline cache found at %s", path.c_str());
+        return data;
+    }
+
+    Header header = {};
+    if (std::fread(&header, sizeof(header), 1, file) != 1)
+    {
+        std::fclose(file);
+        DebugConfig::warning("[Vulkan] Pipeline cache %s is truncated, ignoring it", path.c_str());
+        return data;
+    }
+
+    if (header.magic != MAGIC || header.version != VERSION || header.headerSize != sizeof(Header))
+    {
+        std::fclose(file);
+        DebugConfig::warning("[Vulkan] Pipeline cache %s has an unknown format, ignoring it", path.c_str());
+        return data;
+    }
+
+    if (header.vendorID != properties.vendorID || header.deviceID != properties.deviceID ||
+        header.driverVersion != properties.driverVersion ||
+        std::memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) != 0)
+    {
+        std::fclose(file);
+        DebugConfig::verbose("[Vulkan] Pipeline cache %s was built for another device or driver, ignoring it",
+                             path.c_str());
+        return data;
+    }
+
+    data.resize(static_cast<size_t>(header.dataSize));
+    const bool complete = data.empty() || std::fread(data.data(), data.size(), 1, file) == 1;
+    std::fclose(file);
+
+    if (!complete || hash(data.data(), data.size()) != header.dataHash || !isBlobCompatible(data, properties))
+    {
+        DebugConfig::warning("[Vulkan] Pipeline cache %s is corrupted, ignoring it", path.c_str());
+        data.clear();
+    }
+    return data;
+}
+
+bool PipelineCacheFile::write(const std::string& path, const VkPhysicalDeviceProperties& properties,
+                              const std::vector<char>& data)
+{
+    Header header = {};
+    header.magic = MAGIC;
+    header.version = VERSION;
+    header.headerSize = sizeof(Header);
+    header.vendorID = properties.vendorID;
+    header.deviceID = properties.deviceID;
+    header.driverVersion = properties.driverVersion;
+    std::memcpy(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE);
+    header.dataSize = data.size();
+    header.dataHash = hash(data.data(), data.size());
+
+    const std::string tempPath = path + ".tmp";
+    FILE* file = std::fopen(tempPath.c_str(), "wb");
+    if (!file)
+    {
+        DebugConfig::warning("[Vulkan] Could not open %s for writing", tempPath.c_str());
+        return false;
+    }
+
+    bool written = std::fwrite(&header, sizeof(header), 1, file) == 1;
+    if (written && !data.empty())
+        written = std::fwrite(data.data(), data.size(), 1, file) == 1;
+    written = std::fflush(file) == 0 && written;
+    written = std::fclose(file) == 0 && written;
+
+    if (!written)
+    {
+        std::remove(tempPath.c_str());
+        DebugConfig::warning("[Vulkan] Failed to write pipeline cache %s", tempPath.c_str());
+        return false;
+    }
+
+#ifdef _WIN32
+    // rename() does not replace existing files on Windows
+    std::remove(path.c_str());
+#endif
+    if (std::rename(tempPath.c_str(), path.c_str()) != 0)
+    {
+        std::remove(tempPath.c_str());
+        DebugConfig::warning("[Vulkan] Failed to replace pipeline cache %s", path.c_str());
+        return false;
+    }
+    return true;
+}
+
+uint64_t PipelineCacheFile::hash(const char* data, size_t size)
+{
+    // FNV-1a
+    uint64_t result = 0xcbf29ce484222325ull;
+    for (size_t i = 0; i < size; i++)
+    {
+        result ^= static_cast<uint8_t>(data[i]);
+        result *= 0x100000001b3ull;
+    }
+    return result;
+}
+
+bool PipelineCacheFile::isBlobCompatible(const std::vector<char>& data, const VkPhysicalDeviceProperties& properties)
+{
+    // Same checks the driver does on the VkPipelineCacheHeaderVersionOne prefix of the blob
+    VkPipelineCacheHeaderVersionOne blobHeader = {};
+    if (data.size() < sizeof(blobHeader))
+        return false;
+    std::memcpy(&blobHeader, data.data(), sizeof(blobHeader));
+
+    return blobHeader.headerSize >= sizeof(blobHeader) &&
+        blobHeader.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+        blobHeader.vendorID == properties.vendorID &&
+        blobHeader.deviceID == properties.deviceID &&
+        std::memcmp(blobHeader.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
@@ -0,0 +1,45 @@
+//
+// Created by Batur on 18/10/2026.
+//
+
+#ifndef PIPELINECACHEFILE_H
+#define PIPELINECACHEFILE_H
+
+#include <string>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+// On-disk container for VkPipelineCache blobs.
+// The blob is prefixed with our own versioned header so that data produced by a different
+// driver, device or build is discarded instead of being handed back to the driver.
+class PipelineCacheFile
+{
+public:
+    static constexpr uint32_t MAGIC = 0x434C5053; // "SPLC"
+    static constexpr uint32_t VERSION = 1;
+
+    struct Header
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t headerSize;
+        uint32_t vendorID;
+        uint32_t deviceID;
+        uint32_t driverVersion;
+        uint8_t pipelineCacheUUID[VK_UUID_SIZE];
+        uint64_t dataSize;
+        uint64_t dataHash;
+    };
+
+    // Returns an empty vector when the file is missing, corrupted or belongs to another device/driver.
+    static std::vector<char> read(const std::string& path, const VkPhysicalDeviceProperties& properties);
+    // Writes to a temporary file and renames it over `path`, so a crash never leaves a truncated cache.
+    static bool write(const std::string& path, const VkPhysicalDeviceProperties& properties,
+                      const std::vector<char>& data);
+
+private:
+    static uint64_t hash(const char* data, size_t size);
+    static bool isBlobCompatible(const std::vector<char>& data, const VkPhysicalDeviceProperties& properties);
+};
+
+#endif //PIPELINECACHEFILE_H
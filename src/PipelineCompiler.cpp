@@ -0,0 +1,334 @@
+//
+// Created by Batur on 18/10/2026.
+//
+
+#include "PipelineCompiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+
+#include "DebugConfig.h"
+#include "VulkanRenderer.h"
+
+namespace
+{
+    // Every member of the Vulkan structs appended here is a 32-bit value, so they carry no padding
+    template <typename T>
+    void append(std::string& key, const T& value)
+    {
+        key.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    void append(std::string& key, const std::string& value)
+    {
+        append(key, static_cast<uint32_t>(value.size()));
+        key.append(value);
+    }
+
+    void append(std::string& key, const ShaderStageDesc& stage)
+    {
+        append(key, stage.stage);
+        append(key, stage.module);
+        append(key, stage.entryPoint);
+    }
+
+    // Declared after the element overloads, which lookup inside the template has to see
+    template <typename T>
+    void append(std::string& key, const std::vector<T>& values)
+    {
+        append(key, static_cast<uint32_t>(values.size()));
+        for (const T& value : values)
+            append(key, value);
+    }
+
+    std::string getKey(const GraphicsPipelineDesc& desc)
+    {
+        std::string key = "G";
+        append(key, desc.stages);
+        append(key, desc.vertexBindings);
+        append(key, desc.vertexAttributes);
+        append(key, desc.topology);
+        append(key, desc.polygonMode);
+        append(key, desc.cullMode);
+        append(key, desc.frontFace);
+        append(key, desc.depthTest);
+        append(key, desc.depthWrite);
+        append(key, desc.depthCompare);
+        append(key, desc.blendAttachments);
+        append(key, desc.dynamicStates);
+        append(key, desc.layout);
+        append(key, desc.colorFormats);
+        append(key, desc.depthFormat);
+        append(key, desc.stencilFormat);
+        return key;
+    }
+
+    std::string getKey(const ComputePipelineDesc& desc)
+    {
+        std::string key = "C";
+        append(key, desc.stage);
+        append(key, desc.layout);
+        return key;
+    }
+
+    VkPipelineShaderStageCreateInfo getStageInfo(const ShaderStageDesc& stage)
+    {
+        VkPipelineShaderStageCreateInfo stageInfo = {};
+        stageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        stageInfo.stage = stage.stage;
+        stageInfo.module = stage.module;
+        stageInfo.pName = stage.entryPoint.c_str();
+        return stageInfo;
+    }
+
+    VkPipeline compileGraphics(VkDevice device, VkPipelineCache cache, const VkAllocationCallbacks* allocator,
+                               const GraphicsPipelineDesc& desc)
+    {
+        std::vector<VkPipelineShaderStageCreateInfo> stages;
+        for (const ShaderStageDesc& stage : desc.stages)
+            stages.push_back(getStageInfo(stage));
+
+        VkPipelineVertexInputStateCreateInfo vertexInput = {};
+        vertexInput.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+        vertexInput.vertexBindingDescriptionCount = static_cast<uint32_t>(desc.vertexBindings.size());
+        vertexInput.pVertexBindingDescriptions = desc.vertexBindings.data();
+        vertexInput.vertexAttributeDescriptionCount = static_cast<uint32_t>(desc.vertexAttributes.size());
+        vertexInput.pVertexAttributeDescriptions = desc.vertexAttributes.data();
+
+        VkPipelineInputAssemblyStateCreateInfo inputAssembly = {};
+        inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+        inputAssembly.topology = desc.topology;
+
+        VkPipelineViewportStateCreateInfo viewportState = {};
+        viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+        viewportState.viewportCount = 1;
+        viewportState.scissorCount = 1;
+
+        VkPipelineRasterizationStateCreateInfo rasterization = {};
+        rasterization.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+        rasterization.polygonMode = desc.polygonMode;
+        rasterization.cullMode = desc.cullMode;
+        rasterization.frontFace = desc.frontFace;
+        rasterization.lineWidth = 1.0f;
+
+        VkPipelineMultisampleStateCreateInfo multisample = {};
+        multisample.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+        multisample.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+        VkPipelineDepthStencilStateCreateInfo depthStencil = {};
+        depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+        depthStencil.depthTestEnable = desc.depthTest ? VK_TRUE : VK_FALSE;
+        depthStencil.depthWriteEnable = desc.depthWrite ? VK_TRUE : VK_FALSE;
+        depthStencil.depthCompareOp = desc.depthCompare;
+
+        VkPipelineColorBlendStateCreateInfo colorBlend = {};
+        colorBlend.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+        colorBlend.attachmentCount = static_cast<uint32_t>(desc.blendAttachments.size());
+        colorBlend.pAttachments = desc.blendAttachments.data();
+
+        VkPipelineDynamicStateCreateInfo dynamicState = {};
+        dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+        dynamicState.dynamicStateCount = static_cast<uint32_t>(desc.dynamicStates.size());
+        dynamicState.pDynamicStates = desc.dynamicStates.data();
+
+        VkPipelineRenderingCreateInfo renderingInfo = {};
+        renderingInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO;
+        renderingInfo.colorAttachmentCount = static_cast<uint32_t>(desc.colorFormats.size());
+        renderingInfo.pColorAttachmentFormats = desc.colorFormats.data();
+        renderingInfo.depthAttachmentFormat = desc.depthFormat;
+        renderingInfo.stencilAttachmentFormat = desc.stencilFormat;
+
+        VkGraphicsPipelineCreateInfo pipelineInfo = {};
+        pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+        pipelineInfo.pNext = &renderingInfo;
+        pipelineInfo.stageCount = static_cast<uint32_t>(stages.size());
+        pipelineInfo.pStages = stages.data();
+        pipelineInfo.pVertexInputState = &vertexInput;
+        pipelineInfo.pInputAssemblyState = &inputAssembly;
+        pipelineInfo.pViewportState = &viewportState;
+        pipelineInfo.pRasterizationState = &rasterization;
+        pipelineInfo.pMultisampleState = &multisample;
+        pipelineInfo.pDepthStencilState = &depthStencil;
+        pipelineInfo.pColorBlendState = &colorBlend;
+        pipelineInfo.pDynamicState = &dynamicState;
+        pipelineInfo.layout = desc.layout;
+        VkPipeline pipeline = VK_NULL_HANDLE;
+        if (vkCreateGraphicsPipelines(device, cache, 1, &pipelineInfo, allocator, &pipeline) != VK_SUCCESS)
+            return VK_NULL_HANDLE;
+        return pipeline;
+    }
+
+    VkPipeline compileCompute(VkDevice device, VkPipelineCache cache, const VkAllocationCallbacks* allocator,
+                              const ComputePipelineDesc& desc)
+    {
+        VkComputePipelineCreateInfo pipelineInfo = {};
+        pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        pipelineInfo.stage = getStageInfo(desc.stage);
+        pipelineInfo.layout = desc.layout;
+        VkPipeline pipeline = VK_NULL_HANDLE;
+        if (vkCreateComputePipelines(device, cache, 1, &pipelineInfo, allocator, &pipeline) != VK_SUCCESS)
+            return VK_NULL_HANDLE;
+        return pipeline;
+    }
+}
+
+void PipelineCompiler::init(VulkanRenderer& vulkanRenderer)
+{
+    renderer = &vulkanRenderer;
+    device = renderer->getDevice();
+    allocator = renderer->getAllocator();
+    for (uint32_t i = 0; i < renderer->getJobSystem().getThreadCount(); i++)
+        threadCaches.push_back(renderer->createThreadPipelineCache());
+}
+
+void PipelineCompiler::destroy()
+{
+    if (!renderer)
+        return;
+    // Jobs still reference the entries
+    for (size_t i = 0; i < entries.size(); i++)
+        getEntry(static_cast<PipelineHandle>(i + 1)).future.wait();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const Entry& entry : entries)
+        if (entry.pipeline != VK_NULL_HANDLE)
+            vkDestroyPipeline(device, entry.pipeline, allocator);
+    entries.clear();
+    handles.clear();
+    for (VkPipelineCache cache : threadCaches)
+        renderer->releaseThreadPipelineCache(cache);
+    threadCaches.clear();
+    renderer = nullptr;
+}
+
+PipelineHandle PipelineCompiler::requestGraphics(const GraphicsPipelineDesc& desc, PipelineHandle fallback)
+{
+    std::shared_ptr<std::promise<VkPipeline>> promise;
+    const PipelineHandle handle = reserve(getKey(desc), fallback, promise);
+    if (!promise)
+        return handle;
+
+    // The job owns a copy of the state
+    renderer->getJobSystem().enqueue([this, desc, handle, promise](uint32_t thread)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        const VkPipeline pipeline = compileGraphics(device, threadCaches[thread], allocator, desc);
+        const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        finish(handle, pipeline, elapsed.count());
+        promise->set_value(pipeline);
+    });
+    return handle;
+}
+
+PipelineHandle PipelineCompiler::requestCompute(const ComputePipelineDesc& desc, PipelineHandle fallback)
+{
+    std::shared_ptr<std::promise<VkPipeline>> promise;
+    const PipelineHandle handle = reserve(getKey(desc), fallback, promise);
+    if (!promise)
+        return handle;
+
+    renderer->getJobSystem().enqueue([this, desc, handle, promise](uint32_t thread)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        const VkPipeline pipeline = compileCompute(device, threadCaches[thread], allocator, desc);
+        const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        finish(handle, pipeline, elapsed.count());
+        promise->set_value(pipeline);
+    });
+    return handle;
+}
+
+VkPipeline PipelineCompiler::get(PipelineHandle handle) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    // Fallbacks are always requested before the pipelines using them, so the chain ends
+    while (handle != 0)
+    {
+        const Entry& entry = entries[handle - 1];
+        if (entry.ready && entry.pipeline != VK_NULL_HANDLE)
+            return entry.pipeline;
+        handle = entry.fallback;
+    }
+    return VK_NULL_HANDLE;
+}
+
+bool PipelineCompiler::isReady(PipelineHandle handle) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return handle != 0 && entries[handle - 1].ready;
+}
+
+VkPipeline PipelineCompiler::wait(PipelineHandle handle) const
+{
+    if (handle == 0)
+        return VK_NULL_HANDLE;
+    return getFuture(handle).get();
+}
+
+std::shared_future<VkPipeline> PipelineCompiler::getFuture(PipelineHandle handle) const
+{
+    return getEntry(handle).future;
+}
+
+PipelineCompiler::Statistics PipelineCompiler::getStatistics() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return statistics;
+}
+
+PipelineHandle PipelineCompiler::reserve(const std::string& key, PipelineHandle fallback,
+                                         std::shared_ptr<std::promise<VkPipeline>>& promise)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    statistics.requestCount++;
+    const auto it = handles.find(key);
+    if (it != handles.end())
+    {
+        statistics.deduplicatedCount++;
+        return it->second;
+    }
+    if (fallback > entries.size())
+    {
+        throw std::runtime_error("[Vulkan] Unknown fallback pipeline!");
+    }
+    // The future exists before the handle is visible to anyone else
+    promise = std::make_shared<std::promise<VkPipeline>>();
+    entries.emplace_back();
+    entries.back().future = promise->get_future().share();
+    entries.back().fallback = fallback;
+    const PipelineHandle handle = static_cast<PipelineHandle>(entries.size());
+    handles.emplace(key, handle);
+    statistics.pendingCount++;
+    return handle;
+}
+
+void PipelineCompiler::finish(PipelineHandle handle, VkPipeline pipeline, double milliseconds)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    Entry& entry = entries[handle - 1];
+    entry.pipeline = pipeline;
+    entry.ready = true;
+    statistics.pendingCount--;
+    statistics.compileMs += milliseconds;
+    statistics.maxCompileMs = std::max(statistics.maxCompileMs, milliseconds);
+    if (pipeline == VK_NULL_HANDLE)
+    {
+        statistics.failedCount++;
+        DebugConfig::warning("[Vulkan] Pipeline %u failed to compile", handle);
+        return;
+    }
+    statistics.compiledCount++;
+    DebugConfig::verbose("[Vulkan] Pipeline %u compiled in %.3f ms", handle, milliseconds);
+}
+
+const PipelineCompiler::Entry& PipelineCompiler::getEntry(PipelineHandle handle) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (handle == 0 || handle > entries.size())
+    {
+        throw std::runtime_error("[Vulkan] Unknown pipeline handle!");
+    }
+    return entries[handle - 1];
+}
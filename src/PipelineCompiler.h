@@ -0,0 +1,123 @@
+//
+// Created by Batur on 18/10/2026.
+//
+
+#ifndef PIPELINECOMPILER_H
+#define PIPELINECOMPILER_H
+
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+class VulkanRenderer;
+
+// Index of a pipeline in the compiler, 0 is no pipeline
+using PipelineHandle = uint32_t;
+
+struct ShaderStageDesc
+{
+    VkShaderStageFlagBits stage;
+    // Must stay valid until the pipeline is ready
+    VkShaderModule module;
+    std::string entryPoint = "main";
+};
+
+// Everything a graphics pipeline is built from, owned by value so a request can outlive the caller's state
+struct GraphicsPipelineDesc
+{
+    std::vector<ShaderStageDesc> stages;
+    std::vector<VkVertexInputBindingDescription> vertexBindings;
+    std::vector<VkVertexInputAttributeDescription> vertexAttributes;
+    VkPrimitiveTopology topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+    VkPolygonMode polygonMode = VK_POLYGON_MODE_FILL;
+    VkCullModeFlags cullMode = VK_CULL_MODE_NONE;
+    VkFrontFace frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+    bool depthTest = false;
+    bool depthWrite = false;
+    VkCompareOp depthCompare = VK_COMPARE_OP_LESS_OR_EQUAL;
+    // One per color attachment
+    std::vector<VkPipelineColorBlendAttachmentState> blendAttachments;
+    std::vector<VkDynamicState> dynamicStates = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+    VkPipelineLayout layout = VK_NULL_HANDLE;
+    // Attachment formats of the dynamic rendering the pipeline is used in, one color format per blend attachment
+    std::vector<VkFormat> colorFormats;
+    VkFormat depthFormat = VK_FORMAT_UNDEFINED;
+    VkFormat stencilFormat = VK_FORMAT_UNDEFINED;
+};
+
+struct ComputePipelineDesc
+{
+    ShaderStageDesc stage;
+    VkPipelineLayout layout = VK_NULL_HANDLE;
+};
+
+// Builds pipelines on the job system, each worker against its own pipeline cache so compilations don't contend
+// on the driver's cache lock. The caches are merged back into the renderer's one when the compiler is destroyed.
+// A request returns a handle right away, identical requests share one pipeline and one compilation. Until the
+// pipeline is ready get() returns the fallback's, so a draw can go on with a simpler pipeline instead of
+// stalling the frame. Pipelines live as long as the compiler. Thread safe.
+class PipelineCompiler
+{
+public:
+    struct Statistics
+    {
+        uint32_t requestCount;
+        // Requests answered by an existing pipeline
+        uint32_t deduplicatedCount;
+        uint32_t compiledCount;
+        uint32_t failedCount;
+        uint32_t pendingCount;
+        double compileMs;
+        double maxCompileMs;
+    };
+
+    void init(VulkanRenderer& renderer);
+    // Waits for the compilations still running
+    void destroy();
+
+    // A fallback that is still compiling itself falls back further
+    PipelineHandle requestGraphics(const GraphicsPipelineDesc& desc, PipelineHandle fallback = 0);
+    PipelineHandle requestCompute(const ComputePipelineDesc& desc, PipelineHandle fallback = 0);
+
+    // Never blocks: the pipeline, the fallback's while it compiles, VK_NULL_HANDLE when neither is ready
+    VkPipeline get(PipelineHandle handle) const;
+    bool isReady(PipelineHandle handle) const;
+    // Blocks until the compilation finished, VK_NULL_HANDLE if it failed
+    VkPipeline wait(PipelineHandle handle) const;
+    std::shared_future<VkPipeline> getFuture(PipelineHandle handle) const;
+    Statistics getStatistics() const;
+
+private:
+    struct Entry
+    {
+        std::shared_future<VkPipeline> future;
+        PipelineHandle fallback = 0;
+        VkPipeline pipeline = VK_NULL_HANDLE;
+        bool ready = false;
+    };
+
+    VulkanRenderer* renderer = nullptr;
+    VkDevice device = VK_NULL_HANDLE;
+    const VkAllocationCallbacks* allocator = nullptr;
+    mutable std::mutex mutex;
+    // Indexed by the job system thread
+    std::vector<VkPipelineCache> threadCaches;
+
+    // Handle - 1 indexes the entries, the key is the serialized create state
+    std::deque<Entry> entries;
+    std::unordered_map<std::string, PipelineHandle> handles;
+    Statistics statistics = {};
+
+    // Returns the existing handle for the key, or a new one together with the promise its job has to fulfill
+    PipelineHandle reserve(const std::string& key, PipelineHandle fallback,
+                           std::shared_ptr<std::promise<VkPipeline>>& promise);
+    void finish(PipelineHandle handle, VkPipeline pipeline, double milliseconds);
+    const Entry& getEntry(PipelineHandle handle) const;
+};
+
+#endif //PIPELINECOMPILER_H
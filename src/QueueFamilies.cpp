@@ -0,0 +1,243 @@
+//
+// Created by Batur on 18/10/2026.
+//
+
+#include "QueueFamilies.h"
+
+#include <stdexcept>
+
+namespace
+{
+    constexpr uint32_t NO_FAMILY = UINT32_MAX;
+
+    VkBufferMemoryBarrier makeBufferBarrier(VkBuffer buffer, VkAccessFlags srcAccess, VkAccessFlags dstAccess,
+                                            uint32_t srcFamily, uint32_t dstFamily)
+    {
+        VkBufferMemoryBarrier barrier = {};
+        barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        barrier.srcAccessMask = srcAccess;
+        barrier.dstAccessMask = dstAccess;
+        barrier.srcQueueFamilyIndex = srcFamily;
+        barrier.dstQueueFamilyIndex = dstFamily;
+        barrier.buffer = buffer;
+        barrier.offset = 0;
+        barrier.size = VK_WHOLE_SIZE;
+        return barrier;
+    }
+
+    VkImageMemoryBarrier makeImageBarrier(VkImage image, const VkImageSubresourceRange& range,
+                                          VkImageLayout oldLayout, VkImageLayout newLayout,
+                                          VkAccessFlags srcAccess, VkAccessFlags dstAccess,
+                                          uint32_t srcFamily, uint32_t dstFamily)
+    {
+        VkImageMemoryBarrier barrier = {};
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.srcAccessMask = srcAccess;
+        barrier.dstAccessMask = dstAccess;
+        barrier.oldLayout = oldLayout;
+        barrier.newLayout = newLayout;
+        barrier.srcQueueFamilyIndex = srcFamily;
+        barrier.dstQueueFamilyIndex = dstFamily;
+        barrier.image = image;
+        barrier.subresourceRange = range;
+        return barrier;
+    }
+}
+
+QueueFamilies QueueFamilies::find(VkPhysicalDevice physicalDevice, VkSurfaceKHR surface)
+{
+    uint32_t familyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &familyCount, nullptr);
+    std::vector<VkQueueFamilyProperties> properties(familyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &familyCount, properties.data());
+
+    uint32_t graphics = NO_FAMILY;
+    uint32_t compute = NO_FAMILY;
+    uint32_t transfer = NO_FAMILY;
+    for (uint32_t i = 0; i < familyCount; i++)
+    {
+        const VkQueueFlags flags = properties[i].queueFlags;
+        if (flags & VK_QUEUE_GRAPHICS_BIT)
+        {
+            // A graphics family without compute or presentation is legal but rare, keep looking for a universal one
+            if (graphics == NO_FAMILY)
+            {
+                graphics = i;
+                continue;
+            }
+            const bool present = canPresent(physicalDevice, i, surface);
+            const bool currentPresent = canPresent(physicalDevice, graphics, surface);
+            const bool hasCompute = (flags & VK_QUEUE_COMPUTE_BIT) != 0;
+            const bool currentHasCompute = (properties[graphics].queueFlags & VK_QUEUE_COMPUTE_BIT) != 0;
+            if ((present && !currentPresent) || (present == currentPresent && hasCompute && !currentHasCompute))
+                graphics = i;
+        }
+        else if (flags & VK_QUEUE_COMPUTE_BIT)
+        {
+            if (compute == NO_FAMILY)
+                compute = i;
+        }
+        else if (flags & VK_QUEUE_TRANSFER_BIT)
+        {
+            if (transfer == NO_FAMILY)
+                transfer = i;
+        }
+    }
+    if (graphics == NO_FAMILY)
+    {
+        throw std::runtime_error("[Vulkan] Failed to find any graphics queue families!");
+    }
+    // Graphics and compute families support transfers implicitly
+    if (compute == NO_FAMILY)
+        compute = graphics;
+    if (transfer == NO_FAMILY)
+        transfer = compute;
+
+    // Hand out distinct queues while the family has them, then share the last one
+    std::vector<uint32_t> used(familyCount, 0);
+    const auto takeQueue = [&](uint32_t family) -> uint32_t
+    {
+        if (used[family] < properties[family].queueCount)
+            return used[family]++;
+        return used[family] - 1;
+    };
+
+    QueueFamilies families = {};
+    families.family[static_cast<uint32_t>(QueueType::Graphics)] = graphics;
+    families.index[static_cast<uint32_t>(QueueType::Graphics)] = takeQueue(graphics);
+    families.family[static_cast<uint32_t>(QueueType::Compute)] = compute;
+    families.index[static_cast<uint32_t>(QueueType::Compute)] = takeQueue(compute);
+    families.family[static_cast<uint32_t>(QueueType::Transfer)] = transfer;
+    families.index[static_cast<uint32_t>(QueueType::Transfer)] = takeQueue(transfer);
+    return families;
+}
+
+bool QueueFamilies::canPresent(VkPhysicalDevice physicalDevice, uint32_t family, VkSurfaceKHR surface)
+{
+    if (surface == VK_NULL_HANDLE)
+        return true;
+    VkBool32 supported = VK_FALSE;
+    vkGetPhysicalDeviceSurfaceSupportKHR(physicalDevice, family, surface, &supported);
+    return supported == VK_TRUE;
+}
+
+bool QueueFamilies::isDedicated(QueueType type) const
+{
+    const uint32_t graphics = static_cast<uint32_t>(QueueType::Graphics);
+    const uint32_t t = static_cast<uint32_t>(type);
+    return type == QueueType::Graphics || family[t] != family[graphics] || index[t] != index[graphics];
+}
+
+std::vector<VkDeviceQueueCreateInfo> QueueFamilies::getCreateInfos(std::vector<float>& priorities) const
+{
+    struct FamilyQueues
+    {
+        uint32_t family;
+        uint32_t count;
+    };
+    std::vector<FamilyQueues> requested;
+    for (uint32_t t = 0; t < QUEUE_TYPE_COUNT; t++)
+    {
+        bool found = false;
+        for (FamilyQueues& queues : requested)
+        {
+            if (queues.family == family[t])
+            {
+                queues.count = queues.count > index[t] + 1 ? queues.count : index[t] + 1;
+                found = true;
+            }
+        }
+        if (!found)
+            requested.push_back({family[t], index[t] + 1});
+    }
+
+    uint32_t total = 0;
+    for (const FamilyQueues& queues : requested)
+        total += queues.count;
+    priorities.assign(total, 0.5f);
+
+    std::vector<VkDeviceQueueCreateInfo> createInfos;
+    uint32_t first = 0;
+    for (const FamilyQueues& queues : requested)
+    {
+        // The graphics queue drives presentation, give it the highest priority
+        if (queues.family == family[static_cast<uint32_t>(QueueType::Graphics)])
+            priorities[first + index[static_cast<uint32_t>(QueueType::Graphics)]] = 1.0f;
+
+        VkDeviceQueueCreateInfo queueInfo = {};
+        queueInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+        queueInfo.queueFamilyIndex = queues.family;
+        queueInfo.queueCount = queues.count;
+        queueInfo.pQueuePriorities = priorities.data() + first;
+        createInfos.push_back(queueInfo);
+        first += queues.count;
+    }
+    return createInfos;
+}
+
+const char* QueueFamilies::getName(QueueType type)
+{
+    switch (type)
+    {
+    case QueueType::Graphics:
+        return "graphics";
+    case QueueType::Compute:
+        return "compute";
+    case QueueType::Transfer:
+        return "transfer";
+    }
+    return "unknown";
+}
+
+void QueueOwnershipTransfer::releaseBuffer(VkCommandBuffer commandBuffer, VkBuffer buffer) const
+{
+    if (srcFamily == dstFamily)
+    {
+        const VkBufferMemoryBarrier barrier = makeBufferBarrier(buffer, srcAccess, dstAccess,
+                                                                VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED);
+        vkCmdPipelineBarrier(commandBuffer, srcStage, dstStage, 0, 0, nullptr, 1, &barrier, 0, nullptr);
+        return;
+    }
+    const VkBufferMemoryBarrier barrier = makeBufferBarrier(buffer, srcAccess, 0, srcFamily, dstFamily);
+    vkCmdPipelineBarrier(commandBuffer, srcStage, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 1, &barrier, 0,
+                         nullptr);
+}
+
+void QueueOwnershipTransfer::acquireBuffer(VkCommandBuffer commandBuffer, VkBuffer buffer) const
+{
+    if (srcFamily == dstFamily)
+        return;
+    const VkBufferMemoryBarrier barrier = makeBufferBarrier(buffer, 0, dstAccess, srcFamily, dstFamily);
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, dstStage, 0, 0, nullptr, 1, &barrier, 0,
+                         nullptr);
+}
+
+void QueueOwnershipTransfer::releaseImage(VkCommandBuffer commandBuffer, VkImage image,
+                                          const VkImageSubresourceRange& range, VkImageLayout oldLayout,
+                                          VkImageLayout newLayout) const
+{
+    if (srcFamily == dstFamily)
+    {
+        const VkImageMemoryBarrier barrier = makeImageBarrier(image, range, oldLayout, newLayout, srcAccess, dstAccess,
+                                                              VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED);
+        vkCmdPipelineBarrier(commandBuffer, srcStage, dstStage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+        return;
+    }
+    const VkImageMemoryBarrier barrier = makeImageBarrier(image, range, oldLayout, newLayout, srcAccess, 0,
+                                                          srcFamily, dstFamily);
+    vkCmdPipelineBarrier(commandBuffer, srcStage, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1,
+                         &barrier);
+}
+
+void QueueOwnershipTransfer::acquireImage(VkCommandBuffer commandBuffer, VkImage image,
+                                          const VkImageSubresourceRange& range, VkImageLayout oldLayout,
+                                          VkImageLayout newLayout) const
+{
+    if (srcFamily == dstFamily)
+        return;
+    // Layouts must match the release exactly, the transition itself happens once between the two
+    const VkImageMemoryBarrier barrier = makeImageBarrier(image, range, oldLayout, newLayout, 0, dstAccess,
+                                                          srcFamily, dstFamily);
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, dstStage, 0, 0, nullptr, 0, nullptr, 1,
+                         &barrier);
+}
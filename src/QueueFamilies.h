@@ -0,0 +1,58 @@
+//
+// Created by Batur on 18/10/2026.
+//
+
+#ifndef QUEUEFAMILIES_H
+#define QUEUEFAMILIES_H
+
+#include <vector>
+#include <vulkan/vulkan.h>
+
+enum class QueueType : uint32_t
+{
+    Graphics = 0,
+    Compute,
+    Transfer
+};
+
+constexpr uint32_t QUEUE_TYPE_COUNT = 3;
+
+// Which family/queue index serves every QueueType.
+// Compute and transfer prefer dedicated families (async compute, DMA engines) and fall back to
+// extra queues of the graphics family, or the graphics queue itself when nothing else exists.
+struct QueueFamilies
+{
+    uint32_t family[QUEUE_TYPE_COUNT];
+    uint32_t index[QUEUE_TYPE_COUNT];
+
+    // With a surface, the graphics family is preferably one that can present to it
+    static QueueFamilies find(VkPhysicalDevice physicalDevice, VkSurfaceKHR surface = VK_NULL_HANDLE);
+    static bool canPresent(VkPhysicalDevice physicalDevice, uint32_t family, VkSurfaceKHR surface);
+
+    bool isDedicated(QueueType type) const;
+    // One entry per family in use, priorities must outlive the returned infos
+    std::vector<VkDeviceQueueCreateInfo> getCreateInfos(std::vector<float>& priorities) const;
+    static const char* getName(QueueType type);
+};
+
+// Queue family ownership transfer of an exclusive resource.
+// The release is recorded on the source queue, the acquire on the destination queue, and the two
+// submissions must be ordered with a semaphore. Within one family only a regular barrier is recorded.
+struct QueueOwnershipTransfer
+{
+    uint32_t srcFamily;
+    uint32_t dstFamily;
+    VkPipelineStageFlags srcStage;
+    VkAccessFlags srcAccess;
+    VkPipelineStageFlags dstStage;
+    VkAccessFlags dstAccess;
+
+    void releaseBuffer(VkCommandBuffer commandBuffer, VkBuffer buffer) const;
+    void acquireBuffer(VkCommandBuffer commandBuffer, VkBuffer buffer) const;
+    void releaseImage(VkCommandBuffer commandBuffer, VkImage image, const VkImageSubresourceRange& range,
+                      VkImageLayout oldLayout, VkImageLayout newLayout) const;
+    void acquireImage(VkCommandBuffer commandBuffer, VkImage image, const VkImageSubresourceRange& range,
+                      VkImageLayout oldLayout, VkImageLayout newLayout) const;
+};
+
+#endif //QUEUEFAMILIES_H
@@ -0,0 +1,689 @@
+//
+// Created by Batur on 18/10/2026.
+//
+
+#include "RenderGraph.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "DebugConfig.h"
+#include "GpuProfiler.h"
+#include "VulkanRenderer.h"
+
+namespace
+{
+    constexpr VkAccessFlags2 WRITE_ACCESS = VK_ACCESS_2_SHADER_WRITE_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT |
+        VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT |
+        VK_ACCESS_2_TRANSFER_WRITE_BIT | VK_ACCESS_2_HOST_WRITE_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT;
+
+    VkImageUsageFlags getImageUsage(VkAccessFlags2 access, VkImageLayout layout)
+    {
+        VkImageUsageFlags usage = 0;
+        if (access & (VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT))
+            usage |= VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+        if (access & (VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT))
+            usage |= VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+        if (access & VK_ACCESS_2_INPUT_ATTACHMENT_READ_BIT)
+            usage |= VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT;
+        if (access & VK_ACCESS_2_SHADER_SAMPLED_READ_BIT)
+            usage |= VK_IMAGE_USAGE_SAMPLED_BIT;
+        if (access & (VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT |
+            VK_ACCESS_2_SHADER_WRITE_BIT))
+            usage |= VK_IMAGE_USAGE_STORAGE_BIT;
+        // Generic shader reads are storage reads in GENERAL, sampling otherwise
+        if (access & VK_ACCESS_2_SHADER_READ_BIT)
+            usage |= layout == VK_IMAGE_LAYOUT_GENERAL ? VK_IMAGE_USAGE_STORAGE_BIT : VK_IMAGE_USAGE_SAMPLED_BIT;
+        if (access & VK_ACCESS_2_TRANSFER_READ_BIT)
+            usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+        if (access & VK_ACCESS_2_TRANSFER_WRITE_BIT)
+            usage |= VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+        return usage;
+    }
+
+    VkBufferUsageFlags getBufferUsage(VkAccessFlags2 access)
+    {
+        VkBufferUsageFlags usage = 0;
+        if (access & (VK_ACCESS_2_SHADER_READ_BIT | VK_ACCESS_2_SHADER_WRITE_BIT | VK_ACCESS_2_SHADER_STORAGE_READ_BIT |
+            VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT))
+            usage |= VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+        if (access & VK_ACCESS_2_UNIFORM_READ_BIT)
+            usage |= VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
+        if (access & VK_ACCESS_2_INDEX_READ_BIT)
+            usage |= VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
+        if (access & VK_ACCESS_2_VERTEX_ATTRIBUTE_READ_BIT)
+            usage |= VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+        if (access & VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT)
+            usage |= VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
+        if (access & VK_ACCESS_2_TRANSFER_READ_BIT)
+            usage |= VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+        if (access & VK_ACCESS_2_TRANSFER_WRITE_BIT)
+            usage |= VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+        return usage;
+    }
+
+    VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+}
+
+RenderGraph::PassBuilder::PassBuilder(RenderGraph& renderGraph, uint32_t passIndex)
+    : graph(renderGraph), pass(passIndex)
+{
+}
+
+void RenderGraph::PassBuilder::read(RenderGraphResource image, VkPipelineStageFlags2 stage, VkAccessFlags2 access,
+                                    VkImageLayout layout)
+{
+    graph.addAccess(pass, image, stage, access, layout, true, false);
+}
+
+void RenderGraph::PassBuilder::write(RenderGraphResource image, VkPipelineStageFlags2 stage, VkAccessFlags2 access,
+                                     VkImageLayout layout)
+{
+    graph.addAccess(pass, image, stage, access, layout, false, true);
+}
+
+void RenderGraph::PassBuilder::readBuffer(RenderGraphResource buffer, VkPipelineStageFlags2 stage,
+                                          VkAccessFlags2 access)
+{
+    graph.addAccess(pass, buffer, stage, access, VK_IMAGE_LAYOUT_UNDEFINED, true, false);
+}
+
+void RenderGraph::PassBuilder::writeBuffer(RenderGraphResource buffer, VkPipelineStageFlags2 stage,
+                                           VkAccessFlags2 access)
+{
+    graph.addAccess(pass, buffer, stage, access, VK_IMAGE_LAYOUT_UNDEFINED, false, true);
+}
+
+void RenderGraph::PassBuilder::sampled(RenderGraphResource image, VkPipelineStageFlags2 stage)
+{
+    read(image, stage, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+}
+
+void RenderGraph::PassBuilder::colorAttachment(RenderGraphResource image, bool load)
+{
+    graph.addAccess(pass, image, VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+                    VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT | (load ? VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT : 0),
+                    VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, load, true);
+}
+
+void RenderGraph::PassBuilder::depthAttachment(RenderGraphResource image, bool load)
+{
+    graph.addAccess(pass, image,
+                    VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT,
+                    VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT |
+                    (load ? VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT : 0),
+                    VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, load, true);
+}
+
+void RenderGraph::PassBuilder::transferSource(RenderGraphResource image)
+{
+    read(image, VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_READ_BIT, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+}
+
+void RenderGraph::PassBuilder::transferDestination(RenderGraphResource image)
+{
+    write(image, VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT,
+          VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+}
+
+void RenderGraph::PassBuilder::sideEffects()
+{
+    graph.passes[pass].sideEffects = true;
+}
+
+void RenderGraph::init(VulkanRenderer& vulkanRenderer)
+{
+    renderer = &vulkanRenderer;
+    device = renderer->getDevice();
+    allocator = renderer->getAllocator();
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(renderer->getPhysicalDevice(), &properties);
+    bufferImageGranularity = properties.limits.bufferImageGranularity;
+}
+
+void RenderGraph::destroy()
+{
+    if (!renderer)
+        return;
+    retirePhysicals();
+    destroyRetired(true);
+    signature.clear();
+    resources.clear();
+    passes.clear();
+    renderer = nullptr;
+}
+
+void RenderGraph::reset()
+{
+    destroyRetired(false);
+    resources.clear();
+    passes.clear();
+}
+
+RenderGraphResource RenderGraph::importImage(const char* name, VkImage image, VkImageView imageView,
+                                             const RenderGraphImageInfo& info, const RenderGraphState& initial,
+                                             const RenderGraphState& final)
+{
+    Resource resource;
+    resource.name = name;
+    resource.isImage = true;
+    resource.imported = true;
+    resource.imageInfo = info;
+    resource.image = image;
+    resource.imageView = imageView;
+    resource.final = final;
+    resource.touched = true;
+    resource.layout = initial.layout;
+    resource.writeStages = initial.stage;
+    resource.writeAccess = initial.access;
+    resources.push_back(resource);
+    return static_cast<RenderGraphResource>(resources.size() - 1);
+}
+
+RenderGraphResource RenderGraph::importBuffer(const char* name, VkBuffer buffer, VkDeviceSize size,
+                                              const RenderGraphState& initial, const RenderGraphState& final)
+{
+    Resource resource;
+    resource.name = name;
+    resource.imported = true;
+    resource.size = size;
+    resource.buffer = buffer;
+    resource.final = final;
+    resource.touched = true;
+    resource.writeStages = initial.stage;
+    resource.writeAccess = initial.access;
+    resources.push_back(resource);
+    return static_cast<RenderGraphResource>(resources.size() - 1);
+}
+
+RenderGraphResource RenderGraph::createImage(const char* name, const RenderGraphImageInfo& info)
+{
+    Resource resource;
+    resource.name = name;
+    resource.isImage = true;
+    resource.imageInfo = info;
+    resources.push_back(resource);
+    return static_cast<RenderGraphResource>(resources.size() - 1);
+}
+
+RenderGraphResource RenderGraph::createBuffer(const char* name, VkDeviceSize size)
+{
+    Resource resource;
+    resource.name = name;
+    resource.size = size;
+    resources.push_back(resource);
+    return static_cast<RenderGraphResource>(resources.size() - 1);
+}
+
+void RenderGraph::addPass(const char* name, const SetupCallback& setup, const ExecuteCallback& execute)
+{
+    Pass pass;
+    pass.name = name;
+    pass.execute = execute;
+    passes.push_back(pass);
+    PassBuilder builder(*this, static_cast<uint32_t>(passes.size() - 1));
+    setup(builder);
+}
+
+void RenderGraph::execute(VkCommandBuffer commandBuffer)
+{
+    statistics = {};
+    statistics.passCount = static_cast<uint32_t>(passes.size());
+    cull();
+    computeLifetimes();
+
+    // The shape of the graph decides whether last frame's transients still fit
+    std::vector<uint32_t> transients;
+    std::vector<uint64_t> newSignature;
+    for (uint32_t r = 0; r < resources.size(); r++)
+    {
+        const Resource& resource = resources[r];
+        if (resource.imported || resource.firstPass == UINT32_MAX)
+            continue;
+        transients.push_back(r);
+        newSignature.insert(newSignature.end(), {
+                                resource.isImage, static_cast<uint64_t>(resource.imageInfo.format),
+                                resource.imageInfo.extent.width, resource.imageInfo.extent.height,
+                                resource.imageInfo.aspect, resource.imageUsage, resource.size, resource.bufferUsage,
+                                resource.firstPass, resource.lastPass, resource.usedStages, resource.usedWrites
+                            });
+    }
+    if (newSignature != signature)
+    {
+        retirePhysicals();
+        buildPhysicals(transients);
+        signature.swap(newSignature);
+    }
+    for (uint32_t i = 0; i < transients.size(); i++)
+    {
+        Resource& resource = resources[transients[i]];
+        resource.physical = i;
+        resource.image = physicals[i].image;
+        resource.imageView = physicals[i].imageView;
+        resource.buffer = physicals[i].buffer;
+        statistics.unaliasedBytes += physicals[i].requirements.size;
+    }
+    statistics.transientCount = static_cast<uint32_t>(transients.size());
+    for (const MemoryAllocator::Allocation* heap : heaps)
+        statistics.transientBytes += heap->size;
+
+    for (Pass& pass : passes)
+    {
+        if (!pass.live)
+        {
+            statistics.culledPassCount++;
+            continue;
+        }
+        for (const Access& access : pass.accesses)
+            synchronize(resources[access.resource], access);
+        flushBarriers(commandBuffer);
+        GpuScope scope(renderer->getProfiler(), commandBuffer, pass.name.c_str());
+        pass.execute(commandBuffer);
+    }
+
+    // Imported resources are left the way their owner expects them
+    for (uint32_t r = 0; r < resources.size(); r++)
+    {
+        Resource& resource = resources[r];
+        if (!resource.imported || (resource.isImage && resource.final.layout == VK_IMAGE_LAYOUT_UNDEFINED) ||
+            (!resource.isImage && resource.final.stage == 0))
+            continue;
+        const Access access = {r, resource.final.stage, resource.final.access, resource.final.layout, true, false};
+        synchronize(resource, access);
+    }
+    flushBarriers(commandBuffer);
+}
+
+VkImage RenderGraph::getImage(RenderGraphResource resource) const
+{
+    return resources[resource].image;
+}
+
+VkImageView RenderGraph::getImageView(RenderGraphResource resource) const
+{
+    return resources[resource].imageView;
+}
+
+VkBuffer RenderGraph::getBuffer(RenderGraphResource resource) const
+{
+    return resources[resource].buffer;
+}
+
+const RenderGraph::Statistics& RenderGraph::getStatistics() const
+{
+    return statistics;
+}
+
+void RenderGraph::addAccess(uint32_t pass, RenderGraphResource resource, VkPipelineStageFlags2 stage,
+                            VkAccessFlags2 access, VkImageLayout layout, bool read, bool write)
+{
+    if (resource >= resources.size())
+    {
+        throw std::runtime_error("[Vulkan] Render graph pass " + passes[pass].name + " uses an unknown resource!");
+    }
+    // One barrier per resource and pass, so every declaration on a resource merges into one access
+    for (Access& existing : passes[pass].accesses)
+    {
+        if (existing.resource != resource)
+            continue;
+        if (resources[resource].isImage && existing.layout != layout)
+        {
+            throw std::runtime_error("[Vulkan] Render graph pass " + passes[pass].name + " uses " +
+                resources[resource].name + " in two layouts!");
+        }
+        existing.stage |= stage;
+        existing.access |= access;
+        existing.read = existing.read || read;
+        existing.write = existing.write || write;
+        return;
+    }
+    passes[pass].accesses.push_back({resource, stage, access, layout, read, write});
+}
+
+void RenderGraph::cull()
+{
+    // Walking backwards, a pass lives when it writes something observable or read by a living pass
+    std::vector<bool> needed(resources.size(), false);
+    for (size_t p = passes.size(); p-- > 0;)
+    {
+        Pass& pass = passes[p];
+        pass.live = pass.sideEffects;
+        for (const Access& access : pass.accesses)
+            if (access.write && (resources[access.resource].imported || needed[access.resource]))
+                pass.live = true;
+        if (!pass.live)
+            continue;
+        for (const Access& access : pass.accesses)
+            if (access.read)
+                needed[access.resource] = true;
+    }
+}
+
+void RenderGraph::computeLifetimes()
+{
+    for (uint32_t p = 0; p < passes.size(); p++)
+    {
+        if (!passes[p].live)
+            continue;
+        for (const Access& access : passes[p].accesses)
+        {
+            Resource& resource = resources[access.resource];
+            resource.firstPass = std::min(resource.firstPass, p);
+            resource.lastPass = std::max(resource.lastPass, p);
+            resource.usedStages |= access.stage;
+            resource.usedWrites |= access.access & WRITE_ACCESS;
+            if (resource.isImage)
+                resource.imageUsage |= getImageUsage(access.access, access.layout);
+            else
+                resource.bufferUsage |= getBufferUsage(access.access);
+        }
+    }
+}
+
+void RenderGraph::buildPhysicals(const std::vector<uint32_t>& transients)
+{
+    physicals.resize(transients.size());
+    for (size_t i = 0; i < transients.size(); i++)
+    {
+        const Resource& resource = resources[transients[i]];
+        Physical& physical = physicals[i];
+        if (resource.isImage)
+        {
+            VkImageCreateInfo imageInfo = {};
+            imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+            imageInfo.imageType = VK_IMAGE_TYPE_2D;
+            imageInfo.format = resource.imageInfo.format;
+            imageInfo.extent = {resource.imageInfo.extent.width, resource.imageInfo.extent.height, 1};
+            imageInfo.mipLevels = 1;
+            imageInfo.arrayLayers = 1;
+            imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+            imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+            imageInfo.usage = resource.imageUsage;
+            imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+            imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+            if (vkCreateImage(device, &imageInfo, allocator, &physical.image) != VK_SUCCESS)
+            {
+                throw std::runtime_error("[Vulkan] Failed to create render graph image " + resource.name + "!");
+            }
+            vkGetImageMemoryRequirements(device, physical.image, &physical.requirements);
+        }
+        else
+        {
+            VkBufferCreateInfo bufferInfo = {};
+            bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+            bufferInfo.size = resource.size;
+            bufferInfo.usage = resource.bufferUsage;
+            bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+            if (vkCreateBuffer(device, &bufferInfo, allocator, &physical.buffer) != VK_SUCCESS)
+            {
+                throw std::runtime_error("[Vulkan] Failed to create render graph buffer " + resource.name + "!");
+            }
+            vkGetBufferMemoryRequirements(device, physical.buffer, &physical.requirements);
+        }
+    }
+
+    placeTransients(transients);
+
+    for (size_t i = 0; i < transients.size(); i++)
+    {
+        const Resource& resource = resources[transients[i]];
+        Physical& physical = physicals[i];
+        const MemoryAllocator::Allocation* heap = heaps[physical.heap];
+        if (!resource.isImage)
+        {
+            vkBindBufferMemory(device, physical.buffer, heap->memory, heap->offset + physical.offset);
+            continue;
+        }
+        vkBindImageMemory(device, physical.image, heap->memory, heap->offset + physical.offset);
+
+        VkImageViewCreateInfo viewInfo = {};
+        viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        viewInfo.image = physical.image;
+        viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        viewInfo.format = resource.imageInfo.format;
+        viewInfo.subresourceRange = {resource.imageInfo.aspect, 0, 1, 0, 1};
+        if (vkCreateImageView(device, &viewInfo, allocator, &physical.imageView) != VK_SUCCESS)
+        {
+            throw std::runtime_error("[Vulkan] Failed to create render graph image view " + resource.name + "!");
+        }
+    }
+
+    // Every use of an overlapping range, across frames too, has to be done before a transient starts over
+    for (size_t i = 0; i < transients.size(); i++)
+    {
+        for (size_t j = 0; j < transients.size(); j++)
+        {
+            const Physical& a = physicals[i];
+            const Physical& b = physicals[j];
+            if (a.heap != b.heap || a.offset >= b.offset + b.requirements.size ||
+                b.offset >= a.offset + a.requirements.size)
+                continue;
+            physicals[i].aliasStages |= resources[transients[j]].usedStages;
+            physicals[i].aliasWrites |= resources[transients[j]].usedWrites;
+        }
+    }
+    DebugConfig::verbose("[Vulkan] Render graph transients rebuilt: %zu resources in %zu heaps", transients.size(),
+                         heaps.size());
+}
+
+void RenderGraph::placeTransients(const std::vector<uint32_t>& transients)
+{
+    // Transients only share a heap with ones that accept the same memory types
+    std::vector<uint32_t> order(physicals.size());
+    for (uint32_t i = 0; i < order.size(); i++)
+        order[i] = i;
+    // Biggest first packs tighter
+    std::sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b)
+    {
+        return physicals[a].requirements.size > physicals[b].requirements.size;
+    });
+
+    std::vector<uint32_t> typeBits;
+    std::vector<VkMemoryRequirements> heapRequirements;
+    std::vector<std::vector<uint32_t>> placed;
+    for (uint32_t i : order)
+    {
+        Physical& physical = physicals[i];
+        const auto it = std::find(typeBits.begin(), typeBits.end(), physical.requirements.memoryTypeBits);
+        physical.heap = static_cast<uint32_t>(it - typeBits.begin());
+        if (it == typeBits.end())
+        {
+            typeBits.push_back(physical.requirements.memoryTypeBits);
+            heapRequirements.push_back({0, 1, physical.requirements.memoryTypeBits});
+            placed.emplace_back();
+        }
+
+        // Lowest offset that overlaps no placed transient alive at the same time
+        const Resource& resource = resources[transients[i]];
+        const VkDeviceSize alignment = std::max(physical.requirements.alignment, bufferImageGranularity);
+        VkDeviceSize offset = 0;
+        bool moved = true;
+        while (moved)
+        {
+            moved = false;
+            for (uint32_t other : placed[physical.heap])
+            {
+                const Physical& otherPhysical = physicals[other];
+                const Resource& otherResource = resources[transients[other]];
+                if (resource.lastPass < otherResource.firstPass || otherResource.lastPass < resource.firstPass)
+                    continue;
+                if (offset >= otherPhysical.offset + otherPhysical.requirements.size ||
+                    otherPhysical.offset >= offset + physical.requirements.size)
+                    continue;
+                offset = alignUp(otherPhysical.offset + otherPhysical.requirements.size, alignment);
+                moved = true;
+            }
+        }
+        physical.offset = offset;
+        placed[physical.heap].push_back(i);
+
+        VkMemoryRequirements& heap = heapRequirements[physical.heap];
+        heap.size = std::max(heap.size, offset + physical.requirements.size);
+        heap.alignment = std::max(heap.alignment, alignment);
+    }
+
+    heaps.resize(heapRequirements.size());
+    for (size_t h = 0; h < heaps.size(); h++)
+    {
+        heaps[h] = renderer->getMemoryAllocator().allocate(heapRequirements[h], VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        if (!heaps[h])
+        {
+            throw std::runtime_error("[Vulkan] Failed to allocate render graph memory!");
+        }
+    }
+}
+
+void RenderGraph::retirePhysicals()
+{
+    if (physicals.empty() && heaps.empty())
+        return;
+    // Frames still in flight may use them
+    Retired entry;
+    entry.physicals.swap(physicals);
+    entry.heaps.swap(heaps);
+    entry.frameNumber = renderer->getFrameNumber();
+    retired.push_back(entry);
+    signature.clear();
+}
+
+void RenderGraph::destroyRetired(bool all)
+{
+    const uint64_t frameNumber = renderer->getFrameNumber();
+    for (size_t i = 0; i < retired.size();)
+    {
+        if (!all && retired[i].frameNumber + renderer->getFramesInFlight() > frameNumber)
+        {
+            i++;
+            continue;
+        }
+        for (Physical& physical : retired[i].physicals)
+        {
+            if (physical.imageView != VK_NULL_HANDLE)
+                vkDestroyImageView(device, physical.imageView, allocator);
+            if (physical.image != VK_NULL_HANDLE)
+                vkDestroyImage(device, physical.image, allocator);
+            if (physical.buffer != VK_NULL_HANDLE)
+                vkDestroyBuffer(device, physical.buffer, allocator);
+        }
+        for (MemoryAllocator::Allocation* heap : retired[i].heaps)
+            renderer->getMemoryAllocator().free(heap);
+        retired[i] = retired.back();
+        retired.pop_back();
+    }
+}
+
+void RenderGraph::synchronize(Resource& resource, const Access& access)
+{
+    const bool firstUse = !resource.touched;
+    const bool layoutChange = resource.isImage && (firstUse || resource.layout != access.layout);
+    VkPipelineStageFlags2 srcStage;
+    VkAccessFlags2 srcAccess;
+    bool barrier;
+    if (firstUse)
+    {
+        // The contents are garbage, only earlier users of the memory have to be done
+        srcStage = physicals[resource.physical].aliasStages;
+        srcAccess = physicals[resource.physical].aliasWrites;
+        barrier = resource.isImage || srcStage != 0;
+    }
+    else if (layoutChange || access.write)
+    {
+        // Layout transitions are writes: wait for the last write and every read since
+        srcStage = resource.writeStages | resource.readStages;
+        srcAccess = resource.writeAccess;
+        barrier = layoutChange || srcStage != 0;
+    }
+    else
+    {
+        // Reads only wait for the last write, and only once per stage and access
+        srcStage = resource.writeStages;
+        srcAccess = resource.writeAccess;
+        barrier = srcStage != 0 && ((access.stage & ~resource.visibleStages) != 0 ||
+            (access.access & ~resource.visibleAccess) != 0);
+    }
+
+    if (barrier)
+    {
+        statistics.barrierCount++;
+        if (resource.isImage)
+        {
+            VkImageMemoryBarrier2 imageBarrier = {};
+            imageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+            imageBarrier.srcStageMask = srcStage;
+            imageBarrier.srcAccessMask = srcAccess;
+            imageBarrier.dstStageMask = access.stage;
+            imageBarrier.dstAccessMask = access.access;
+            imageBarrier.oldLayout = firstUse ? VK_IMAGE_LAYOUT_UNDEFINED : resource.layout;
+            imageBarrier.newLayout = access.layout;
+            imageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            imageBarrier.image = resource.image;
+            imageBarrier.subresourceRange = {
+                resource.imageInfo.aspect, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS
+            };
+            imageBarriers.push_back(imageBarrier);
+        }
+        else
+        {
+            VkBufferMemoryBarrier2 bufferBarrier = {};
+            bufferBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2;
+            bufferBarrier.srcStageMask = srcStage;
+            bufferBarrier.srcAccessMask = srcAccess;
+            bufferBarrier.dstStageMask = access.stage;
+            bufferBarrier.dstAccessMask = access.access;
+            bufferBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            bufferBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            bufferBarrier.buffer = resource.buffer;
+            bufferBarrier.size = VK_WHOLE_SIZE;
+            bufferBarriers.push_back(bufferBarrier);
+        }
+    }
+
+    if (access.write)
+    {
+        resource.writeStages = access.stage;
+        resource.writeAccess = access.access & WRITE_ACCESS;
+        resource.readStages = 0;
+        resource.visibleStages = 0;
+        resource.visibleAccess = 0;
+    }
+    else if (layoutChange)
+    {
+        // Earlier writes were made available by this barrier, later ones only have to chain behind it
+        resource.writeStages = access.stage;
+        resource.writeAccess = 0;
+        resource.readStages = access.stage;
+        resource.visibleStages = access.stage;
+        resource.visibleAccess = access.access;
+    }
+    else
+    {
+        resource.readStages |= access.stage;
+        if (barrier)
+        {
+            resource.visibleStages |= access.stage;
+            resource.visibleAccess |= access.access;
+        }
+    }
+    resource.touched = true;
+    resource.layout = access.layout;
+}
+
+void RenderGraph::flushBarriers(VkCommandBuffer commandBuffer)
+{
+    if (imageBarriers.empty() && bufferBarriers.empty())
+        return;
+    VkDependencyInfo dependency = {};
+    dependency.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+    dependency.bufferMemoryBarrierCount = static_cast<uint32_t>(bufferBarriers.size());
+    dependency.pBufferMemoryBarriers = bufferBarriers.data();
+    dependency.imageMemoryBarrierCount = static_cast<uint32_t>(imageBarriers.size());
+    dependency.pImageMemoryBarriers = imageBarriers.data();
+    vkCmdPipelineBarrier2(commandBuffer, &dependency);
+    imageBarriers.clear();
+    bufferBarriers.clear();
+}
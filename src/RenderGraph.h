@@ -0,0 +1,209 @@
+//
+// Created by Batur on 18/10/2026.
+//
+
+#ifndef RENDERGRAPH_H
+#define RENDERGRAPH_H
+
+#include <functional>
+#include <string>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+#include "MemoryAllocator.h"
+
+class VulkanRenderer;
+
+// Index of a resource in the graph, valid until the next reset()
+using RenderGraphResource = uint32_t;
+
+struct RenderGraphImageInfo
+{
+    VkFormat format;
+    VkExtent2D extent;
+    VkImageAspectFlags aspect = VK_IMAGE_ASPECT_COLOR_BIT;
+};
+
+// Where an imported resource was last used, or has to be left
+struct RenderGraphState
+{
+    VkImageLayout layout;
+    VkPipelineStageFlags2 stage;
+    VkAccessFlags2 access;
+};
+
+// Frame graph rebuilt every frame.
+// Passes declare what they read and write, execute() then drops the passes nothing observable depends on,
+// records synchronization2 barriers only where a hazard or a layout change requires one, and places transient
+// resources whose lifetimes do not overlap in the same memory. Imported resources and passes with side effects
+// are what is observable. Passes run in declaration order on the frame command buffer.
+// Transient images and buffers are kept while the graph keeps the same shape, so a steady frame creates nothing.
+class RenderGraph
+{
+public:
+    class PassBuilder
+    {
+    public:
+        void read(RenderGraphResource image, VkPipelineStageFlags2 stage, VkAccessFlags2 access, VkImageLayout layout);
+        void write(RenderGraphResource image, VkPipelineStageFlags2 stage, VkAccessFlags2 access,
+                   VkImageLayout layout);
+        void readBuffer(RenderGraphResource buffer, VkPipelineStageFlags2 stage, VkAccessFlags2 access);
+        void writeBuffer(RenderGraphResource buffer, VkPipelineStageFlags2 stage, VkAccessFlags2 access);
+
+        void sampled(RenderGraphResource image, VkPipelineStageFlags2 stage = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT);
+        // Loading the previous contents makes it a read as well
+        void colorAttachment(RenderGraphResource image, bool load = true);
+        void depthAttachment(RenderGraphResource image, bool load = true);
+        void transferSource(RenderGraphResource image);
+        void transferDestination(RenderGraphResource image);
+        // Never culled, e.g. a readback
+        void sideEffects();
+
+    private:
+        friend class RenderGraph;
+        PassBuilder(RenderGraph& graph, uint32_t pass);
+
+        RenderGraph& graph;
+        uint32_t pass;
+    };
+
+    using SetupCallback = std::function<void(PassBuilder&)>;
+    using ExecuteCallback = std::function<void(VkCommandBuffer)>;
+
+    struct Statistics
+    {
+        uint32_t passCount;
+        uint32_t culledPassCount;
+        uint32_t barrierCount;
+        uint32_t transientCount;
+        // Memory of the transients, with and without aliasing
+        VkDeviceSize transientBytes;
+        VkDeviceSize unaliasedBytes;
+    };
+
+    void init(VulkanRenderer& renderer);
+    void destroy();
+
+    // Starts a new graph, the resources and passes of the previous one are forgotten
+    void reset();
+    RenderGraphResource importImage(const char* name, VkImage image, VkImageView imageView,
+                                    const RenderGraphImageInfo& info, const RenderGraphState& initial,
+                                    const RenderGraphState& final);
+    RenderGraphResource importBuffer(const char* name, VkBuffer buffer, VkDeviceSize size,
+                                     const RenderGraphState& initial, const RenderGraphState& final);
+    // Contents are undefined at the first use in every frame, usage flags follow the declared accesses
+    RenderGraphResource createImage(const char* name, const RenderGraphImageInfo& info);
+    RenderGraphResource createBuffer(const char* name, VkDeviceSize size);
+    void addPass(const char* name, const SetupCallback& setup, const ExecuteCallback& execute);
+
+    // Compiles and records every surviving pass with its barriers, each one as a profiler scope
+    void execute(VkCommandBuffer commandBuffer);
+
+    // Physical handles, for transients only valid inside the execute callbacks
+    VkImage getImage(RenderGraphResource resource) const;
+    VkImageView getImageView(RenderGraphResource resource) const;
+    VkBuffer getBuffer(RenderGraphResource resource) const;
+    const Statistics& getStatistics() const;
+
+private:
+    struct Access
+    {
+        RenderGraphResource resource;
+        VkPipelineStageFlags2 stage;
+        VkAccessFlags2 access;
+        VkImageLayout layout;
+        bool read;
+        bool write;
+    };
+
+    struct Pass
+    {
+        std::string name;
+        std::vector<Access> accesses;
+        ExecuteCallback execute;
+        bool sideEffects = false;
+        bool live = false;
+    };
+
+    struct Resource
+    {
+        std::string name;
+        bool isImage = false;
+        bool imported = false;
+        RenderGraphImageInfo imageInfo = {};
+        VkDeviceSize size = 0;
+        VkImageUsageFlags imageUsage = 0;
+        VkBufferUsageFlags bufferUsage = 0;
+        VkImage image = VK_NULL_HANDLE;
+        VkImageView imageView = VK_NULL_HANDLE;
+        VkBuffer buffer = VK_NULL_HANDLE;
+        RenderGraphState final = {};
+
+        // Lifetime over the live passes, transients only
+        uint32_t firstPass = UINT32_MAX;
+        uint32_t lastPass = 0;
+        uint32_t physical = UINT32_MAX;
+        VkPipelineStageFlags2 usedStages = 0;
+        VkAccessFlags2 usedWrites = 0;
+
+        // Synchronization state while recording
+        bool touched = false;
+        VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+        VkPipelineStageFlags2 writeStages = 0;
+        VkAccessFlags2 writeAccess = 0;
+        VkPipelineStageFlags2 readStages = 0;
+        VkPipelineStageFlags2 visibleStages = 0;
+        VkAccessFlags2 visibleAccess = 0;
+    };
+
+    // A transient's memory and handles, reused while the graph shape does not change
+    struct Physical
+    {
+        VkImage image = VK_NULL_HANDLE;
+        VkImageView imageView = VK_NULL_HANDLE;
+        VkBuffer buffer = VK_NULL_HANDLE;
+        VkMemoryRequirements requirements = {};
+        uint32_t heap = 0;
+        VkDeviceSize offset = 0;
+        // Every use of the memory range by this or an aliasing transient, the first barrier waits on it
+        VkPipelineStageFlags2 aliasStages = 0;
+        VkAccessFlags2 aliasWrites = 0;
+    };
+
+    struct Retired
+    {
+        std::vector<Physical> physicals;
+        std::vector<MemoryAllocator::Allocation*> heaps;
+        uint64_t frameNumber;
+    };
+
+    VulkanRenderer* renderer = nullptr;
+    VkDevice device = VK_NULL_HANDLE;
+    const VkAllocationCallbacks* allocator = nullptr;
+    VkDeviceSize bufferImageGranularity = 1;
+
+    std::vector<Resource> resources;
+    std::vector<Pass> passes;
+
+    std::vector<uint64_t> signature;
+    std::vector<Physical> physicals;
+    std::vector<MemoryAllocator::Allocation*> heaps;
+    std::vector<Retired> retired;
+
+    std::vector<VkImageMemoryBarrier2> imageBarriers;
+    std::vector<VkBufferMemoryBarrier2> bufferBarriers;
+    Statistics statistics = {};
+
+    void addAccess(uint32_t pass, RenderGraphResource resource, VkPipelineStageFlags2 stage, VkAccessFlags2 access,
+                   VkImageLayout layout, bool read, bool write);
+    void cull();
+    void computeLifetimes();
+    void buildPhysicals(const std::vector<uint32_t>& transients);
+    void placeTransients(const std::vector<uint32_t>& transients);
+    void retirePhysicals();
+    void destroyRetired(bool all);
+    void synchronize(Resource& resource, const Access& access);
+    void flushBarriers(VkCommandBuffer commandBuffer);
+};
+
+#endif //RENDERGRAPH_H
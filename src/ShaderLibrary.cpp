@@ -0,0 +1,652 @@
+//
+// Created by Batur on 18/10/2026.
+//
+
+#include "ShaderLibrary.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <set>
+#include <stdexcept>
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include "DebugConfig.h"
+#include "PipelineCacheFile.h"
+#include "VulkanRenderer.h"
+
+namespace
+{
+    constexpr uint32_t SPIRV_MAGIC = 0x07230203;
+
+    // The subset of the SPIR-V grammar reflection needs
+    enum SpirvOp : uint32_t
+    {
+        OpEntryPoint = 15,
+        OpTypeInt = 21,
+        OpTypeFloat = 22,
+        OpTypeVector = 23,
+        OpTypeMatrix = 24,
+        OpTypeImage = 25,
+        OpTypeSampler = 26,
+        OpTypeSampledImage = 27,
+        OpTypeArray = 28,
+        OpTypeRuntimeArray = 29,
+        OpTypeStruct = 30,
+        OpTypePointer = 32,
+        OpConstant = 43,
+        OpVariable = 59,
+        OpDecorate = 71,
+        OpMemberDecorate = 72,
+        OpTypeAccelerationStructureKHR = 5341,
+    };
+
+    enum SpirvDecoration : uint32_t
+    {
+        DecorationBufferBlock = 3,
+        DecorationArrayStride = 6,
+        DecorationMatrixStride = 7,
+        DecorationBinding = 33,
+        DecorationDescriptorSet = 34,
+        DecorationOffset = 35,
+    };
+
+    enum SpirvStorageClass : uint32_t
+    {
+        StorageClassUniformConstant = 0,
+        StorageClassUniform = 2,
+        StorageClassPushConstant = 9,
+        StorageClassStorageBuffer = 12,
+    };
+
+    struct SpirvType
+    {
+        uint32_t op = 0;
+        std::vector<uint32_t> operands;
+    };
+
+    struct SpirvModule
+    {
+        std::unordered_map<uint32_t, SpirvType> types;
+        std::unordered_map<uint32_t, uint32_t> constants;
+        std::unordered_map<uint32_t, uint32_t> sets;
+        std::unordered_map<uint32_t, uint32_t> bindings;
+        std::unordered_map<uint32_t, uint32_t> arrayStrides;
+        std::set<uint32_t> bufferBlocks;
+        // Keyed by struct id and member index
+        std::map<std::pair<uint32_t, uint32_t>, uint32_t> memberOffsets;
+        std::map<std::pair<uint32_t, uint32_t>, uint32_t> matrixStrides;
+    };
+
+    VkShaderStageFlagBits getShaderStage(uint32_t executionModel)
+    {
+        switch (executionModel)
+        {
+        case 0: return VK_SHADER_STAGE_VERTEX_BIT;
+        case 1: return VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT;
+        case 2: return VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT;
+        case 3: return VK_SHADER_STAGE_GEOMETRY_BIT;
+        case 4: return VK_SHADER_STAGE_FRAGMENT_BIT;
+        case 5: return VK_SHADER_STAGE_COMPUTE_BIT;
+        case 5364: return VK_SHADER_STAGE_TASK_BIT_EXT;
+        case 5365: return VK_SHADER_STAGE_MESH_BIT_EXT;
+        default: return VK_SHADER_STAGE_ALL;
+        }
+    }
+
+    // Operands after the result id that the reflection reads from each type
+    uint32_t getTypeOperandCount(uint32_t op)
+    {
+        switch (op)
+        {
+        case OpTypeInt:
+        case OpTypeFloat:
+        case OpTypeSampledImage:
+        case OpTypeRuntimeArray:
+            return 1;
+        case OpTypeVector:
+        case OpTypeMatrix:
+        case OpTypeArray:
+        case OpTypePointer:
+            return 2;
+        case OpTypeImage:
+            return 6;
+        default:
+            return 0;
+        }
+    }
+
+    // Size of a type inside a block, std140/std430 padding is taken from the strides and offsets
+    uint32_t getTypeSize(const SpirvModule& spirv, uint32_t id, uint32_t matrixStride)
+    {
+        const auto it = spirv.types.find(id);
+        if (it == spirv.types.end())
+            return 0;
+        const SpirvType& type = it->second;
+        switch (type.op)
+        {
+        case OpTypeInt:
+        case OpTypeFloat:
+            return type.operands[0] / 8;
+        case OpTypeVector:
+            return type.operands[1] * getTypeSize(spirv, type.operands[0], 0);
+        case OpTypeMatrix:
+            return type.operands[1] * (matrixStride ? matrixStride : getTypeSize(spirv, type.operands[0], 0));
+        case OpTypeArray:
+        {
+            const auto stride = spirv.arrayStrides.find(id);
+            const auto length = spirv.constants.find(type.operands[1]);
+            const uint32_t count = length != spirv.constants.end() ? length->second : 1;
+            return count * (stride != spirv.arrayStrides.end() ? stride->second
+                                                                : getTypeSize(spirv, type.operands[0], matrixStride));
+        }
+        case OpTypeStruct:
+        {
+            uint32_t size = 0;
+            for (uint32_t member = 0; member < type.operands.size(); member++)
+            {
+                const auto offset = spirv.memberOffsets.find({id, member});
+                const auto stride = spirv.matrixStrides.find({id, member});
+                size = std::max(size, (offset != spirv.memberOffsets.end() ? offset->second : 0) +
+                                getTypeSize(spirv, type.operands[member],
+                                            stride != spirv.matrixStrides.end() ? stride->second : 0));
+            }
+            return size;
+        }
+        default:
+            return 0;
+        }
+    }
+
+    bool getDescriptorType(const SpirvModule& spirv, uint32_t id, uint32_t storageClass, VkDescriptorType& type)
+    {
+        const auto it = spirv.types.find(id);
+        if (it == spirv.types.end())
+            return false;
+        const SpirvType& spirvType = it->second;
+        switch (spirvType.op)
+        {
+        case OpTypeSampler:
+            type = VK_DESCRIPTOR_TYPE_SAMPLER;
+            return true;
+        case OpTypeSampledImage:
+            type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            return true;
+        case OpTypeImage:
+        {
+            // Operands: sampled type, dim, depth, arrayed, multisampled, sampled
+            const uint32_t dim = spirvType.operands[1];
+            const bool storage = spirvType.operands[5] == 2;
+            if (dim == 5)
+                type = storage ? VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER : VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER;
+            else if (dim == 6)
+                type = VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+            else
+                type = storage ? VK_DESCRIPTOR_TYPE_STORAGE_IMAGE : VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+            return true;
+        }
+        case OpTypeStruct:
+            if (storageClass == StorageClassStorageBuffer || spirv.bufferBlocks.count(id))
+                type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            else
+                type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+            return true;
+        case OpTypeAccelerationStructureKHR:
+            type = VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR;
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    ShaderLibrary::Reflection reflect(const std::vector<uint32_t>& code)
+    {
+        ShaderLibrary::Reflection reflection = {};
+        reflection.stage = VK_SHADER_STAGE_ALL;
+        SpirvModule spirv;
+        std::vector<std::pair<uint32_t, uint32_t>> variables;
+        size_t i = 5;
+        while (i < code.size())
+        {
+            const uint32_t wordCount = code[i] >> 16;
+            const uint32_t op = code[i] & 0xffff;
+            if (wordCount == 0 || i + wordCount > code.size())
+                break;
+            const uint32_t* words = &code[i + 1];
+            const uint32_t operandCount = wordCount - 1;
+            // Instructions too short for what is read from them are skipped, a file caught mid-write on hot
+            // reload is truncated anywhere
+            switch (op)
+            {
+            case OpEntryPoint:
+                // The first entry point decides the stage, one module per stage is what the build produces.
+                // The name must be terminated inside the instruction.
+                if (reflection.entryPoint.empty() && operandCount >= 3 &&
+                    std::memchr(&words[2], 0, (operandCount - 2) * sizeof(uint32_t)))
+                {
+                    reflection.stage = getShaderStage(words[0]);
+                    reflection.entryPoint = reinterpret_cast<const char*>(&words[2]);
+                }
+                break;
+            case OpTypeInt:
+            case OpTypeFloat:
+            case OpTypeVector:
+            case OpTypeMatrix:
+            case OpTypeImage:
+            case OpTypeSampler:
+            case OpTypeSampledImage:
+            case OpTypeArray:
+            case OpTypeRuntimeArray:
+            case OpTypeStruct:
+            case OpTypePointer:
+            case OpTypeAccelerationStructureKHR:
+                if (operandCount >= 1 + getTypeOperandCount(op))
+                    spirv.types[words[0]] = {op, std::vector<uint32_t>(words + 1, words + operandCount)};
+                break;
+            case OpConstant:
+                if (operandCount >= 2)
+                    spirv.constants[words[1]] = operandCount > 2 ? words[2] : 0;
+                break;
+            case OpVariable:
+                if (operandCount >= 2)
+                    variables.emplace_back(words[1], words[0]);
+                break;
+            case OpDecorate:
+                // BufferBlock has no literal, the others one
+                if (operandCount == 2 && words[1] == DecorationBufferBlock)
+                    spirv.bufferBlocks.insert(words[0]);
+                if (operandCount < 3)
+                    break;
+                if (words[1] == DecorationDescriptorSet)
+                    spirv.sets[words[0]] = words[2];
+                else if (words[1] == DecorationBinding)
+                    spirv.bindings[words[0]] = words[2];
+                else if (words[1] == DecorationArrayStride)
+                    spirv.arrayStrides[words[0]] = words[2];
+                break;
+            case OpMemberDecorate:
+                if (operandCount < 4)
+                    break;
+                if (words[2] == DecorationOffset)
+                    spirv.memberOffsets[{words[0], words[1]}] = words[3];
+                else if (words[2] == DecorationMatrixStride)
+                    spirv.matrixStrides[{words[0], words[1]}] = words[3];
+                break;
+            default:
+                break;
+            }
+            i += wordCount;
+        }
+
+        for (const auto& variable : variables)
+        {
+            const auto pointer = spirv.types.find(variable.second);
+            if (pointer == spirv.types.end() || pointer->second.op != OpTypePointer)
+                continue;
+            const uint32_t storageClass = pointer->second.operands[0];
+            uint32_t typeId = pointer->second.operands[1];
+            if (storageClass == StorageClassPushConstant)
+            {
+                reflection.pushConstantSize = std::max(reflection.pushConstantSize,
+                                                       getTypeSize(spirv, typeId, 0));
+                continue;
+            }
+            if (storageClass != StorageClassUniformConstant && storageClass != StorageClassUniform &&
+                storageClass != StorageClassStorageBuffer)
+                continue;
+
+            // Arrays of descriptors, runtime arrays are sized by the layout
+            uint32_t count = 1;
+            for (;;)
+            {
+                const auto type = spirv.types.find(typeId);
+                if (type == spirv.types.end())
+                    break;
+                if (type->second.op == OpTypeArray)
+                {
+                    const auto length = spirv.constants.find(type->second.operands[1]);
+                    count *= length != spirv.constants.end() ? length->second : 1;
+                }
+                else if (type->second.op == OpTypeRuntimeArray)
+                    count = 0;
+                else
+                    break;
+                typeId = type->second.operands[0];
+            }
+
+            ShaderLibrary::Binding binding = {};
+            const auto set = spirv.sets.find(variable.first);
+            const auto index = spirv.bindings.find(variable.first);
+            if (set == spirv.sets.end() || index == spirv.bindings.end() ||
+                !getDescriptorType(spirv, typeId, storageClass, binding.type))
+                continue;
+            binding.set = set->second;
+            binding.binding = index->second;
+            binding.count = count;
+            reflection.bindings.push_back(binding);
+        }
+        return reflection;
+    }
+}
+
+void ShaderLibrary::init(VulkanRenderer& vulkanRenderer, const std::string& shaderDirectory)
+{
+    renderer = &vulkanRenderer;
+    device = renderer->getDevice();
+    allocator = renderer->getAllocator();
+    directory = shaderDirectory;
+    watch();
+}
+
+void ShaderLibrary::destroy()
+{
+    if (!renderer)
+        return;
+    unwatch();
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto& layout : pipelineLayouts)
+        vkDestroyPipelineLayout(device, layout.second, allocator);
+    pipelineLayouts.clear();
+    for (const auto& module : modules)
+        vkDestroyShaderModule(device, module.second.module, allocator);
+    modules.clear();
+    names.clear();
+    listeners.clear();
+    finishedReloads.clear();
+    renderer = nullptr;
+}
+
+VkShaderModule ShaderLibrary::load(const std::string& name)
+{
+    return getModule(name).module;
+}
+
+ShaderStageDesc ShaderLibrary::getStage(const std::string& name)
+{
+    const Module& module = getModule(name);
+    return {module.reflection.stage, module.module, module.reflection.entryPoint};
+}
+
+ShaderLibrary::Reflection ShaderLibrary::getReflection(const std::string& name)
+{
+    return getModule(name).reflection;
+}
+
+ShaderLibrary::Layout ShaderLibrary::getLayout(const std::vector<std::string>& stageNames,
+                                               uint32_t pushDescriptorSet)
+{
+    // Bindings sorted by set, then binding, so each set's list comes out in one run
+    std::map<std::pair<uint32_t, uint32_t>, VkDescriptorSetLayoutBinding> bindings;
+    std::set<uint32_t> bindlessSets;
+    uint32_t setCount = 0;
+    VkPushConstantRange pushConstants = {};
+    for (const std::string& name : stageNames)
+    {
+        const Reflection reflection = getReflection(name);
+        for (const Binding& binding : reflection.bindings)
+        {
+            setCount = std::max(setCount, binding.set + 1);
+            if (binding.count == 0)
+            {
+                bindlessSets.insert(binding.set);
+                continue;
+            }
+            VkDescriptorSetLayoutBinding& layoutBinding = bindings[{binding.set, binding.binding}];
+            if (layoutBinding.stageFlags != 0 && layoutBinding.descriptorType != binding.type)
+            {
+                throw std::runtime_error("[Vulkan] Shader " + name + " redeclares a binding with another type!");
+            }
+            layoutBinding.binding = binding.binding;
+            layoutBinding.descriptorType = binding.type;
+            layoutBinding.descriptorCount = std::max(layoutBinding.descriptorCount, binding.count);
+            layoutBinding.stageFlags |= reflection.stage;
+        }
+        if (reflection.pushConstantSize > 0)
+        {
+            pushConstants.stageFlags |= reflection.stage;
+            pushConstants.size = std::max(pushConstants.size, reflection.pushConstantSize);
+        }
+    }
+
+    Layout layout = {};
+    layout.setLayouts.resize(setCount);
+    for (uint32_t set = 0; set < setCount; set++)
+    {
+        if (bindlessSets.count(set))
+        {
+            layout.setLayouts[set] = renderer->getBindless().getLayout();
+            continue;
+        }
+        std::vector<VkDescriptorSetLayoutBinding> setBindings;
+        for (auto it = bindings.lower_bound({set, 0}); it != bindings.end() && it->first.first == set; ++it)
+            setBindings.push_back(it->second);
+        // Unused sets in between still need a layout
+        layout.setLayouts[set] = renderer->getDescriptorCache().getLayout(
+            setBindings.data(), static_cast<uint32_t>(setBindings.size()),
+            set == pushDescriptorSet ? VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR : 0);
+    }
+
+    // Pipeline layouts are deduplicated on their set layouts and push constants
+    std::string key(reinterpret_cast<const char*>(layout.setLayouts.data()),
+                    layout.setLayouts.size() * sizeof(VkDescriptorSetLayout));
+    key.append(reinterpret_cast<const char*>(&pushConstants), sizeof(pushConstants));
+
+    std::lock_guard<std::mutex> lock(mutex);
+    const auto it = pipelineLayouts.find(key);
+    if (it != pipelineLayouts.end())
+    {
+        layout.pipelineLayout = it->second;
+        return layout;
+    }
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = setCount;
+    pipelineLayoutInfo.pSetLayouts = layout.setLayouts.data();
+    pipelineLayoutInfo.pushConstantRangeCount = pushConstants.size > 0 ? 1 : 0;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstants;
+    if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, allocator, &layout.pipelineLayout) != VK_SUCCESS)
+    {
+        throw std::runtime_error("[Vulkan] Failed to create reflected pipeline layout!");
+    }
+    pipelineLayouts.emplace(key, layout.pipelineLayout);
+    return layout;
+}
+
+uint32_t ShaderLibrary::addReloadListener(const ReloadCallback& callback)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    listeners.emplace_back(nextListener, callback);
+    return nextListener++;
+}
+
+void ShaderLibrary::removeReloadListener(uint32_t id)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    listeners.erase(std::remove_if(listeners.begin(), listeners.end(),
+                                   [id](const std::pair<uint32_t, ReloadCallback>& listener)
+                                   {
+                                       return listener.first == id;
+                                   }), listeners.end());
+}
+
+void ShaderLibrary::update()
+{
+#ifdef __linux__
+    if (inotifyHandle >= 0)
+    {
+        // Editors and compilers emit several events per write, each file is reloaded once
+        std::set<std::string> changed;
+        alignas(inotify_event) char buffer[4096];
+        ssize_t length;
+        while ((length = read(inotifyHandle, buffer, sizeof(buffer))) > 0)
+        {
+            for (ssize_t offset = 0; offset < length;)
+            {
+                const inotify_event* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+                if (event->len > 0)
+                    changed.insert(event->name);
+                offset += sizeof(inotify_event) + event->len;
+            }
+        }
+        for (const std::string& name : changed)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!names.count(name))
+                    continue;
+            }
+            renderer->getJobSystem().enqueue([this, name](uint32_t)
+            {
+                try
+                {
+                    const uint64_t hash = loadFile(name);
+                    std::lock_guard<std::mutex> lock(mutex);
+                    finishedReloads.push_back({name, hash});
+                }
+                catch (const std::exception& e)
+                {
+                    // A half written or broken file keeps the previous version
+                    DebugConfig::warning("%s", e.what());
+                }
+            });
+        }
+    }
+#endif
+
+    std::vector<Reload> reloads;
+    std::vector<std::pair<uint32_t, ReloadCallback>> callbacks;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const Reload& reload : finishedReloads)
+        {
+            uint64_t& current = names[reload.name];
+            if (current == reload.hash)
+                continue;
+            current = reload.hash;
+            statistics.reloadCount++;
+            reloads.push_back(reload);
+        }
+        finishedReloads.clear();
+        if (!reloads.empty())
+            callbacks = listeners;
+    }
+    // Listeners may load shaders and request pipelines, which takes the lock again
+    for (const Reload& reload : reloads)
+    {
+        DebugConfig::verbose("[Vulkan] Shader %s reloaded", reload.name.c_str());
+        for (const auto& callback : callbacks)
+            callback.second(reload.name);
+    }
+}
+
+ShaderLibrary::Statistics ShaderLibrary::getStatistics() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    Statistics result = statistics;
+    result.moduleCount = static_cast<uint32_t>(modules.size());
+    return result;
+}
+
+uint64_t ShaderLibrary::loadFile(const std::string& name)
+{
+    const std::string path = directory + name;
+    FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file)
+    {
+        throw std::runtime_error("[Vulkan] Shader not found: " + path);
+    }
+    std::fseek(file, 0, SEEK_END);
+    const long size = std::ftell(file);
+    std::fseek(file, 0, SEEK_SET);
+    std::vector<uint32_t> code(size > 0 ? static_cast<size_t>(size) / 4 : 0);
+    const size_t read = code.empty() ? 0 : std::fread(code.data(), 1, static_cast<size_t>(size), file);
+    std::fclose(file);
+    if (code.size() < 5 || size % 4 != 0 || read != static_cast<size_t>(size) || code[0] != SPIRV_MAGIC)
+    {
+        throw std::runtime_error("[Vulkan] Failed to read shader: " + path);
+    }
+
+    const uint64_t hash = PipelineCacheFile::hash(reinterpret_cast<const char*>(code.data()),
+                                                  static_cast<size_t>(size));
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        statistics.loadCount++;
+        if (modules.count(hash))
+        {
+            statistics.cacheHits++;
+            return hash;
+        }
+    }
+
+    // Reflection and module creation run outside the lock, a racing load of the same content is dropped below
+    Module module = {};
+    module.reflection = reflect(code);
+    VkShaderModuleCreateInfo moduleInfo = {};
+    moduleInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    moduleInfo.codeSize = static_cast<size_t>(size);
+    moduleInfo.pCode = code.data();
+    if (vkCreateShaderModule(device, &moduleInfo, allocator, &module.module) != VK_SUCCESS)
+    {
+        throw std::runtime_error("[Vulkan] Failed to create shader module " + path);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!modules.emplace(hash, module).second)
+        vkDestroyShaderModule(device, module.module, allocator);
+    return hash;
+}
+
+const ShaderLibrary::Module& ShaderLibrary::getModule(const std::string& name)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        const auto it = names.find(name);
+        if (it != names.end())
+            return modules.at(it->second);
+    }
+    const uint64_t hash = loadFile(name);
+    std::lock_guard<std::mutex> lock(mutex);
+    // A concurrent first load may have won, both found the same content
+    names.emplace(name, hash);
+    return modules.at(names.at(name));
+}
+
+void ShaderLibrary::watch()
+{
+#ifdef __linux__
+    inotifyHandle = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotifyHandle < 0)
+    {
+        DebugConfig::warning("[Vulkan] inotify unavailable, shader hot reload disabled");
+        return;
+    }
+    // Compilers write a new file and rename it over the old one, or rewrite it in place
+    watchDescriptor = inotify_add_watch(inotifyHandle, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+    if (watchDescriptor < 0)
+    {
+        DebugConfig::warning("[Vulkan] Failed to watch %s, shader hot reload disabled", directory.c_str());
+        close(inotifyHandle);
+        inotifyHandle = -1;
+        return;
+    }
+    DebugConfig::verbose("[Vulkan] Watching %s for shader changes", directory.c_str());
+#endif
+}
+
+void ShaderLibrary::unwatch()
+{
+#ifdef __linux__
+    if (inotifyHandle >= 0)
+    {
+        if (watchDescriptor >= 0)
+            inotify_rm_watch(inotifyHandle, watchDescriptor);
+        close(inotifyHandle);
+    }
+#endif
+    inotifyHandle = -1;
+    watchDescriptor = -1;
+}
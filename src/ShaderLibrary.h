@@ -0,0 +1,120 @@
+//
+// Created by Batur on 18/10/2026.
+//
+
+#ifndef SHADERLIBRARY_H
+#define SHADERLIBRARY_H
+
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+#include "PipelineCompiler.h"
+
+class VulkanRenderer;
+
+// SPIR-V modules of one directory, loaded by file name and cached by content.
+// Files with the same bytes share one VkShaderModule, and a module lives as long as the library, so a pipeline
+// still compiling against an older version of a file is never left without its module. Descriptor bindings and
+// push constants are reflected from the SPIR-V to build pipeline layouts.
+// On Linux the directory is watched with inotify: a rewritten file is loaded on the job system and the reload
+// listeners run from update(), where they request their pipelines again with the old ones as fallback.
+class ShaderLibrary
+{
+public:
+    struct Binding
+    {
+        uint32_t set;
+        uint32_t binding;
+        VkDescriptorType type;
+        // 0 for runtime arrays
+        uint32_t count;
+    };
+
+    struct Reflection
+    {
+        VkShaderStageFlagBits stage;
+        std::string entryPoint;
+        std::vector<Binding> bindings;
+        uint32_t pushConstantSize;
+    };
+
+    // Owned by the library, set layouts come from the renderer's descriptor cache
+    struct Layout
+    {
+        VkPipelineLayout pipelineLayout;
+        std::vector<VkDescriptorSetLayout> setLayouts;
+    };
+
+    struct Statistics
+    {
+        uint32_t moduleCount;
+        uint32_t loadCount;
+        // Loads whose content matched an existing module
+        uint32_t cacheHits;
+        uint32_t reloadCount;
+    };
+
+    using ReloadCallback = std::function<void(const std::string& name)>;
+
+    void init(VulkanRenderer& renderer, const std::string& directory);
+    void destroy();
+
+    // Thread safe. Loads the file the first time, later calls return the current version.
+    VkShaderModule load(const std::string& name);
+    ShaderStageDesc getStage(const std::string& name);
+    Reflection getReflection(const std::string& name);
+    // Merges the bindings and push constants of every stage. A set holding a runtime array is the
+    // BindlessRegistry set, other sets are built from the reflected bindings. `pushDescriptorSet` is built for
+    // vkCmdPushDescriptorSetKHR, which needs VK_KHR_push_descriptor enabled.
+    Layout getLayout(const std::vector<std::string>& names, uint32_t pushDescriptorSet = UINT32_MAX);
+
+    uint32_t addReloadListener(const ReloadCallback& callback);
+    void removeReloadListener(uint32_t id);
+    // Picks up changed files and runs the reload listeners for the finished ones, called by the renderer every frame
+    void update();
+    Statistics getStatistics() const;
+
+private:
+    struct Module
+    {
+        VkShaderModule module;
+        Reflection reflection;
+    };
+
+    struct Reload
+    {
+        std::string name;
+        uint64_t hash;
+    };
+
+    VulkanRenderer* renderer = nullptr;
+    VkDevice device = VK_NULL_HANDLE;
+    const VkAllocationCallbacks* allocator = nullptr;
+    std::string directory;
+    mutable std::mutex mutex;
+
+    // Content hash to module, file name to the hash of its current content
+    std::unordered_map<uint64_t, Module> modules;
+    std::unordered_map<std::string, uint64_t> names;
+    std::unordered_map<std::string, VkPipelineLayout> pipelineLayouts;
+    std::vector<std::pair<uint32_t, ReloadCallback>> listeners;
+    uint32_t nextListener = 1;
+    std::vector<Reload> finishedReloads;
+    Statistics statistics = {};
+
+    // inotify instance and its watch on the directory
+    int inotifyHandle = -1;
+    int watchDescriptor = -1;
+
+    // Reads and hashes the file, creates the module for new content. Returns the hash.
+    uint64_t loadFile(const std::string& name);
+    const Module& getModule(const std::string& name);
+    void watch();
+    void unwatch();
+};
+
+#endif //SHADERLIBRARY_H
@@ -0,0 +1,280 @@
+//
+// Created by Batur on 18/10/2026.
+//
+
+#include "Swapchain.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "DebugConfig.h"
+
+void Swapchain::init(VkPhysicalDevice physicalDeviceHandle, VkDevice deviceHandle, VkSurfaceKHR surfaceHandle,
+                     const VkAllocationCallbacks* allocationCallbacks)
+{
+    physicalDevice = physicalDeviceHandle;
+    device = deviceHandle;
+    surface = surfaceHandle;
+    allocator = allocationCallbacks;
+}
+
+bool Swapchain::create(uint32_t width, uint32_t height, VkPresentModeKHR requestedPresentMode)
+{
+    VkSurfaceCapabilitiesKHR capabilities;
+    if (vkGetPhysicalDeviceSurfaceCapabilitiesKHR(physicalDevice, surface, &capabilities) != VK_SUCCESS)
+    {
+        throw std::runtime_error("[Vulkan] Failed to query surface capabilities!");
+    }
+
+    if (capabilities.currentExtent.width != UINT32_MAX)
+    {
+        extent = capabilities.currentExtent;
+    }
+    else
+    {
+        extent.width = std::max(capabilities.minImageExtent.width,
+                                std::min(capabilities.maxImageExtent.width, width));
+        extent.height = std::max(capabilities.minImageExtent.height,
+                                 std::min(capabilities.maxImageExtent.height, height));
+    }
+    // Chosen even for a zero extent, pipelines are created against the format
+    surfaceFormat = chooseSurfaceFormat();
+    if (extent.width == 0 || extent.height == 0)
+        return false;
+
+    presentMode = choosePresentMode(requestedPresentMode);
+
+    uint32_t imageCount = capabilities.minImageCount + 1;
+    if (capabilities.maxImageCount > 0 && imageCount > capabilities.maxImageCount)
+        imageCount = capabilities.maxImageCount;
+
+    VkCompositeAlphaFlagBitsKHR compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
+    if (!(capabilities.supportedCompositeAlpha & compositeAlpha))
+    {
+        for (VkCompositeAlphaFlagBitsKHR candidate : {VK_COMPOSITE_ALPHA_INHERIT_BIT_KHR,
+                                                      VK_COMPOSITE_ALPHA_PRE_MULTIPLIED_BIT_KHR,
+                                                      VK_COMPOSITE_ALPHA_POST_MULTIPLIED_BIT_KHR})
+        {
+            if (capabilities.supportedCompositeAlpha & candidate)
+            {
+                compositeAlpha = candidate;
+                break;
+            }
+        }
+    }
+
+    VkImageUsageFlags usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+    if (capabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_DST_BIT)
+        usage |= VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+
+    VkSwapchainKHR oldSwapchain = swapchain;
+    VkSwapchainCreateInfoKHR createInfo = {};
+    createInfo.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
+    createInfo.surface = surface;
+    createInfo.minImageCount = imageCount;
+    createInfo.imageFormat = surfaceFormat.format;
+    createInfo.imageColorSpace = surfaceFormat.colorSpace;
+    createInfo.imageExtent = extent;
+    createInfo.imageArrayLayers = 1;
+    createInfo.imageUsage = usage;
+    createInfo.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    createInfo.preTransform = capabilities.currentTransform;
+    createInfo.compositeAlpha = compositeAlpha;
+    createInfo.presentMode = presentMode;
+    createInfo.clipped = VK_TRUE;
+    createInfo.oldSwapchain = oldSwapchain;
+    VkResult err = vkCreateSwapchainKHR(device, &createInfo, allocator, &swapchain);
+    if (err != VK_SUCCESS)
+    {
+        throw std::runtime_error("[Vulkan] Failed to create swapchain!");
+    }
+
+    destroyImageResources();
+    if (oldSwapchain != VK_NULL_HANDLE)
+        vkDestroySwapchainKHR(device, oldSwapchain, allocator);
+
+    vkGetSwapchainImagesKHR(device, swapchain, &imageCount, nullptr);
+    images.resize(imageCount);
+    vkGetSwapchainImagesKHR(device, swapchain, &imageCount, images.data());
+
+    imageViews.resize(imageCount, VK_NULL_HANDLE);
+    renderFinishedSemaphores.resize(imageCount, VK_NULL_HANDLE);
+    for (uint32_t i = 0; i < imageCount; i++)
+    {
+        VkImageViewCreateInfo viewInfo = {};
+        viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        viewInfo.image = images[i];
+        viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        viewInfo.format = surfaceFormat.format;
+        viewInfo.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+        if (vkCreateImageView(device, &viewInfo, allocator, &imageViews[i]) != VK_SUCCESS)
+        {
+            throw std::runtime_error("[Vulkan] Failed to create swapchain image view!");
+        }
+
+        VkSemaphoreCreateInfo semaphoreInfo = {};
+        semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+        if (vkCreateSemaphore(device, &semaphoreInfo, allocator, &renderFinishedSemaphores[i]) != VK_SUCCESS)
+        {
+            throw std::runtime_error("[Vulkan] Failed to create swapchain semaphore!");
+        }
+    }
+
+    DebugConfig::verbose("[Vulkan] Swapchain created: %ux%u, %u images, %s", extent.width, extent.height, imageCount,
+                         getPresentModeName(presentMode));
+    return true;
+}
+
+void Swapchain::destroy()
+{
+    destroyImageResources();
+    if (swapchain != VK_NULL_HANDLE)
+    {
+        vkDestroySwapchainKHR(device, swapchain, allocator);
+        swapchain = VK_NULL_HANDLE;
+        DebugConfig::verbose("[Vulkan] Destroying Vulkan swapchain");
+    }
+}
+
+VkResult Swapchain::acquire(VkSemaphore signalSemaphore, uint32_t& imageIndex)
+{
+    return vkAcquireNextImageKHR(device, swapchain, UINT64_MAX, signalSemaphore, VK_NULL_HANDLE, &imageIndex);
+}
+
+VkResult Swapchain::present(VkQueue queue, uint32_t imageIndex)
+{
+    VkPresentInfoKHR presentInfo = {};
+    presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+    presentInfo.waitSemaphoreCount = 1;
+    presentInfo.pWaitSemaphores = &renderFinishedSemaphores[imageIndex];
+    presentInfo.swapchainCount = 1;
+    presentInfo.pSwapchains = &swapchain;
+    presentInfo.pImageIndices = &imageIndex;
+    return vkQueuePresentKHR(queue, &presentInfo);
+}
+
+VkSwapchainKHR Swapchain::getHandle() const
+{
+    return swapchain;
+}
+
+VkFormat Swapchain::getFormat() const
+{
+    return surfaceFormat.format;
+}
+
+VkExtent2D Swapchain::getExtent() const
+{
+    return extent;
+}
+
+VkPresentModeKHR Swapchain::getPresentMode() const
+{
+    return presentMode;
+}
+
+uint32_t Swapchain::getImageCount() const
+{
+    return static_cast<uint32_t>(images.size());
+}
+
+VkImage Swapchain::getImage(uint32_t imageIndex) const
+{
+    return images[imageIndex];
+}
+
+VkImageView Swapchain::getImageView(uint32_t imageIndex) const
+{
+    return imageViews[imageIndex];
+}
+
+VkSemaphore Swapchain::getRenderFinishedSemaphore(uint32_t imageIndex) const
+{
+    return renderFinishedSemaphores[imageIndex];
+}
+
+const char* Swapchain::getPresentModeName(VkPresentModeKHR presentMode)
+{
+    switch (presentMode)
+    {
+    case VK_PRESENT_MODE_IMMEDIATE_KHR:
+        return "immediate";
+    case VK_PRESENT_MODE_MAILBOX_KHR:
+        return "mailbox";
+    case VK_PRESENT_MODE_FIFO_KHR:
+        return "fifo";
+    case VK_PRESENT_MODE_FIFO_RELAXED_KHR:
+        return "fifo_relaxed";
+    default:
+        return "unknown";
+    }
+}
+
+bool Swapchain::parsePresentMode(const char* name, VkPresentModeKHR& presentMode)
+{
+    if (!name)
+        return false;
+    for (VkPresentModeKHR candidate : {VK_PRESENT_MODE_IMMEDIATE_KHR, VK_PRESENT_MODE_MAILBOX_KHR,
+                                       VK_PRESENT_MODE_FIFO_KHR, VK_PRESENT_MODE_FIFO_RELAXED_KHR})
+    {
+        if (std::strcmp(name, getPresentModeName(candidate)) == 0)
+        {
+            presentMode = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+VkSurfaceFormatKHR Swapchain::chooseSurfaceFormat() const
+{
+    uint32_t formatCount = 0;
+    vkGetPhysicalDeviceSurfaceFormatsKHR(physicalDevice, surface, &formatCount, nullptr);
+    std::vector<VkSurfaceFormatKHR> formats(formatCount);
+    vkGetPhysicalDeviceSurfaceFormatsKHR(physicalDevice, surface, &formatCount, formats.data());
+    if (formats.empty())
+    {
+        throw std::runtime_error("[Vulkan] Surface reports no formats!");
+    }
+
+    // UNORM targets, ImGui colors are already authored in sRGB
+    for (const VkSurfaceFormatKHR& format : formats)
+    {
+        if ((format.format == VK_FORMAT_B8G8R8A8_UNORM || format.format == VK_FORMAT_R8G8B8A8_UNORM) &&
+            format.colorSpace == VK_COLOR_SPACE_SRGB_NONLINEAR_KHR)
+            return format;
+    }
+    return formats[0];
+}
+
+bool Swapchain::isPresentModeSupported(VkPresentModeKHR presentMode) const
+{
+    uint32_t modeCount = 0;
+    vkGetPhysicalDeviceSurfacePresentModesKHR(physicalDevice, surface, &modeCount, nullptr);
+    std::vector<VkPresentModeKHR> modes(modeCount);
+    vkGetPhysicalDeviceSurfacePresentModesKHR(physicalDevice, surface, &modeCount, modes.data());
+    return std::find(modes.begin(), modes.end(), presentMode) != modes.end();
+}
+
+VkPresentModeKHR Swapchain::choosePresentMode(VkPresentModeKHR requested) const
+{
+    if (isPresentModeSupported(requested))
+        return requested;
+
+    DebugConfig::warning("[Vulkan] Present mode %s not supported, using fifo", getPresentModeName(requested));
+    return VK_PRESENT_MODE_FIFO_KHR;
+}
+
+void Swapchain::destroyImageResources()
+{
+    for (VkImageView imageView : imageViews)
+        if (imageView != VK_NULL_HANDLE)
+            vkDestroyImageView(device, imageView, allocator);
+    for (VkSemaphore semaphore : renderFinishedSemaphores)
+        if (semaphore != VK_NULL_HANDLE)
+            vkDestroySemaphore(device, semaphore, allocator);
+    imageViews.clear();
+    renderFinishedSemaphores.clear();
+    images.clear();
+}
@@ -0,0 +1,66 @@
+//
+// Created by Batur on 18/10/2026.
+//
+
+#ifndef SWAPCHAIN_H
+#define SWAPCHAIN_H
+
+#include <vector>
+#include <vulkan/vulkan.h>
+
+struct SwapchainConfig
+{
+    // Falls back to FIFO, the only mode every implementation supports
+    VkPresentModeKHR presentMode = VK_PRESENT_MODE_FIFO_KHR;
+    uint32_t framesInFlight = 2;
+};
+
+class Swapchain
+{
+public:
+    void init(VkPhysicalDevice physicalDevice, VkDevice device, VkSurfaceKHR surface,
+              const VkAllocationCallbacks* allocator);
+    // Creates or recreates the swapchain, reusing the previous one as oldSwapchain.
+    // Returns false when the surface has a zero extent (minimized window).
+    bool create(uint32_t width, uint32_t height, VkPresentModeKHR presentMode);
+    void destroy();
+
+    VkResult acquire(VkSemaphore signalSemaphore, uint32_t& imageIndex);
+    VkResult present(VkQueue queue, uint32_t imageIndex);
+
+    VkSwapchainKHR getHandle() const;
+    VkFormat getFormat() const;
+    VkExtent2D getExtent() const;
+    VkPresentModeKHR getPresentMode() const;
+    uint32_t getImageCount() const;
+    VkImage getImage(uint32_t imageIndex) const;
+    VkImageView getImageView(uint32_t imageIndex) const;
+    // Signaled by the frame that renders the image, waited on by present.
+    // One per image, a per-frame semaphore could still be in use by an earlier presentation.
+    VkSemaphore getRenderFinishedSemaphore(uint32_t imageIndex) const;
+
+    // Whether the surface lists the mode, create() falls back to FIFO for the others
+    bool isPresentModeSupported(VkPresentModeKHR presentMode) const;
+    static const char* getPresentModeName(VkPresentModeKHR presentMode);
+    static bool parsePresentMode(const char* name, VkPresentModeKHR& presentMode);
+
+private:
+    VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
+    VkDevice device = VK_NULL_HANDLE;
+    VkSurfaceKHR surface = VK_NULL_HANDLE;
+    const VkAllocationCallbacks* allocator = nullptr;
+
+    VkSwapchainKHR swapchain = VK_NULL_HANDLE;
+    VkSurfaceFormatKHR surfaceFormat = {};
+    VkExtent2D extent = {};
+    VkPresentModeKHR presentMode = VK_PRESENT_MODE_FIFO_KHR;
+    std::vector<VkImage> images;
+    std::vector<VkImageView> imageViews;
+    std::vector<VkSemaphore> renderFinishedSemaphores;
+
+    VkSurfaceFormatKHR chooseSurfaceFormat() const;
+    VkPresentModeKHR choosePresentMode(VkPresentModeKHR requested) const;
+    void destroyImageResources();
+};
+
+#endif //SWAPCHAIN_H
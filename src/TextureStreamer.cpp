@@ -0,0 +1,655 @@
+//
+// Created by Batur on 18/10/2026.
+//
+
+#include "TextureStreamer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "DebugConfig.h"
+#include "VulkanRenderer.h"
+
+namespace
+{
+    const uint8_t KTX2_IDENTIFIER[12] = {0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'};
+    // Levels uploaded per frame at most, a single texture bigger than that still goes alone
+    constexpr VkDeviceSize MAX_STREAM_BYTES = 32ull << 20;
+
+    struct Ktx2Header
+    {
+        uint8_t identifier[12];
+        uint32_t vkFormat;
+        uint32_t typeSize;
+        uint32_t pixelWidth;
+        uint32_t pixelHeight;
+        uint32_t pixelDepth;
+        uint32_t layerCount;
+        uint32_t faceCount;
+        uint32_t levelCount;
+        uint32_t supercompressionScheme;
+        uint32_t dfdByteOffset;
+        uint32_t dfdByteLength;
+        uint32_t kvdByteOffset;
+        uint32_t kvdByteLength;
+        uint64_t sgdByteOffset;
+        uint64_t sgdByteLength;
+    };
+
+    struct Ktx2Level
+    {
+        uint64_t byteOffset;
+        uint64_t byteLength;
+        uint64_t uncompressedByteLength;
+    };
+
+    static_assert(sizeof(Ktx2Header) == 80, "KTX2 header layout");
+    static_assert(sizeof(Ktx2Level) == 24, "KTX2 level index layout");
+
+    // Formats from `first` to `last` store `bytes` per block of `width` x `height` texels
+    struct BlockLayout
+    {
+        VkFormat first;
+        VkFormat last;
+        uint32_t bytes;
+        uint32_t width;
+        uint32_t height;
+    };
+
+    const BlockLayout BLOCK_LAYOUTS[] = {
+        {VK_FORMAT_R4G4_UNORM_PACK8, VK_FORMAT_R4G4_UNORM_PACK8, 1, 1, 1},
+        {VK_FORMAT_R4G4B4A4_UNORM_PACK16, VK_FORMAT_A1R5G5B5_UNORM_PACK16, 2, 1, 1},
+        {VK_FORMAT_R8_UNORM, VK_FORMAT_R8_SRGB, 1, 1, 1},
+        {VK_FORMAT_R8G8_UNORM, VK_FORMAT_R8G8_SRGB, 2, 1, 1},
+        {VK_FORMAT_R8G8B8_UNORM, VK_FORMAT_B8G8R8_SRGB, 3, 1, 1},
+        {VK_FORMAT_R8G8B8A8_UNORM, VK_FORMAT_A2B10G10R10_SINT_PACK32, 4, 1, 1},
+        {VK_FORMAT_R16_UNORM, VK_FORMAT_R16_SFLOAT, 2, 1, 1},
+        {VK_FORMAT_R16G16_UNORM, VK_FORMAT_R16G16_SFLOAT, 4, 1, 1},
+        {VK_FORMAT_R16G16B16_UNORM, VK_FORMAT_R16G16B16_SFLOAT, 6, 1, 1},
+        {VK_FORMAT_R16G16B16A16_UNORM, VK_FORMAT_R16G16B16A16_SFLOAT, 8, 1, 1},
+        {VK_FORMAT_R32_UINT, VK_FORMAT_R32_SFLOAT, 4, 1, 1},
+        {VK_FORMAT_R32G32_UINT, VK_FORMAT_R32G32_SFLOAT, 8, 1, 1},
+        {VK_FORMAT_R32G32B32_UINT, VK_FORMAT_R32G32B32_SFLOAT, 12, 1, 1},
+        {VK_FORMAT_R32G32B32A32_UINT, VK_FORMAT_R32G32B32A32_SFLOAT, 16, 1, 1},
+        {VK_FORMAT_B10G11R11_UFLOAT_PACK32, VK_FORMAT_E5B9G9R9_UFLOAT_PACK32, 4, 1, 1},
+        {VK_FORMAT_BC1_RGB_UNORM_BLOCK, VK_FORMAT_BC1_RGBA_SRGB_BLOCK, 8, 4, 4},
+        {VK_FORMAT_BC2_UNORM_BLOCK, VK_FORMAT_BC3_SRGB_BLOCK, 16, 4, 4},
+        {VK_FORMAT_BC4_UNORM_BLOCK, VK_FORMAT_BC4_SNORM_BLOCK, 8, 4, 4},
+        {VK_FORMAT_BC5_UNORM_BLOCK, VK_FORMAT_BC7_SRGB_BLOCK, 16, 4, 4},
+        {VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK, VK_FORMAT_ETC2_R8G8B8A1_SRGB_BLOCK, 8, 4, 4},
+        {VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK, VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK, 16, 4, 4},
+        {VK_FORMAT_EAC_R11_UNORM_BLOCK, VK_FORMAT_EAC_R11_SNORM_BLOCK, 8, 4, 4},
+        {VK_FORMAT_EAC_R11G11_UNORM_BLOCK, VK_FORMAT_EAC_R11G11_SNORM_BLOCK, 16, 4, 4},
+        {VK_FORMAT_ASTC_4x4_UNORM_BLOCK, VK_FORMAT_ASTC_4x4_SRGB_BLOCK, 16, 4, 4},
+        {VK_FORMAT_ASTC_5x4_UNORM_BLOCK, VK_FORMAT_ASTC_5x4_SRGB_BLOCK, 16, 5, 4},
+        {VK_FORMAT_ASTC_5x5_UNORM_BLOCK, VK_FORMAT_ASTC_5x5_SRGB_BLOCK, 16, 5, 5},
+        {VK_FORMAT_ASTC_6x5_UNORM_BLOCK, VK_FORMAT_ASTC_6x5_SRGB_BLOCK, 16, 6, 5},
+        {VK_FORMAT_ASTC_6x6_UNORM_BLOCK, VK_FORMAT_ASTC_6x6_SRGB_BLOCK, 16, 6, 6},
+        {VK_FORMAT_ASTC_8x5_UNORM_BLOCK, VK_FORMAT_ASTC_8x5_SRGB_BLOCK, 16, 8, 5},
+        {VK_FORMAT_ASTC_8x6_UNORM_BLOCK, VK_FORMAT_ASTC_8x6_SRGB_BLOCK, 16, 8, 6},
+        {VK_FORMAT_ASTC_8x8_UNORM_BLOCK, VK_FORMAT_ASTC_8x8_SRGB_BLOCK, 16, 8, 8},
+        {VK_FORMAT_ASTC_10x5_UNORM_BLOCK, VK_FORMAT_ASTC_10x5_SRGB_BLOCK, 16, 10, 5},
+        {VK_FORMAT_ASTC_10x6_UNORM_BLOCK, VK_FORMAT_ASTC_10x6_SRGB_BLOCK, 16, 10, 6},
+        {VK_FORMAT_ASTC_10x8_UNORM_BLOCK, VK_FORMAT_ASTC_10x8_SRGB_BLOCK, 16, 10, 8},
+        {VK_FORMAT_ASTC_10x10_UNORM_BLOCK, VK_FORMAT_ASTC_10x10_SRGB_BLOCK, 16, 10, 10},
+        {VK_FORMAT_ASTC_12x10_UNORM_BLOCK, VK_FORMAT_ASTC_12x10_SRGB_BLOCK, 16, 12, 10},
+        {VK_FORMAT_ASTC_12x12_UNORM_BLOCK, VK_FORMAT_ASTC_12x12_SRGB_BLOCK, 16, 12, 12},
+    };
+
+    // Null for formats whose layout isn't known, textures in them are rejected
+    const BlockLayout* getBlockLayout(VkFormat format)
+    {
+        for (const BlockLayout& layout : BLOCK_LAYOUTS)
+            if (format >= layout.first && format <= layout.last)
+                return &layout;
+        return nullptr;
+    }
+
+    // Bytes of a tightly packed level
+    uint64_t getLevelSize(const BlockLayout& layout, uint32_t width, uint32_t height, uint32_t mip)
+    {
+        const uint64_t columns = (std::max(width >> mip, 1u) + layout.width - 1) / layout.width;
+        const uint64_t rows = (std::max(height >> mip, 1u) + layout.height - 1) / layout.height;
+        return columns * rows * layout.bytes;
+    }
+
+    // Read only mapping of the whole file, null when it can't be opened or is empty
+    const uint8_t* mapFile(const std::string& path, size_t& size)
+    {
+#ifdef _WIN32
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                  FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            return nullptr;
+        LARGE_INTEGER fileSize = {};
+        HANDLE mapping = nullptr;
+        if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0)
+            mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(file);
+        if (!mapping)
+            return nullptr;
+        // The view keeps the mapping alive
+        void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(mapping);
+        size = static_cast<size_t>(fileSize.QuadPart);
+        return static_cast<const uint8_t*>(data);
+#else
+        const int file = open(path.c_str(), O_RDONLY);
+        if (file < 0)
+            return nullptr;
+        struct stat status = {};
+        void* data = MAP_FAILED;
+        if (fstat(file, &status) == 0 && status.st_size > 0)
+            data = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+        // The mapping keeps the file open
+        close(file);
+        if (data == MAP_FAILED)
+            return nullptr;
+        size = static_cast<size_t>(status.st_size);
+        return static_cast<const uint8_t*>(data);
+#endif
+    }
+
+    void unmapFile(const uint8_t* data, size_t size)
+    {
+#ifdef _WIN32
+        (void)size;
+        UnmapViewOfFile(data);
+#else
+        munmap(const_cast<uint8_t*>(data), size);
+#endif
+    }
+
+    // Level whose texels are about one per pixel at the given on-screen size, never coarser than the tail
+    uint32_t getWantedMip(uint32_t width, uint32_t height, float screenSize, uint32_t tailMip)
+    {
+        const float ratio = static_cast<float>(std::max(width, height)) / screenSize;
+        if (ratio <= 1.0f)
+            return 0;
+        return std::min(static_cast<uint32_t>(std::floor(std::log2(ratio))), tailMip);
+    }
+}
+
+void TextureStreamer::init(VulkanRenderer& vulkanRenderer, VkDeviceSize budgetBytes)
+{
+    renderer = &vulkanRenderer;
+    device = renderer->getDevice();
+    allocator = renderer->getAllocator();
+    budget = budgetBytes;
+    effectiveBudget = budget;
+    const MemoryAllocator& memoryAllocator = renderer->getMemoryAllocator();
+    const uint32_t memoryType = memoryAllocator.findMemoryType(UINT32_MAX, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    if (memoryType != UINT32_MAX)
+        heapIndex = memoryAllocator.getMemoryProperties().memoryTypes[memoryType].heapIndex;
+    DebugConfig::verbose("[Vulkan] Texture streamer created with a %llu MiB budget on heap %u",
+                         static_cast<unsigned long long>(budget >> 20), heapIndex);
+}
+
+void TextureStreamer::destroy()
+{
+    if (!renderer)
+        return;
+    // Upload jobs read the mappings and write the images
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        jobsDone.wait(lock, [this]
+        {
+            return activeJobs == 0;
+        });
+        finishedUploads.clear();
+        failedUploads.clear();
+    }
+    vkDeviceWaitIdle(device);
+
+    for (Texture& texture : textures)
+    {
+        if (!texture.live)
+            continue;
+        retire(texture.resident);
+        retire(texture.pending);
+        unmapFile(texture.mapped, texture.mappedSize);
+    }
+    for (Retired& old : retired)
+    {
+        renderer->getDescriptorCache().invalidateImageView(old.version.view);
+        vkDestroyImageView(device, old.version.view, allocator);
+        renderer->destroyImage(old.version.image);
+    }
+    retired.clear();
+    textures.clear();
+    freeTextures.clear();
+    statistics = {};
+    renderer = nullptr;
+}
+
+TextureHandle TextureStreamer::load(const std::string& path)
+{
+    Texture texture;
+    texture.path = path;
+    texture.mapped = mapFile(path, texture.mappedSize);
+    if (!texture.mapped)
+    {
+        throw std::runtime_error("[Vulkan] Failed to map texture " + path + "!");
+    }
+
+    // Only 2D textures without supercompression, their levels can be uploaded straight from the mapping
+    Ktx2Header header = {};
+    bool valid = texture.mappedSize >= sizeof(Ktx2Header);
+    if (valid)
+        std::memcpy(&header, texture.mapped, sizeof(header));
+    const uint32_t levelCount = std::max(header.levelCount, 1u);
+    // A full chain ends with the 1x1 level
+    uint32_t maxLevelCount = 1;
+    while (static_cast<uint64_t>(std::max(header.pixelWidth, header.pixelHeight)) >> maxLevelCount > 0)
+        maxLevelCount++;
+    const BlockLayout* layout = getBlockLayout(static_cast<VkFormat>(header.vkFormat));
+    valid = valid && std::memcmp(header.identifier, KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER)) == 0 && layout &&
+        header.supercompressionScheme == 0 && header.pixelWidth > 0 && header.pixelHeight > 0 &&
+        header.pixelDepth == 0 && header.layerCount == 0 && header.faceCount == 1 && levelCount <= maxLevelCount &&
+        texture.mappedSize >= sizeof(Ktx2Header) + levelCount * sizeof(Ktx2Level);
+    for (uint32_t mip = 0; valid && mip < levelCount; mip++)
+    {
+        // The copies read every level as tightly packed blocks
+        Ktx2Level level;
+        std::memcpy(&level, texture.mapped + sizeof(Ktx2Header) + mip * sizeof(Ktx2Level), sizeof(level));
+        valid = level.byteLength == getLevelSize(*layout, header.pixelWidth, header.pixelHeight, mip) &&
+            level.byteOffset <= texture.mappedSize && level.byteLength <= texture.mappedSize - level.byteOffset;
+        texture.levels.push_back({level.byteOffset, level.byteLength});
+    }
+    texture.format = static_cast<VkFormat>(header.vkFormat);
+    VkFormatProperties properties = {};
+    if (valid)
+        vkGetPhysicalDeviceFormatProperties(renderer->getPhysicalDevice(), texture.format, &properties);
+    const VkFormatFeatureFlags features = VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_TRANSFER_DST_BIT;
+    if (!valid || (properties.optimalTilingFeatures & features) != features)
+    {
+        unmapFile(texture.mapped, texture.mappedSize);
+        throw std::runtime_error("[Vulkan] Unsupported texture " + path + "!");
+    }
+
+    texture.width = header.pixelWidth;
+    texture.height = header.pixelHeight;
+    texture.tailMip = levelCount - 1;
+    for (uint32_t mip = 0; mip < levelCount; mip++)
+        if (std::max(texture.width, texture.height) >> mip <= TAIL_SIZE)
+        {
+            texture.tailMip = mip;
+            break;
+        }
+    texture.wantedMip = texture.tailMip;
+    texture.lastUsedFrame = renderer->getFrameNumber();
+    texture.live = true;
+
+    TextureHandle handle;
+    if (!freeTextures.empty())
+    {
+        handle = freeTextures.back();
+        freeTextures.pop_back();
+        textures[handle] = texture;
+    }
+    else
+    {
+        handle = static_cast<TextureHandle>(textures.size());
+        textures.push_back(texture);
+    }
+    // The tail is small, it is read and staged right here
+    stream(handle, texture.tailMip, true);
+    DebugConfig::verbose("[Vulkan] Texture %s loaded: %ux%u, %u levels, format %d, tail from level %u",
+                         path.c_str(), texture.width, texture.height, levelCount, static_cast<int>(texture.format),
+                         texture.tailMip);
+    return handle;
+}
+
+void TextureStreamer::unload(TextureHandle handle)
+{
+    Texture& texture = textures.at(handle);
+    if (!texture.live || texture.unloading)
+        return;
+    // A job may still be reading the mapping, the texture goes once its upload is published
+    texture.unloading = true;
+    if (!texture.streaming)
+        release(texture);
+}
+
+void TextureStreamer::reportUsage(TextureHandle handle, float screenSize)
+{
+    Texture& texture = textures.at(handle);
+    texture.usage = std::max(texture.usage, screenSize);
+}
+
+uint32_t TextureStreamer::getBindlessIndex(TextureHandle handle) const
+{
+    return textures.at(handle).resident.bindlessIndex;
+}
+
+VkImageView TextureStreamer::getImageView(TextureHandle handle) const
+{
+    return textures.at(handle).resident.view;
+}
+
+uint32_t TextureStreamer::getResidentMip(TextureHandle handle) const
+{
+    return textures.at(handle).resident.firstMip;
+}
+
+void TextureStreamer::setBudget(VkDeviceSize budgetBytes)
+{
+    budget = budgetBytes;
+}
+
+void TextureStreamer::update()
+{
+    const uint64_t frameNumber = renderer->getFrameNumber();
+    const uint64_t framesInFlight = renderer->getFramesInFlight();
+
+    // An upload queued before this point is submitted by the next beginFrame() at the latest
+    std::vector<TextureHandle> finished;
+    std::vector<TextureHandle> failed;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        finished.swap(finishedUploads);
+        failed.swap(failedUploads);
+    }
+    for (const TextureHandle handle : failed)
+        cancel(textures[handle]);
+    for (const TextureHandle handle : finished)
+        textures[handle].uploadFrame = frameNumber;
+    for (Texture& texture : textures)
+        if (texture.live && texture.streaming && texture.uploadFrame < frameNumber)
+            publish(texture);
+
+    for (size_t i = 0; i < retired.size();)
+    {
+        if (retired[i].frameNumber + framesInFlight <= frameNumber)
+        {
+            // Cached sets must not match a view created later with the same handle
+            renderer->getDescriptorCache().invalidateImageView(retired[i].version.view);
+            vkDestroyImageView(device, retired[i].version.view, allocator);
+            renderer->destroyImage(retired[i].version.image);
+            retired[i] = retired.back();
+            retired.pop_back();
+            continue;
+        }
+        i++;
+    }
+
+    // Last frame's usage becomes the wanted levels
+    VkDeviceSize projected = 0;
+    std::vector<TextureHandle> candidates;
+    for (TextureHandle handle = 0; handle < textures.size(); handle++)
+    {
+        Texture& texture = textures[handle];
+        if (!texture.live)
+            continue;
+        projected += getTargetSize(texture);
+        if (texture.usage > 0.0f)
+        {
+            texture.wantedMip = getWantedMip(texture.width, texture.height, texture.usage, texture.tailMip);
+            texture.lastUsedFrame = frameNumber;
+            texture.usage = 0.0f;
+        }
+        if (!texture.streaming && !texture.unloading && texture.wantedMip < texture.resident.firstMip)
+            candidates.push_back(handle);
+    }
+
+    // A lowered budget, or a heap filling up, is met right away, as far as textures not used last frame allow
+    effectiveBudget = getEffectiveBudget();
+    while (projected > effectiveBudget && evict(UINT32_MAX, projected))
+    {
+    }
+
+    // Most recently used first, then the ones missing the most levels
+    std::sort(candidates.begin(), candidates.end(), [this](TextureHandle a, TextureHandle b)
+    {
+        const Texture& first = textures[a];
+        const Texture& second = textures[b];
+        if (first.lastUsedFrame != second.lastUsedFrame)
+            return first.lastUsedFrame > second.lastUsedFrame;
+        return first.resident.firstMip - first.wantedMip > second.resident.firstMip - second.wantedMip;
+    });
+    VkDeviceSize streamed = 0;
+    for (const TextureHandle handle : candidates)
+    {
+        const Texture& texture = textures[handle];
+        // Evicted to make room for an earlier candidate, its tail upload is already on the way
+        if (texture.streaming)
+            continue;
+        const VkDeviceSize size = getSize(texture, texture.wantedMip);
+        if (streamed > 0 && streamed + size > MAX_STREAM_BYTES)
+            break;
+        const VkDeviceSize growth = size - texture.resident.size;
+        bool fits = true;
+        while (fits && projected + growth > effectiveBudget)
+            fits = evict(handle, projected);
+        if (!fits)
+            continue;
+        projected += growth;
+        streamed += size;
+        stream(handle, texture.wantedMip, false);
+    }
+}
+
+TextureStreamer::Statistics TextureStreamer::getStatistics() const
+{
+    Statistics result = statistics;
+    result.budgetBytes = effectiveBudget;
+    for (const Texture& texture : textures)
+    {
+        if (!texture.live)
+            continue;
+        result.textureCount++;
+        result.streamingCount += texture.streaming;
+        result.residentBytes += texture.resident.size;
+        result.pendingBytes += texture.pending.size;
+    }
+    return result;
+}
+
+VkDeviceSize TextureStreamer::getSize(const Texture& texture, uint32_t firstMip) const
+{
+    VkDeviceSize size = 0;
+    for (size_t mip = firstMip; mip < texture.levels.size(); mip++)
+        size += texture.levels[mip].size;
+    return size;
+}
+
+VkDeviceSize TextureStreamer::getTargetSize(const Texture& texture) const
+{
+    return texture.streaming ? texture.pending.size : texture.resident.size;
+}
+
+void TextureStreamer::stream(TextureHandle handle, uint32_t firstMip, bool immediate)
+{
+    Texture& texture = textures[handle];
+    const uint32_t mipCount = static_cast<uint32_t>(texture.levels.size()) - firstMip;
+
+    VkImageCreateInfo imageInfo = {};
+    imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageInfo.format = texture.format;
+    imageInfo.extent = {std::max(texture.width >> firstMip, 1u), std::max(texture.height >> firstMip, 1u), 1};
+    imageInfo.mipLevels = mipCount;
+    imageInfo.arrayLayers = 1;
+    imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imageInfo.usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+    imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    Version version;
+    version.image = renderer->createImage(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    version.firstMip = firstMip;
+    version.size = getSize(texture, firstMip);
+
+    const VkImageSubresourceRange range = {VK_IMAGE_ASPECT_COLOR_BIT, 0, mipCount, 0, 1};
+    VkImageViewCreateInfo viewInfo = {};
+    viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    viewInfo.image = version.image.image;
+    viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    viewInfo.format = texture.format;
+    viewInfo.subresourceRange = range;
+    if (vkCreateImageView(device, &viewInfo, allocator, &version.view) != VK_SUCCESS)
+    {
+        renderer->destroyImage(version.image);
+        throw std::runtime_error("[Vulkan] Failed to create texture image view!");
+    }
+
+    // KTX2 stores the smallest level first, so the levels from `firstMip` down are one range of the file
+    uint64_t begin = UINT64_MAX;
+    uint64_t end = 0;
+    for (uint32_t mip = firstMip; mip < texture.levels.size(); mip++)
+    {
+        begin = std::min(begin, texture.levels[mip].offset);
+        end = std::max(end, texture.levels[mip].offset + texture.levels[mip].size);
+    }
+    std::vector<VkBufferImageCopy> regions(mipCount);
+    for (uint32_t i = 0; i < mipCount; i++)
+    {
+        const uint32_t mip = firstMip + i;
+        VkBufferImageCopy& region = regions[i];
+        region.bufferOffset = texture.levels[mip].offset - begin;
+        region.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, i, 0, 1};
+        region.imageExtent = {std::max(texture.width >> mip, 1u), std::max(texture.height >> mip, 1u), 1};
+    }
+
+    texture.pending = version;
+    texture.streaming = true;
+    texture.uploadFrame = UINT64_MAX;
+    statistics.streamedBytes += end - begin;
+    UploadManager* uploads = &renderer->getUploadManager();
+    const auto upload = [uploads, image = version.image.image, range, data = texture.mapped + begin,
+            size = end - begin, regions]()
+    {
+        uploads->uploadImage(image, range, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, data, size, regions.data(),
+                             static_cast<uint32_t>(regions.size()));
+    };
+    if (immediate)
+    {
+        upload();
+        texture.uploadFrame = renderer->getFrameNumber();
+        return;
+    }
+
+    // Reading the mapping may wait for the disk, the job system takes that instead of the frame
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        activeJobs++;
+    }
+    renderer->getJobSystem().enqueue([this, handle, upload](uint32_t)
+    {
+        // The upload ring may be exhausted, the frame thread drops the image and the levels are asked for again
+        bool uploaded = false;
+        try
+        {
+            upload();
+            uploaded = true;
+        }
+        catch (const std::exception& e)
+        {
+            DebugConfig::warning("[Vulkan] Texture upload failed: %s", e.what());
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        (uploaded ? finishedUploads : failedUploads).push_back(handle);
+        activeJobs--;
+        jobsDone.notify_all();
+    });
+}
+
+void TextureStreamer::cancel(Texture& texture)
+{
+    // Retired like a replaced image, a copy may have been queued before the upload failed
+    retire(texture.pending);
+    texture.streaming = false;
+    texture.uploadFrame = UINT64_MAX;
+    statistics.failedCount++;
+    if (texture.unloading)
+        release(texture);
+}
+
+void TextureStreamer::publish(Texture& texture)
+{
+    retire(texture.resident);
+    texture.resident = texture.pending;
+    texture.pending = Version();
+    texture.resident.bindlessIndex = renderer->getBindless().registerImage(texture.resident.view);
+    texture.streaming = false;
+    texture.uploadFrame = UINT64_MAX;
+    if (texture.unloading)
+        release(texture);
+}
+
+VkDeviceSize TextureStreamer::getEffectiveBudget() const
+{
+    const std::vector<MemoryAllocator::HeapBudget> heaps = renderer->getMemoryAllocator().getBudgets();
+    if (heapIndex >= heaps.size())
+        return budget;
+    const MemoryAllocator::HeapBudget& heap = heaps[heapIndex];
+
+    // Our images are part of the heap usage, what they hold stays available to them
+    VkDeviceSize allocated = 0;
+    for (const Texture& texture : textures)
+        if (texture.live)
+            allocated += texture.resident.size + texture.pending.size;
+    const VkDeviceSize limit = heap.budget - static_cast<VkDeviceSize>(heap.budget * HEAP_HEADROOM);
+    const VkDeviceSize available = limit > heap.usage ? limit - heap.usage : 0;
+    return std::min(budget, allocated + available);
+}
+
+bool TextureStreamer::evict(TextureHandle keep, VkDeviceSize& projected)
+{
+    // Least recently used texture holding more than its tail, textures used last frame are never evicted
+    const uint64_t frameNumber = renderer->getFrameNumber();
+    TextureHandle victim = UINT32_MAX;
+    for (TextureHandle handle = 0; handle < textures.size(); handle++)
+    {
+        const Texture& texture = textures[handle];
+        if (handle == keep || !texture.live || texture.streaming || texture.unloading ||
+            texture.resident.firstMip >= texture.tailMip || texture.lastUsedFrame >= frameNumber)
+            continue;
+        if (victim == UINT32_MAX || texture.lastUsedFrame < textures[victim].lastUsedFrame)
+            victim = handle;
+    }
+    if (victim == UINT32_MAX)
+        return false;
+
+    Texture& texture = textures[victim];
+    DebugConfig::verbose("[Vulkan] Texture %s evicted down to level %u", texture.path.c_str(), texture.tailMip);
+    projected -= texture.resident.size - getSize(texture, texture.tailMip);
+    texture.wantedMip = texture.tailMip;
+    statistics.evictionCount++;
+    stream(victim, texture.tailMip, false);
+    return true;
+}
+
+void TextureStreamer::retire(Version& version)
+{
+    if (version.view == VK_NULL_HANDLE)
+        return;
+    // The bindless registry keeps the index from being reused until the frames that could sample it are done
+    if (version.bindlessIndex != UINT32_MAX)
+        renderer->getBindless().releaseImage(version.bindlessIndex);
+    version.bindlessIndex = UINT32_MAX;
+    retired.push_back({version, renderer->getFrameNumber()});
+    version = Version();
+}
+
+void TextureStreamer::release(Texture& texture)
+{
+    retire(texture.resident);
+    retire(texture.pending);
+    unmapFile(texture.mapped, texture.mappedSize);
+    const TextureHandle handle = static_cast<TextureHandle>(&texture - textures.data());
+    texture = Texture();
+    freeTextures.push_back(handle);
+}
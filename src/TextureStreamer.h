@@ -0,0 +1,157 @@
+//
+// Created by Batur on 18/10/2026.
+//
+
+#ifndef TEXTURESTREAMER_H
+#define TEXTURESTREAMER_H
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+#include "MemoryAllocator.h"
+
+class VulkanRenderer;
+
+// Index of the texture, recycled after unload()
+using TextureHandle = uint32_t;
+
+// KTX2 textures streamed by mip level under a memory budget.
+// Files are memory mapped and stay mapped while the texture lives, so only the levels actually uploaded are ever
+// read from disk. load() makes the mip tail, the levels of at most TAIL_SIZE texels, resident right away. Finer
+// levels follow the usage reported every frame: a texture that needs them gets a new image holding its levels from
+// the wanted one down, filled from the mapping on the job system, and replaces the old image once the upload has
+// landed. When the budget would be exceeded the least recently used textures fall back to their tail first.
+// The budget shrinks to what the device local heap has left, as reported by the memory allocator, so streaming
+// backs off and evicts before the driver has to page when other allocations grow.
+// Bindless indices and image views change whenever levels are streamed in or out, query them every frame.
+// Not thread safe.
+class TextureStreamer
+{
+public:
+    static constexpr uint32_t TAIL_SIZE = 64;
+    // Share of the heap budget kept free for everything else allocated during the frame
+    static constexpr float HEAP_HEADROOM = 0.1f;
+
+    struct Statistics
+    {
+        uint32_t textureCount;
+        // Textures whose new image is still being uploaded
+        uint32_t streamingCount;
+        // Levels of the published images, and of the ones being uploaded
+        VkDeviceSize residentBytes;
+        VkDeviceSize pendingBytes;
+        // The configured budget, lowered to what the heap has left
+        VkDeviceSize budgetBytes;
+        uint64_t streamedBytes;
+        uint32_t evictionCount;
+        // Uploads that threw, their levels are streamed again when still wanted
+        uint32_t failedCount;
+    };
+
+    void init(VulkanRenderer& renderer, VkDeviceSize budget);
+    void destroy();
+
+    // Throws when the file can't be mapped, isn't a 2D KTX2 texture whose levels match its format and size, or
+    // the device can't sample its format
+    TextureHandle load(const std::string& path);
+    void unload(TextureHandle texture);
+    // Screen space usage feedback: the number of pixels the texture spans along its larger axis this frame.
+    // Textures that are not reported keep their levels until the budget needs them.
+    void reportUsage(TextureHandle texture, float screenSize);
+    // BindlessRegistry::INVALID_INDEX and null until the tail has landed, the frame after load() at the earliest
+    uint32_t getBindlessIndex(TextureHandle texture) const;
+    VkImageView getImageView(TextureHandle texture) const;
+    // Finest level resident, 0 is the full resolution
+    uint32_t getResidentMip(TextureHandle texture) const;
+
+    void setBudget(VkDeviceSize budget);
+    // Publishes the uploads that landed, then evicts and starts streaming by the usage reported last frame.
+    // Called every frame between beginFrame() and endFrame(), before the indices are used.
+    void update();
+    Statistics getStatistics() const;
+
+private:
+    struct Level
+    {
+        uint64_t offset;
+        uint64_t size;
+    };
+
+    // The image of a texture holding its levels from `firstMip` down
+    struct Version
+    {
+        MemoryAllocator::Image image;
+        VkImageView view = VK_NULL_HANDLE;
+        uint32_t bindlessIndex = UINT32_MAX;
+        uint32_t firstMip = 0;
+        VkDeviceSize size = 0;
+    };
+
+    struct Texture
+    {
+        std::string path;
+        const uint8_t* mapped = nullptr;
+        size_t mappedSize = 0;
+        VkFormat format = VK_FORMAT_UNDEFINED;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        std::vector<Level> levels;
+        uint32_t tailMip = 0;
+
+        Version resident;
+        Version pending;
+        bool streaming = false;
+        // Frame the pending upload was queued in, it is published by a later one
+        uint64_t uploadFrame = UINT64_MAX;
+        bool unloading = false;
+
+        uint32_t wantedMip = 0;
+        float usage = 0.0f;
+        uint64_t lastUsedFrame = 0;
+        bool live = false;
+    };
+
+    struct Retired
+    {
+        Version version;
+        uint64_t frameNumber;
+    };
+
+    VulkanRenderer* renderer = nullptr;
+    VkDevice device = VK_NULL_HANDLE;
+    const VkAllocationCallbacks* allocator = nullptr;
+    VkDeviceSize budget = 0;
+    VkDeviceSize effectiveBudget = 0;
+    uint32_t heapIndex = 0;
+
+    std::vector<Texture> textures;
+    std::vector<TextureHandle> freeTextures;
+    std::vector<Retired> retired;
+    Statistics statistics = {};
+
+    // Upload jobs report to the frame thread through these
+    std::mutex mutex;
+    std::condition_variable jobsDone;
+    uint32_t activeJobs = 0;
+    std::vector<TextureHandle> finishedUploads;
+    std::vector<TextureHandle> failedUploads;
+
+    VkDeviceSize getSize(const Texture& texture, uint32_t firstMip) const;
+    // Size the texture will have once its pending image, if any, is published
+    VkDeviceSize getTargetSize(const Texture& texture) const;
+    // The budget, capped by what our images hold plus what the heap has left short of the headroom
+    VkDeviceSize getEffectiveBudget() const;
+    // Creates the image for the levels from `firstMip` down and uploads them, on the job system unless `immediate`
+    void stream(TextureHandle handle, uint32_t firstMip, bool immediate);
+    void publish(Texture& texture);
+    // Drops the pending image of an upload that threw
+    void cancel(Texture& texture);
+    bool evict(TextureHandle keep, VkDeviceSize& projected);
+    void retire(Version& version);
+    void release(Texture& texture);
+};
+
+#endif //TEXTURESTREAMER_H
@@ -0,0 +1,259 @@
+//
+// Created by Batur on 18/10/2026.
+//
+
+#include "TlsfAllocator.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+struct TlsfAllocator::Range
+{
+    uint64_t offset;
+    uint64_t size;
+    Range* prevPhysical;
+    Range* nextPhysical;
+    Range* prevFree;
+    Range* nextFree;
+    bool free;
+};
+
+namespace
+{
+    uint32_t highestBit(uint64_t value)
+    {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanReverse64(&index, value);
+        return static_cast<uint32_t>(index);
+#else
+        return 63 - static_cast<uint32_t>(__builtin_clzll(value));
+#endif
+    }
+
+    uint32_t lowestBit(uint64_t value)
+    {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward64(&index, value);
+        return static_cast<uint32_t>(index);
+#else
+        return static_cast<uint32_t>(__builtin_ctzll(value));
+#endif
+    }
+
+    uint64_t alignUp(uint64_t value, uint64_t alignment)
+    {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+}
+
+TlsfAllocator::TlsfAllocator(uint64_t size)
+    : size(size)
+{
+    firstRange = new Range{0, size, nullptr, nullptr, nullptr, nullptr, true};
+    insertFree(firstRange);
+}
+
+TlsfAllocator::~TlsfAllocator()
+{
+    Range* range = firstRange;
+    while (range)
+    {
+        Range* next = range->nextPhysical;
+        delete range;
+        range = next;
+    }
+}
+
+TlsfAllocator::Range* TlsfAllocator::allocate(uint64_t requestedSize, uint64_t alignment)
+{
+    const uint64_t minSize = 1ull << MIN_SIZE_LOG2;
+    const uint64_t allocationSize = alignUp(requestedSize > 0 ? requestedSize : 1, minSize);
+    // Offsets are always multiples of minSize, so at most alignment - minSize bytes of padding are needed
+    const uint64_t searchSize = allocationSize + (alignment > minSize ? alignment - minSize : 0);
+    if (searchSize > size)
+        return nullptr;
+
+    Range* range = findFree(searchSize);
+    if (!range)
+        return nullptr;
+    removeFree(range);
+
+    const uint64_t padding = alignUp(range->offset, alignment) - range->offset;
+    if (padding > 0)
+    {
+        Range* aligned = split(range, padding);
+        insertFree(range);
+        range = aligned;
+    }
+    if (range->size > allocationSize)
+        insertFree(split(range, allocationSize));
+
+    range->free = false;
+    usedSize += range->size;
+    allocationCount++;
+    return range;
+}
+
+void TlsfAllocator::free(Range* range)
+{
+    range->free = true;
+    usedSize -= range->size;
+    allocationCount--;
+
+    Range* next = range->nextPhysical;
+    if (next && next->free)
+    {
+        removeFree(next);
+        merge(range, next);
+    }
+    Range* prev = range->prevPhysical;
+    if (prev && prev->free)
+    {
+        removeFree(prev);
+        merge(prev, range);
+        range = prev;
+    }
+    insertFree(range);
+}
+
+uint64_t TlsfAllocator::getOffset(const Range* range)
+{
+    return range->offset;
+}
+
+uint64_t TlsfAllocator::getSize(const Range* range)
+{
+    return range->size;
+}
+
+uint64_t TlsfAllocator::getSize() const
+{
+    return size;
+}
+
+uint64_t TlsfAllocator::getUsedSize() const
+{
+    return usedSize;
+}
+
+uint64_t TlsfAllocator::getLargestFreeSize() const
+{
+    if (flBitmap == 0)
+        return 0;
+    const uint32_t fl = highestBit(flBitmap);
+    const uint32_t sl = highestBit(slBitmap[fl]);
+
+    uint64_t largest = 0;
+    for (const Range* range = freeLists[fl][sl]; range; range = range->nextFree)
+        if (range->size > largest)
+            largest = range->size;
+    return largest;
+}
+
+uint32_t TlsfAllocator::getAllocationCount() const
+{
+    return allocationCount;
+}
+
+bool TlsfAllocator::isEmpty() const
+{
+    return allocationCount == 0;
+}
+
+void TlsfAllocator::mapping(uint64_t size, uint32_t& fl, uint32_t& sl)
+{
+    if (size < SMALL_SIZE)
+    {
+        fl = 0;
+        sl = static_cast<uint32_t>(size / (SMALL_SIZE / SL_COUNT));
+        return;
+    }
+    const uint32_t log2 = highestBit(size);
+    sl = static_cast<uint32_t>(size >> (log2 - SL_LOG2)) ^ SL_COUNT;
+    fl = log2 - FL_SHIFT + 1;
+}
+
+TlsfAllocator::Range* TlsfAllocator::findFree(uint64_t searchSize) const
+{
+    // Round up to the next list boundary so any range found there is large enough
+    if (searchSize >= SMALL_SIZE)
+        searchSize += (1ull << (highestBit(searchSize) - SL_LOG2)) - 1;
+
+    uint32_t fl, sl;
+    mapping(searchSize, fl, sl);
+    if (fl >= FL_COUNT)
+        return nullptr;
+
+    uint32_t slMap = sl < SL_COUNT ? slBitmap[fl] & (~0u << sl) : 0;
+    if (!slMap)
+    {
+        const uint64_t flMap = fl + 1 < 64 ? flBitmap & (~0ull << (fl + 1)) : 0;
+        if (!flMap)
+            return nullptr;
+        fl = lowestBit(flMap);
+        slMap = slBitmap[fl];
+    }
+    sl = lowestBit(slMap);
+    return freeLists[fl][sl];
+}
+
+void TlsfAllocator::insertFree(Range* range)
+{
+    uint32_t fl, sl;
+    mapping(range->size, fl, sl);
+
+    range->free = true;
+    range->prevFree = nullptr;
+    range->nextFree = freeLists[fl][sl];
+    if (range->nextFree)
+        range->nextFree->prevFree = range;
+    freeLists[fl][sl] = range;
+
+    flBitmap |= 1ull << fl;
+    slBitmap[fl] |= 1u << sl;
+}
+
+void TlsfAllocator::removeFree(Range* range)
+{
+    uint32_t fl, sl;
+    mapping(range->size, fl, sl);
+
+    if (range->prevFree)
+        range->prevFree->nextFree = range->nextFree;
+    else
+        freeLists[fl][sl] = range->nextFree;
+    if (range->nextFree)
+        range->nextFree->prevFree = range->prevFree;
+    range->prevFree = nullptr;
+    range->nextFree = nullptr;
+
+    if (!freeLists[fl][sl])
+    {
+        slBitmap[fl] &= ~(1u << sl);
+        if (!slBitmap[fl])
+            flBitmap &= ~(1ull << fl);
+    }
+}
+
+TlsfAllocator::Range* TlsfAllocator::split(Range* range, uint64_t size)
+{
+    Range* tail = new Range{range->offset + size, range->size - size, range, range->nextPhysical, nullptr, nullptr,
+                            true};
+    if (tail->nextPhysical)
+        tail->nextPhysical->prevPhysical = tail;
+    range->nextPhysical = tail;
+    range->size = size;
+    return tail;
+}
+
+void TlsfAllocator::merge(Range* range, Range* next)
+{
+    range->size += next->size;
+    range->nextPhysical = next->nextPhysical;
+    if (range->nextPhysical)
+        range->nextPhysical->prevPhysical = range;
+    delete next;
+}
@@ -0,0 +1,62 @@
+//
+// Created by Batur on 18/10/2026.
+//
+
+#ifndef TLSFALLOCATOR_H
+#define TLSFALLOCATOR_H
+
+#include <cstdint>
+
+// Two-level segregated fit allocator over an abstract [0, size) range.
+// It only hands out offsets, the memory itself belongs to the caller (a VkDeviceMemory block).
+// Allocation and free are O(1): free ranges are bucketed by size class and found through two bitmaps.
+class TlsfAllocator
+{
+public:
+    struct Range;
+
+    explicit TlsfAllocator(uint64_t size);
+    ~TlsfAllocator();
+
+    TlsfAllocator(const TlsfAllocator&) = delete;
+    TlsfAllocator& operator=(const TlsfAllocator&) = delete;
+
+    // Returns nullptr when no free range can hold `size` bytes at `alignment` (a power of two)
+    Range* allocate(uint64_t size, uint64_t alignment);
+    void free(Range* range);
+
+    static uint64_t getOffset(const Range* range);
+    static uint64_t getSize(const Range* range);
+
+    uint64_t getSize() const;
+    uint64_t getUsedSize() const;
+    uint64_t getLargestFreeSize() const;
+    uint32_t getAllocationCount() const;
+    bool isEmpty() const;
+
+private:
+    static constexpr uint32_t SL_LOG2 = 5;
+    static constexpr uint32_t SL_COUNT = 1u << SL_LOG2;
+    static constexpr uint32_t MIN_SIZE_LOG2 = 4;
+    static constexpr uint32_t FL_SHIFT = SL_LOG2 + MIN_SIZE_LOG2;
+    static constexpr uint64_t SMALL_SIZE = 1ull << FL_SHIFT;
+    static constexpr uint32_t FL_COUNT = 64 - FL_SHIFT + 1;
+
+    uint64_t size;
+    uint64_t usedSize = 0;
+    uint32_t allocationCount = 0;
+    Range* firstRange = nullptr;
+
+    uint64_t flBitmap = 0;
+    uint32_t slBitmap[FL_COUNT] = {};
+    Range* freeLists[FL_COUNT][SL_COUNT] = {};
+
+    static void mapping(uint64_t size, uint32_t& fl, uint32_t& sl);
+    Range* findFree(uint64_t size) const;
+    void insertFree(Range* range);
+    void removeFree(Range* range);
+    Range* split(Range* range, uint64_t size);
+    void merge(Range* range, Range* next);
+};
+
+#endif //TLSFALLOCATOR_H
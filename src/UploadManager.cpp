@@ -0,0 +1,313 @@
+//
+// Created by Batur on 18/10/2026.
+//
+
+#include "UploadManager.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "DebugConfig.h"
+#include "VulkanRenderer.h"
+
+namespace
+{
+    // Every read an uploaded resource may see on the graphics queue
+    constexpr VkPipelineStageFlags BUFFER_DST_STAGES = VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT |
+        VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT |
+        VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    constexpr VkAccessFlags BUFFER_DST_ACCESS = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_INDEX_READ_BIT |
+        VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_UNIFORM_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+    constexpr VkPipelineStageFlags IMAGE_DST_STAGES = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    constexpr VkAccessFlags IMAGE_DST_ACCESS = VK_ACCESS_SHADER_READ_BIT;
+}
+
+void UploadManager::init(VulkanRenderer& vulkanRenderer, VkDeviceSize size)
+{
+    renderer = &vulkanRenderer;
+    device = renderer->getDevice();
+    allocator = renderer->getAllocator();
+    ringSize = size;
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(renderer->getPhysicalDevice(), &properties);
+    copyAlignment = std::max<VkDeviceSize>(copyAlignment, properties.limits.optimalBufferCopyOffsetAlignment);
+
+    ring = renderer->createBuffer(ringSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+
+    VkCommandPoolCreateInfo poolInfo = {};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    poolInfo.queueFamilyIndex = renderer->getQueueFamily(QueueType::Transfer);
+    if (vkCreateCommandPool(device, &poolInfo, allocator, &commandPool) != VK_SUCCESS)
+    {
+        throw std::runtime_error("[Vulkan] Failed to create upload command pool!");
+    }
+    DebugConfig::verbose("[Vulkan] Upload ring of %llu KiB on the %s queue",
+                         static_cast<unsigned long long>(ringSize >> 10), QueueFamilies::getName(QueueType::Transfer));
+}
+
+void UploadManager::destroy()
+{
+    if (!renderer)
+        return;
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!batches.empty())
+        renderer->waitFor(QueueType::Transfer, batches.back().value);
+    reclaim();
+    for (MemoryAllocator::Buffer& buffer : pendingStagingBuffers)
+        renderer->destroyBuffer(buffer);
+    pendingStagingBuffers.clear();
+    pendingBufferCopies.clear();
+    pendingImageCopies.clear();
+    acquireBuffers.clear();
+    acquireImages.clear();
+
+    vkDestroyCommandPool(device, commandPool, allocator);
+    commandPool = VK_NULL_HANDLE;
+    freeCommandBuffers.clear();
+    renderer->destroyBuffer(ring);
+    renderer = nullptr;
+}
+
+void UploadManager::uploadBuffer(VkBuffer buffer, VkDeviceSize offset, const void* data, VkDeviceSize size)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    BufferCopy copy = {};
+    copy.destination = buffer;
+    copy.region.dstOffset = offset;
+    copy.region.size = size;
+    copy.source = stage(data, size, copy.region.srcOffset);
+    pendingBufferCopies.push_back(copy);
+}
+
+void UploadManager::uploadImage(VkImage image, const VkImageSubresourceRange& range, VkImageLayout finalLayout,
+                                const void* data, VkDeviceSize size, const VkBufferImageCopy* regions,
+                                uint32_t regionCount)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    VkDeviceSize offset = 0;
+    ImageCopy copy = {};
+    copy.source = stage(data, size, offset);
+    copy.image = image;
+    copy.range = range;
+    copy.finalLayout = finalLayout;
+    copy.regions.assign(regions, regions + regionCount);
+    for (VkBufferImageCopy& region : copy.regions)
+        region.bufferOffset += offset;
+    pendingImageCopies.push_back(copy);
+}
+
+uint64_t UploadManager::submit(VkCommandBuffer graphicsCommandBuffer)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    reclaim();
+    submitTransfers();
+    if (acquireValue == 0)
+        return 0;
+
+    const QueueOwnershipTransfer bufferTransfer = renderer->getOwnershipTransfer(
+        QueueType::Transfer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+        QueueType::Graphics, BUFFER_DST_STAGES, BUFFER_DST_ACCESS);
+    for (VkBuffer buffer : acquireBuffers)
+        bufferTransfer.acquireBuffer(graphicsCommandBuffer, buffer);
+
+    const QueueOwnershipTransfer imageTransfer = renderer->getOwnershipTransfer(
+        QueueType::Transfer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+        QueueType::Graphics, IMAGE_DST_STAGES, IMAGE_DST_ACCESS);
+    for (const ImageCopy& copy : acquireImages)
+        imageTransfer.acquireImage(graphicsCommandBuffer, copy.image, copy.range, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                   copy.finalLayout);
+
+    const uint64_t value = acquireValue;
+    acquireBuffers.clear();
+    acquireImages.clear();
+    acquireValue = 0;
+    return value;
+}
+
+bool UploadManager::isComplete(uint64_t value)
+{
+    return renderer->getTimeline(QueueType::Transfer).isComplete(value);
+}
+
+UploadManager::Statistics UploadManager::getStatistics() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    Statistics result = statistics;
+    result.ringUsed = used;
+    result.ringSize = ringSize;
+    return result;
+}
+
+VkBuffer UploadManager::stage(const void* data, VkDeviceSize size, VkDeviceSize& offset)
+{
+    statistics.uploadCount++;
+    statistics.uploadedBytes += size;
+
+    if (size > ringSize / 4)
+    {
+        MemoryAllocator::Buffer staging = renderer->createBuffer(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                                                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+        std::memcpy(staging.allocation->mapped, data, static_cast<size_t>(size));
+        renderer->getMemoryAllocator().flush(staging.allocation);
+        pendingStagingBuffers.push_back(staging);
+        offset = 0;
+        return staging.buffer;
+    }
+
+    reclaim();
+    if (!allocateRange(size, offset))
+    {
+        statistics.stallCount++;
+        do
+        {
+            // Pending data may be what fills the ring, it has to be in flight before it can be waited on
+            if (batches.empty())
+                submitTransfers();
+            if (batches.empty())
+            {
+                throw std::runtime_error("[Vulkan] Upload ring exhausted!");
+            }
+            renderer->waitFor(QueueType::Transfer, batches.front().value);
+            reclaim();
+        }
+        while (!allocateRange(size, offset));
+    }
+
+    std::memcpy(static_cast<char*>(ring.allocation->mapped) + offset, data, static_cast<size_t>(size));
+    renderer->getMemoryAllocator().flush(ring.allocation, offset, size);
+    return ring.buffer;
+}
+
+bool UploadManager::allocateRange(VkDeviceSize size, VkDeviceSize& offset)
+{
+    VkDeviceSize start = (head + copyAlignment - 1) / copyAlignment * copyAlignment;
+    if (start + size > ringSize)
+        start = 0;
+    // Padding and the skipped end of the ring count as used until the batch retires
+    const VkDeviceSize consumed = start >= head ? start - head + size : ringSize - head + size;
+    if (used + consumed > ringSize)
+        return false;
+
+    head = start + size;
+    used += consumed;
+    pendingRingBytes += consumed;
+    offset = start;
+    return true;
+}
+
+void UploadManager::reclaim()
+{
+    while (!batches.empty() && isComplete(batches.front().value))
+    {
+        Batch& batch = batches.front();
+        used -= batch.ringBytes;
+        for (MemoryAllocator::Buffer& buffer : batch.stagingBuffers)
+            renderer->destroyBuffer(buffer);
+        vkResetCommandBuffer(batch.commandBuffer, 0);
+        freeCommandBuffers.push_back(batch.commandBuffer);
+        batches.pop_front();
+    }
+}
+
+void UploadManager::submitTransfers()
+{
+    if (pendingBufferCopies.empty() && pendingImageCopies.empty())
+        return;
+
+    VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+    if (!freeCommandBuffers.empty())
+    {
+        commandBuffer = freeCommandBuffers.back();
+        freeCommandBuffers.pop_back();
+    }
+    else
+    {
+        VkCommandBufferAllocateInfo commandBufferInfo = {};
+        commandBufferInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        commandBufferInfo.commandPool = commandPool;
+        commandBufferInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        commandBufferInfo.commandBufferCount = 1;
+        if (vkAllocateCommandBuffers(device, &commandBufferInfo, &commandBuffer) != VK_SUCCESS)
+        {
+            throw std::runtime_error("[Vulkan] Failed to allocate upload command buffer!");
+        }
+    }
+
+    VkCommandBufferBeginInfo beginInfo = {};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkBeginCommandBuffer(commandBuffer, &beginInfo);
+
+    // One barrier call brings every destination image into TRANSFER_DST
+    std::vector<VkImageMemoryBarrier> barriers(pendingImageCopies.size());
+    for (size_t i = 0; i < pendingImageCopies.size(); i++)
+    {
+        VkImageMemoryBarrier& barrier = barriers[i];
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = pendingImageCopies[i].image;
+        barrier.subresourceRange = pendingImageCopies[i].range;
+    }
+    if (!barriers.empty())
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0,
+                             nullptr, 0, nullptr, static_cast<uint32_t>(barriers.size()), barriers.data());
+
+    for (const BufferCopy& copy : pendingBufferCopies)
+        vkCmdCopyBuffer(commandBuffer, copy.source, copy.destination, 1, &copy.region);
+    for (const ImageCopy& copy : pendingImageCopies)
+        vkCmdCopyBufferToImage(commandBuffer, copy.source, copy.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                               static_cast<uint32_t>(copy.regions.size()), copy.regions.data());
+
+    const QueueOwnershipTransfer bufferTransfer = renderer->getOwnershipTransfer(
+        QueueType::Transfer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+        QueueType::Graphics, BUFFER_DST_STAGES, BUFFER_DST_ACCESS);
+    // One release per buffer and batch, each is matched by its own acquire. A buffer released by an earlier
+    // batch belongs to the graphics queue by now, so this batch releases it again.
+    std::vector<VkBuffer> released;
+    for (const BufferCopy& copy : pendingBufferCopies)
+    {
+        if (std::find(released.begin(), released.end(), copy.destination) != released.end())
+            continue;
+        bufferTransfer.releaseBuffer(commandBuffer, copy.destination);
+        released.push_back(copy.destination);
+    }
+    acquireBuffers.insert(acquireBuffers.end(), released.begin(), released.end());
+    const QueueOwnershipTransfer imageTransfer = renderer->getOwnershipTransfer(
+        QueueType::Transfer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+        QueueType::Graphics, IMAGE_DST_STAGES, IMAGE_DST_ACCESS);
+    for (ImageCopy& copy : pendingImageCopies)
+    {
+        imageTransfer.releaseImage(commandBuffer, copy.image, copy.range, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                   copy.finalLayout);
+        copy.regions.clear();
+        acquireImages.push_back(copy);
+    }
+
+    if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS)
+    {
+        throw std::runtime_error("[Vulkan] Failed to record upload batch!");
+    }
+
+    QueueSubmission submission;
+    submission.commandBuffers.push_back(commandBuffer);
+    Batch batch;
+    batch.value = renderer->submit(QueueType::Transfer, submission);
+    batch.ringBytes = pendingRingBytes;
+    batch.commandBuffer = commandBuffer;
+    batch.stagingBuffers.swap(pendingStagingBuffers);
+    batches.push_back(batch);
+    acquireValue = batch.value;
+    statistics.batchCount++;
+
+    pendingBufferCopies.clear();
+    pendingImageCopies.clear();
+    pendingRingBytes = 0;
+}
@@ -0,0 +1,110 @@
+//
+// Created by Batur on 18/10/2026.
+//
+
+#ifndef UPLOADMANAGER_H
+#define UPLOADMANAGER_H
+
+#include <deque>
+#include <mutex>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+#include "MemoryAllocator.h"
+
+class VulkanRenderer;
+
+// Staging uploads through one persistently mapped ring buffer.
+// Data is copied into the ring when an upload is requested, the GPU copies of everything requested since the
+// last submission go out in a single transfer queue batch. Ring space comes back once the transfer timeline
+// passed the batch, a full ring waits on that timeline instead of idling a queue.
+// Uploads bigger than a quarter of the ring get their own staging buffer.
+class UploadManager
+{
+public:
+    struct Statistics
+    {
+        uint64_t uploadCount;
+        uint64_t uploadedBytes;
+        uint64_t batchCount;
+        // Uploads that had to wait for the GPU to free ring space
+        uint64_t stallCount;
+        VkDeviceSize ringUsed;
+        VkDeviceSize ringSize;
+    };
+
+    void init(VulkanRenderer& renderer, VkDeviceSize ringSize);
+    void destroy();
+
+    // Thread safe. Destination buffers and images must be exclusive and idle on the GPU.
+    void uploadBuffer(VkBuffer buffer, VkDeviceSize offset, const void* data, VkDeviceSize size);
+    // Region buffer offsets are relative to `data`. The range is transitioned to `finalLayout`.
+    void uploadImage(VkImage image, const VkImageSubresourceRange& range, VkImageLayout finalLayout, const void* data,
+                     VkDeviceSize size, const VkBufferImageCopy* regions, uint32_t regionCount);
+
+    // Submits the pending copies and records the queue ownership acquires into a graphics command buffer.
+    // Returns the transfer timeline value that command buffer has to wait for, 0 when there is nothing to wait for.
+    uint64_t submit(VkCommandBuffer graphicsCommandBuffer);
+    bool isComplete(uint64_t value);
+    Statistics getStatistics() const;
+
+private:
+    struct BufferCopy
+    {
+        VkBuffer source;
+        VkBuffer destination;
+        VkBufferCopy region;
+    };
+
+    struct ImageCopy
+    {
+        VkBuffer source;
+        VkImage image;
+        VkImageSubresourceRange range;
+        VkImageLayout finalLayout;
+        std::vector<VkBufferImageCopy> regions;
+    };
+
+    struct Batch
+    {
+        uint64_t value;
+        VkDeviceSize ringBytes;
+        VkCommandBuffer commandBuffer;
+        std::vector<MemoryAllocator::Buffer> stagingBuffers;
+    };
+
+    VulkanRenderer* renderer = nullptr;
+    VkDevice device = VK_NULL_HANDLE;
+    const VkAllocationCallbacks* allocator = nullptr;
+    mutable std::mutex mutex;
+
+    MemoryAllocator::Buffer ring;
+    VkDeviceSize ringSize = 0;
+    VkDeviceSize head = 0;
+    VkDeviceSize used = 0;
+    VkDeviceSize copyAlignment = 16;
+
+    VkCommandPool commandPool = VK_NULL_HANDLE;
+    std::vector<VkCommandBuffer> freeCommandBuffers;
+    std::deque<Batch> batches;
+
+    std::vector<BufferCopy> pendingBufferCopies;
+    std::vector<ImageCopy> pendingImageCopies;
+    std::vector<MemoryAllocator::Buffer> pendingStagingBuffers;
+    VkDeviceSize pendingRingBytes = 0;
+
+    // Released by submitted batches, acquired by the next submit()
+    std::vector<VkBuffer> acquireBuffers;
+    std::vector<ImageCopy> acquireImages;
+    uint64_t acquireValue = 0;
+
+    Statistics statistics = {};
+
+    // Returns the source buffer and offset the data was staged at
+    VkBuffer stage(const void* data, VkDeviceSize size, VkDeviceSize& offset);
+    bool allocateRange(VkDeviceSize size, VkDeviceSize& offset);
+    void reclaim();
+    void submitTransfers();
+};
+
+#endif //UPLOADMANAGER_H
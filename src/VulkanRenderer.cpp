@@ -3,13 +3,23 @@
 //
 
 #include "VulkanRenderer.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
 #include <stdexcept>
 #include <vector>
 
 #include "DebugConfig.h"
+#include "PipelineCacheFile.h"
 
 VulkanRenderer::VulkanRenderer()
-= default;
+{
+    // SOLID_HOST_ALLOCATOR=0 leaves host allocations to the driver, useful to compare against
+    const char* useHostAllocator = std::getenv("SOLID_HOST_ALLOCATOR");
+    if (!useHostAllocator || std::strcmp(useHostAllocator, "0") != 0)
+        allocator = hostAllocator.getCallbacks();
+}
 
 VkInstance VulkanRenderer::getInstance() const
 {
@@ -26,9 +36,34 @@ VkDevice VulkanRenderer::getDevice() const
     return device;
 }
 
-VkQueue VulkanRenderer::getQueue() const
+VkQueue VulkanRenderer::getQueue(QueueType type) const
+{
+    return queues[static_cast<uint32_t>(type)];
+}
+
+uint32_t VulkanRenderer::getQueueFamily(QueueType type) const
+{
+    return queueFamilies.family[static_cast<uint32_t>(type)];
+}
+
+const QueueFamilies& VulkanRenderer::getQueueFamilies() const
+{
+    return queueFamilies;
+}
+
+QueueOwnershipTransfer VulkanRenderer::getOwnershipTransfer(QueueType src, VkPipelineStageFlags srcStage,
+                                                            VkAccessFlags srcAccess, QueueType dst,
+                                                            VkPipelineStageFlags dstStage,
+                                                            VkAccessFlags dstAccess) const
 {
-    return queue;
+    QueueOwnershipTransfer transfer = {};
+    transfer.srcFamily = getQueueFamily(src);
+    transfer.dstFamily = getQueueFamily(dst);
+    transfer.srcStage = srcStage;
+    transfer.srcAccess = srcAccess;
+    transfer.dstStage = dstStage;
+    transfer.dstAccess = dstAccess;
+    return transfer;
 }
 
 const VkAllocationCallbacks* VulkanRenderer::getAllocator() const
@@ -36,6 +71,141 @@ const VkAllocationCallbacks* VulkanRenderer::getAllocator() const
     return allocator;
 }
 
+const HostAllocator& VulkanRenderer::getHostAllocator() const
+{
+    return hostAllocator;
+}
+
+uint64_t VulkanRenderer::submit(QueueType type, const QueueSubmission& submission)
+{
+    // Binary semaphores take part in a timeline submit, their values are ignored
+    std::vector<VkSemaphore> waitSemaphores;
+    std::vector<uint64_t> waitValues;
+    std::vector<VkPipelineStageFlags> waitStages;
+    for (const TimelineWait& wait : submission.waits)
+    {
+        if (wait.value == 0)
+            continue;
+        waitSemaphores.push_back(timelines[static_cast<uint32_t>(wait.queue)].getSemaphore());
+        waitValues.push_back(wait.value);
+        waitStages.push_back(wait.stage);
+    }
+    if (submission.binaryWait != VK_NULL_HANDLE)
+    {
+        waitSemaphores.push_back(submission.binaryWait);
+        waitValues.push_back(0);
+        waitStages.push_back(submission.binaryWaitStage);
+    }
+
+    GpuTimeline& timeline = timelines[static_cast<uint32_t>(type)];
+    VkSemaphore signalSemaphores[2] = {timeline.getSemaphore(), submission.binarySignal};
+    uint64_t signalValues[2] = {0, 0};
+
+    VkTimelineSemaphoreSubmitInfo timelineInfo = {};
+    timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    timelineInfo.waitSemaphoreValueCount = static_cast<uint32_t>(waitValues.size());
+    timelineInfo.pWaitSemaphoreValues = waitValues.data();
+    timelineInfo.signalSemaphoreValueCount = submission.binarySignal != VK_NULL_HANDLE ? 2 : 1;
+    timelineInfo.pSignalSemaphoreValues = signalValues;
+
+    VkSubmitInfo submitInfo = {};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.pNext = &timelineInfo;
+    submitInfo.waitSemaphoreCount = static_cast<uint32_t>(waitSemaphores.size());
+    submitInfo.pWaitSemaphores = waitSemaphores.data();
+    submitInfo.pWaitDstStageMask = waitStages.data();
+    submitInfo.commandBufferCount = static_cast<uint32_t>(submission.commandBuffers.size());
+    submitInfo.pCommandBuffers = submission.commandBuffers.data();
+    submitInfo.signalSemaphoreCount = timelineInfo.signalSemaphoreValueCount;
+    submitInfo.pSignalSemaphores = signalSemaphores;
+
+    // Values must reach the queue in increasing order, so they are handed out under the queue lock
+    std::lock_guard<std::mutex> lock(getQueueMutex(type));
+    signalValues[0] = timeline.advance();
+    if (vkQueueSubmit(getQueue(type), 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS)
+    {
+        throw std::runtime_error("[Vulkan] Failed to submit to queue!");
+    }
+    return signalValues[0];
+}
+
+GpuTimeline& VulkanRenderer::getTimeline(QueueType type)
+{
+    return timelines[static_cast<uint32_t>(type)];
+}
+
+void VulkanRenderer::waitFor(QueueType type, uint64_t value)
+{
+    timelines[static_cast<uint32_t>(type)].waitFor(value);
+}
+
+void VulkanRenderer::addFrameWait(QueueType queue, uint64_t value, VkPipelineStageFlags stage)
+{
+    TimelineWait wait = {};
+    wait.queue = queue;
+    wait.value = value;
+    wait.stage = stage;
+    frameWaits.push_back(wait);
+}
+
+DescriptorCache& VulkanRenderer::getDescriptorCache()
+{
+    return descriptorCache;
+}
+
+DescriptorAllocator& VulkanRenderer::getFrameDescriptors()
+{
+    return frames[frameIndex].descriptors;
+}
+
+std::mutex& VulkanRenderer::getQueueMutex(QueueType type)
+{
+    // Types sharing a VkQueue share the mutex of the first of them
+    for (uint32_t t = 0; t < QUEUE_TYPE_COUNT; t++)
+        if (queues[t] == queues[static_cast<uint32_t>(type)])
+            return queueMutexes[t];
+    return queueMutexes[static_cast<uint32_t>(type)];
+}
+
+void VulkanRenderer::setPipelineCachePath(const std::string& path)
+{
+    pipelineCachePath = path;
+}
+
+VkPipelineCache VulkanRenderer::getPipelineCache() const
+{
+    return pipelineCache;
+}
+
+MemoryAllocator& VulkanRenderer::getMemoryAllocator()
+{
+    return memoryAllocator;
+}
+
+MemoryAllocator::Buffer VulkanRenderer::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage,
+                                                     VkMemoryPropertyFlags memoryProperties)
+{
+    return memoryAllocator.createBuffer(size, usage, memoryProperties);
+}
+
+void VulkanRenderer::destroyBuffer(MemoryAllocator::Buffer& buffer)
+{
+    if (buffer.buffer != VK_NULL_HANDLE)
+        descriptorCache.invalidateBuffer(buffer.buffer);
+    memoryAllocator.destroyBuffer(buffer);
+}
+
+MemoryAllocator::Image VulkanRenderer::createImage(const VkImageCreateInfo& imageInfo,
+                                                   VkMemoryPropertyFlags memoryProperties)
+{
+    return memoryAllocator.createImage(imageInfo, memoryProperties);
+}
+
+void VulkanRenderer::destroyImage(MemoryAllocator::Image& image)
+{
+    memoryAllocator.destroyImage(image);
+}
+
 bool isValidationLayerSupported(const char* layerName)
 {
     uint32_t layerCount;
@@ -55,6 +225,14 @@ bool isValidationLayerSupported(const char* layerName)
     return false;
 }
 
+bool VulkanRenderer::isExtensionEnabled(const char* extension) const
+{
+    for (const std::string& enabled : enabledExtensions)
+        if (enabled == extension)
+            return true;
+    return false;
+}
+
 bool VulkanRenderer::IsExtensionAvailable(const std::vector<VkExtensionProperties>& properties, const char* extension)
 {
     for (const VkExtensionProperties& p : properties)
@@ -137,111 +315,837 @@ void VulkanRenderer::createInstance(const std::vector<const char*>& requestedIns
 
     if (DebugConfig::isDebug())
         setupDebugUtils();
+}
 
-    setupDevices();
+void VulkanRenderer::createDevice(const DeviceRequirements& requirements)
+{
+    if (instance == VK_NULL_HANDLE)
+    {
+        throw std::runtime_error("[Vulkan] createInstance() must be called before createDevice()!");
+    }
+    if (device != VK_NULL_HANDLE)
+        return;
+
+    // Frame pacing and cross queue dependencies are built on timeline semaphores,
+    // render graph barriers on synchronization2 and drawing on dynamic rendering
+    DeviceRequirements deviceRequirements = requirements;
+    if (deviceRequirements.minApiVersion < VK_API_VERSION_1_3)
+        deviceRequirements.minApiVersion = VK_API_VERSION_1_3;
+    deviceRequirements.features12.timelineSemaphore = VK_TRUE;
+    deviceRequirements.features13.synchronization2 = VK_TRUE;
+    deviceRequirements.features13.dynamicRendering = VK_TRUE;
+    MemoryAllocator::addRequirements(deviceRequirements);
+    BindlessRegistry::addRequirements(deviceRequirements);
+    setupDevices(deviceRequirements);
 }
 
-void VulkanRenderer::setupDevices()
+void VulkanRenderer::setupDevices(const DeviceRequirements& requirements)
 {
-    physicalDevice = selectPhysicalDevice();
-    DebugConfig::verbose("[Vulkan] Physical device found");
+    physicalDevice = DeviceSelector::select(instance, requirements);
+    vkGetPhysicalDeviceProperties(physicalDevice, &physicalDeviceProperties);
+    // D16 is the only depth format every device has to support as attachment
+    depthFormat = VK_FORMAT_D16_UNORM;
+    VkFormatProperties depthProperties;
+    vkGetPhysicalDeviceFormatProperties(physicalDevice, VK_FORMAT_D32_SFLOAT, &depthProperties);
+    if (depthProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT)
+        depthFormat = VK_FORMAT_D32_SFLOAT;
+    DebugConfig::verbose("[Vulkan] Physical device found: %s", physicalDeviceProperties.deviceName);
+
+    queueFamilies = QueueFamilies::find(physicalDevice, requirements.presentSurface);
+    for (uint32_t t = 0; t < QUEUE_TYPE_COUNT; t++)
+    {
+        const QueueType type = static_cast<QueueType>(t);
+        DebugConfig::verbose("[Vulkan] %s queue: family %u index %u%s", QueueFamilies::getName(type),
+                             queueFamilies.family[t], queueFamilies.index[t],
+                             queueFamilies.isDedicated(type) ? "" : " (shared with graphics)");
+    }
+
+    // The selector checked the required extensions, the optional ones are negotiated here
+    const std::vector<const char*> deviceExtensions = DeviceSelector::getEnabledExtensions(physicalDevice,
+                                                                                           requirements);
+    enabledExtensions.assign(deviceExtensions.begin(), deviceExtensions.end());
+    for (const char* extension : deviceExtensions)
+        DebugConfig::verbose("[Vulkan] Device extension %s enabled", extension);
 
-    uint32_t queueCount = 0;
-    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueCount, nullptr);
-    auto* queues = static_cast<VkQueueFamilyProperties*>(malloc(sizeof(VkQueueFamilyProperties) * queueCount));
-    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueCount, queues);
-    for (uint32_t i = 0; i < queueCount; i++)
+    // Feature structs of the enabled extensions go after the core ones, one per type
+    std::vector<std::vector<uint8_t>> extensionFeatures;
+    for (const ExtensionFeatures& features : requirements.extensionFeatures)
     {
-        if (queues[i].queueFlags & VK_QUEUE_GRAPHICS_BIT)
+        if (!isExtensionEnabled(features.extension))
+            continue;
+        const VkStructureType type = reinterpret_cast<const VkBaseInStructure*>(features.data.data())->sType;
+        std::vector<uint8_t>* merged = nullptr;
+        for (std::vector<uint8_t>& chained : extensionFeatures)
+            if (reinterpret_cast<const VkBaseInStructure*>(chained.data())->sType == type)
+                merged = &chained;
+        if (!merged)
         {
-            queueFamily = i;
+            extensionFeatures.push_back(features.data);
+            continue;
         }
+        VkBool32* enabled = reinterpret_cast<VkBool32*>(merged->data() + sizeof(VkBaseOutStructure));
+        const VkBool32* requested = reinterpret_cast<const VkBool32*>(features.data.data() +
+                                                                       sizeof(VkBaseOutStructure));
+        for (size_t i = 0; i < (merged->size() - sizeof(VkBaseOutStructure)) / sizeof(VkBool32); i++)
+            enabled[i] = enabled[i] || requested[i];
     }
-    free(queues);
-    if (queueFamily == -1)
+    void* featureChain = nullptr;
+    for (std::vector<uint8_t>& features : extensionFeatures)
     {
-        throw std::runtime_error("[Vulkan] Failed to find any graphics queue families!");
+        VkBaseOutStructure* header = reinterpret_cast<VkBaseOutStructure*>(features.data());
+        header->pNext = static_cast<VkBaseOutStructure*>(featureChain);
+        featureChain = header;
     }
-    DebugConfig::verbose("[Vulkan] QueueFamily found: %d", queueFamily);
 
-    // Logical device with 1 queue
-    // Get available extensions
-    uint32_t devicePropertiesCount;
-    std::vector<VkExtensionProperties> deviceSupportedExtensions;
-    vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &devicePropertiesCount, nullptr);
-    deviceSupportedExtensions.resize(devicePropertiesCount);
-    vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &devicePropertiesCount,
-                                         deviceSupportedExtensions.data());
-
-
-    // In case of needed extension on physical device
-    std::vector<const char*> deviceExtensions;
-
-    constexpr float queuePriority[] = {0.1f};
-    VkDeviceQueueCreateInfo queueInfo[1] = {};
-    queueInfo[0].sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
-    queueInfo[0].queueFamilyIndex = queueFamily;
-    queueInfo[0].queueCount = 1;
-    queueInfo[0].pQueuePriorities = queuePriority;
+    // Logical device with one queue per QueueType, shared when the hardware has no separate queue
+    std::vector<float> queuePriorities;
+    const std::vector<VkDeviceQueueCreateInfo> queueInfos = queueFamilies.getCreateInfos(queuePriorities);
 
     VkDeviceCreateInfo createInfo = {};
     createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
-    createInfo.queueCreateInfoCount = sizeof(queueInfo) / sizeof(queueInfo[0]);
-    createInfo.pQueueCreateInfos = queueInfo;
+    createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueInfos.size());
+    createInfo.pQueueCreateInfos = queueInfos.data();
     createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
     createInfo.ppEnabledExtensionNames = deviceExtensions.data();
+    createInfo.pEnabledFeatures = &requirements.features;
+    VkPhysicalDeviceVulkan13Features features13 = requirements.features13;
+    features13.pNext = featureChain;
+    VkPhysicalDeviceVulkan12Features features12 = requirements.features12;
+    features12.pNext = &features13;
+    VkPhysicalDeviceVulkan11Features features11 = requirements.features11;
+    features11.pNext = &features12;
+    createInfo.pNext = &features11;
     VkResult err = vkCreateDevice(physicalDevice, &createInfo, allocator, &device);
     if (err != VK_SUCCESS)
     {
         throw std::runtime_error("[Vulkan] Failed to create logical device!");
     }
-    vkGetDeviceQueue(device, queueFamily, 0, &queue);
+    for (uint32_t t = 0; t < QUEUE_TYPE_COUNT; t++)
+    {
+        vkGetDeviceQueue(device, queueFamilies.family[t], queueFamilies.index[t], &queues[t]);
+        timelines[t].init(device, allocator);
+    }
     DebugConfig::verbose("[Vulkan] Logical device created");
 
+    // SOLID_WORKERS=n overrides the worker thread count, 0 is one per hardware thread
+    const char* workers = std::getenv("SOLID_WORKERS");
+    jobs.init(workers ? static_cast<uint32_t>(std::strtoul(workers, nullptr, 10)) : 0);
+    memoryAllocator.init(physicalDevice, device, allocator,
+                         isExtensionEnabled(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME),
+                         isExtensionEnabled(VK_EXT_MEMORY_PRIORITY_EXTENSION_NAME));
+    uploadManager.init(*this, 32ull << 20);
+    bindless.init(*this, 16384, 4096, 256);
+    renderGraph.init(*this);
+
     // Descriptor
-    VkDescriptorPoolSize descriptorPoolSizes[] = {
-        {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1}
-    };
-    VkDescriptorPoolCreateInfo poolInfo = {};
-    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-    poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
-    poolInfo.maxSets = 1;
-    poolInfo.poolSizeCount = static_cast<uint32_t>(sizeof(descriptorPoolSizes) / sizeof(descriptorPoolSizes[0]));
-    poolInfo.pPoolSizes = descriptorPoolSizes;
-    err = vkCreateDescriptorPool(device, &poolInfo, allocator, &descriptorPool);
+    descriptorCache.init(device, allocator);
+
+    setupPipelineCache();
+    pipelineCompiler.init(*this);
+    // Shaders are compiled next to the executable by the build
+    const char* basePath = SDL_GetBasePath();
+    shaderLibrary.init(*this, std::string(basePath ? basePath : "") + "shaders/");
+}
+
+void VulkanRenderer::setupPipelineCache()
+{
+    const auto start = std::chrono::steady_clock::now();
+    const std::vector<char> initialData = PipelineCacheFile::read(pipelineCachePath, physicalDeviceProperties);
+
+    VkPipelineCacheCreateInfo cacheInfo = {};
+    cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    cacheInfo.initialDataSize = initialData.size();
+    cacheInfo.pInitialData = initialData.empty() ? nullptr : initialData.data();
+    VkResult err = vkCreatePipelineCache(device, &cacheInfo, allocator, &pipelineCache);
+    if (err != VK_SUCCESS && !initialData.empty())
+    {
+        // The driver may still reject a blob that passed our checks, start from an empty cache then
+        DebugConfig::warning("[Vulkan] Driver rejected the pipeline cache data, starting empty");
+        cacheInfo.initialDataSize = 0;
+        cacheInfo.pInitialData = nullptr;
+        err = vkCreatePipelineCache(device, &cacheInfo, allocator, &pipelineCache);
+    }
     if (err != VK_SUCCESS)
     {
-        throw std::runtime_error("[Vulkan] Failed to create descriptor pool!");
+        throw std::runtime_error("[Vulkan] Failed to create pipeline cache!");
+    }
+
+    const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    DebugConfig::verbose("[Vulkan] Pipeline cache created from %zu bytes in %.3f ms", initialData.size(),
+                         elapsed.count());
+}
+
+VkPipelineCache VulkanRenderer::createThreadPipelineCache()
+{
+    std::lock_guard<std::mutex> lock(pipelineCacheMutex);
+    // Seeded with the main cache, so pipelines loaded from disk still hit
+    std::vector<char> initialData;
+    size_t dataSize = 0;
+    if (vkGetPipelineCacheData(device, pipelineCache, &dataSize, nullptr) == VK_SUCCESS)
+    {
+        initialData.resize(dataSize);
+        if (vkGetPipelineCacheData(device, pipelineCache, &dataSize, initialData.data()) != VK_SUCCESS)
+            dataSize = 0;
+        initialData.resize(dataSize);
+    }
+
+    VkPipelineCacheCreateInfo cacheInfo = {};
+    cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    cacheInfo.initialDataSize = initialData.size();
+    cacheInfo.pInitialData = initialData.empty() ? nullptr : initialData.data();
+    VkPipelineCache cache = VK_NULL_HANDLE;
+    if (vkCreatePipelineCache(device, &cacheInfo, allocator, &cache) != VK_SUCCESS)
+    {
+        throw std::runtime_error("[Vulkan] Failed to create thread pipeline cache!");
+    }
+    threadPipelineCaches.push_back(cache);
+    return cache;
+}
+
+void VulkanRenderer::releaseThreadPipelineCache(VkPipelineCache cache)
+{
+    std::lock_guard<std::mutex> lock(pipelineCacheMutex);
+    for (auto it = threadPipelineCaches.begin(); it != threadPipelineCaches.end(); ++it)
+    {
+        if (*it != cache)
+            continue;
+
+        if (vkMergePipelineCaches(device, pipelineCache, 1, &cache) != VK_SUCCESS)
+            DebugConfig::warning("[Vulkan] Failed to merge thread pipeline cache");
+        vkDestroyPipelineCache(device, cache, allocator);
+        threadPipelineCaches.erase(it);
+        return;
+    }
+}
+
+void VulkanRenderer::savePipelineCache()
+{
+    if (pipelineCache == VK_NULL_HANDLE)
+        return;
+
+    std::lock_guard<std::mutex> lock(pipelineCacheMutex);
+    if (!threadPipelineCaches.empty())
+    {
+        if (vkMergePipelineCaches(device, pipelineCache, static_cast<uint32_t>(threadPipelineCaches.size()),
+                                  threadPipelineCaches.data()) != VK_SUCCESS)
+            DebugConfig::warning("[Vulkan] Failed to merge thread pipeline caches");
+    }
+
+    size_t dataSize = 0;
+    if (vkGetPipelineCacheData(device, pipelineCache, &dataSize, nullptr) != VK_SUCCESS)
+    {
+        DebugConfig::warning("[Vulkan] Failed to query pipeline cache size");
+        return;
+    }
+    std::vector<char> data(dataSize);
+    if (vkGetPipelineCacheData(device, pipelineCache, &dataSize, data.data()) != VK_SUCCESS)
+    {
+        DebugConfig::warning("[Vulkan] Failed to retrieve pipeline cache data");
+        return;
+    }
+    data.resize(dataSize);
+
+    if (PipelineCacheFile::write(pipelineCachePath, physicalDeviceProperties, data))
+        DebugConfig::verbose("[Vulkan] Pipeline cache saved: %zu bytes", data.size());
+}
+
+PipelineCompiler& VulkanRenderer::getPipelineCompiler()
+{
+    return pipelineCompiler;
+}
+
+ShaderLibrary& VulkanRenderer::getShaderLibrary()
+{
+    return shaderLibrary;
+}
+
+void VulkanRenderer::destroyPipelineCache()
+{
+    savePipelineCache();
+
+    for (VkPipelineCache cache : threadPipelineCaches)
+        vkDestroyPipelineCache(device, cache, allocator);
+    threadPipelineCaches.clear();
+
+    vkDestroyPipelineCache(device, pipelineCache, allocator);
+    pipelineCache = VK_NULL_HANDLE;
+    DebugConfig::verbose("[Vulkan] Destroying Vulkan pipeline cache");
+}
+
+void VulkanRenderer::createSwapchain(VkSurfaceKHR surfaceHandle, uint32_t width, uint32_t height,
+                                     const SwapchainConfig& config)
+{
+    if (device == VK_NULL_HANDLE)
+    {
+        throw std::runtime_error("[Vulkan] createDevice() must be called before createSwapchain()!");
+    }
+    surface = surfaceHandle;
+    swapchainConfig = config;
+    if (swapchainConfig.framesInFlight == 0)
+        swapchainConfig.framesInFlight = 1;
+    surfaceWidth = width;
+    surfaceHeight = height;
+
+    swapchain.init(physicalDevice, device, surface, allocator);
+    swapchainValid = swapchain.create(surfaceWidth, surfaceHeight, swapchainConfig.presentMode);
+    setupFrames();
+}
+
+void VulkanRenderer::resize(uint32_t width, uint32_t height)
+{
+    if (headless)
+        return;
+    if (width == surfaceWidth && height == surfaceHeight)
+        return;
+    surfaceWidth = width;
+    surfaceHeight = height;
+    swapchainDirty = true;
+}
+
+void VulkanRenderer::setPresentMode(VkPresentModeKHR presentMode)
+{
+    if (headless)
+        return;
+    swapchainConfig.presentMode = presentMode;
+    swapchainDirty = true;
+}
+
+VkPresentModeKHR VulkanRenderer::getPresentMode() const
+{
+    return swapchain.getPresentMode();
+}
+
+bool VulkanRenderer::isPresentModeSupported(VkPresentModeKHR presentMode) const
+{
+    return !headless && swapchain.isPresentModeSupported(presentMode);
+}
+
+void VulkanRenderer::createOffscreen(uint32_t width, uint32_t height, uint32_t framesInFlight)
+{
+    if (device == VK_NULL_HANDLE)
+    {
+        throw std::runtime_error("[Vulkan] createDevice() must be called before createOffscreen()!");
     }
-    DebugConfig::verbose("[Vulkan] Descriptor pool created");
+    headless = true;
+    swapchainConfig.framesInFlight = framesInFlight > 0 ? framesInFlight : 1;
+    offscreenExtent = {width, height};
+
+    // Every frame slot renders into its own image, the slot wait already guarantees it is free again
+    for (uint32_t i = 0; i < swapchainConfig.framesInFlight; i++)
+    {
+        VkImageCreateInfo imageInfo = {};
+        imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageInfo.format = VK_FORMAT_R8G8B8A8_UNORM;
+        imageInfo.extent = {width, height, 1};
+        imageInfo.mipLevels = 1;
+        imageInfo.arrayLayers = 1;
+        imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+        imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT |
+            VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+        imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        offscreenImages.push_back(createImage(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT));
+
+        VkImageViewCreateInfo viewInfo = {};
+        viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        viewInfo.image = offscreenImages.back().image;
+        viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        viewInfo.format = imageInfo.format;
+        viewInfo.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+        offscreenViews.push_back(VK_NULL_HANDLE);
+        if (vkCreateImageView(device, &viewInfo, allocator, &offscreenViews.back()) != VK_SUCCESS)
+        {
+            throw std::runtime_error("[Vulkan] Failed to create offscreen image view!");
+        }
+    }
+    readbackBuffer = createBuffer(static_cast<VkDeviceSize>(width) * height * 4, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                  VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+
+    swapchainValid = true;
+    setupFrames();
+    DebugConfig::verbose("[Vulkan] Offscreen targets created: %ux%u", width, height);
+}
+
+bool VulkanRenderer::isHeadless() const
+{
+    return headless;
+}
+
+void VulkanRenderer::requestReadback()
+{
+    if (headless)
+        readbackRequested = true;
+}
+
+bool VulkanRenderer::getReadback(std::vector<uint8_t>& pixels)
+{
+    if (readbackValue == 0)
+        return false;
+    waitFor(QueueType::Graphics, readbackValue);
+    memoryAllocator.invalidate(readbackBuffer.allocation);
+    const size_t size = static_cast<size_t>(offscreenExtent.width) * offscreenExtent.height * 4;
+    pixels.resize(size);
+    std::memcpy(pixels.data(), readbackBuffer.allocation->mapped, size);
+    return true;
+}
+
+VkExtent2D VulkanRenderer::getRenderExtent() const
+{
+    return headless ? offscreenExtent : swapchain.getExtent();
+}
+
+void VulkanRenderer::destroyOffscreen()
+{
+    for (VkImageView view : offscreenViews)
+        if (view != VK_NULL_HANDLE)
+            vkDestroyImageView(device, view, allocator);
+    offscreenViews.clear();
+    for (MemoryAllocator::Image& image : offscreenImages)
+        destroyImage(image);
+    offscreenImages.clear();
+    if (readbackBuffer.buffer != VK_NULL_HANDLE)
+        destroyBuffer(readbackBuffer);
+}
+
+VkFormat VulkanRenderer::getTargetFormat() const
+{
+    return headless ? VK_FORMAT_R8G8B8A8_UNORM : swapchain.getFormat();
+}
+
+uint32_t VulkanRenderer::getTargetImageCount() const
+{
+    return headless ? static_cast<uint32_t>(offscreenImages.size()) : swapchain.getImageCount();
+}
+
+VkImage VulkanRenderer::getTargetImage(uint32_t index) const
+{
+    return headless ? offscreenImages[index].image : swapchain.getImage(index);
+}
+
+VkImageView VulkanRenderer::getTargetImageView(uint32_t index) const
+{
+    return headless ? offscreenViews[index] : swapchain.getImageView(index);
+}
+
+uint32_t VulkanRenderer::addFormatListener(const std::function<void(VkFormat format)>& callback)
+{
+    formatListeners.emplace_back(nextFormatListener, callback);
+    return nextFormatListener++;
+}
+
+void VulkanRenderer::removeFormatListener(uint32_t id)
+{
+    formatListeners.erase(std::remove_if(formatListeners.begin(), formatListeners.end(),
+                                         [id](const std::pair<uint32_t, std::function<void(VkFormat format)>>& listener)
+                                         {
+                                             return listener.first == id;
+                                         }), formatListeners.end());
+}
+
+VkFormat VulkanRenderer::getRenderFormat() const
+{
+    return getTargetFormat();
+}
+
+VkFormat VulkanRenderer::getDepthFormat() const
+{
+    return depthFormat;
 }
 
-VkPhysicalDevice VulkanRenderer::selectPhysicalDevice() const
+void VulkanRenderer::beginRendering(VkRenderingFlags flags)
 {
-    uint32_t deviceCount = 0;
-    VkResult err = vkEnumeratePhysicalDevices(instance, &deviceCount, nullptr);
-    if (err != VK_SUCCESS || deviceCount <= 0)
+    // The image is cleared and transitioned by the render graph, rendering only loads and stores it
+    VkRenderingAttachmentInfo colorAttachment = {};
+    colorAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
+    colorAttachment.imageView = getTargetImageView(imageIndex);
+    colorAttachment.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+    colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+
+    VkRenderingInfo renderingInfo = {};
+    renderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO;
+    renderingInfo.flags = flags;
+    renderingInfo.renderArea.extent = getRenderExtent();
+    renderingInfo.layerCount = 1;
+    renderingInfo.colorAttachmentCount = 1;
+    renderingInfo.pColorAttachments = &colorAttachment;
+    vkCmdBeginRendering(frames[frameIndex].commandBuffer, &renderingInfo);
+}
+
+void VulkanRenderer::beginRendering(VkCommandBuffer commandBuffer, VkImageView colorView, VkImageView depthView,
+                                    VkRenderingFlags flags) const
+{
+    VkRenderingAttachmentInfo colorAttachment = {};
+    colorAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
+    colorAttachment.imageView = colorView;
+    colorAttachment.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+    colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    VkRenderingAttachmentInfo depthAttachment = {};
+    depthAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
+    depthAttachment.imageView = depthView;
+    depthAttachment.imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+    depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    depthAttachment.clearValue.depthStencil = {1.0f, 0};
+
+    VkRenderingInfo renderingInfo = {};
+    renderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO;
+    renderingInfo.flags = flags;
+    renderingInfo.renderArea.extent = getRenderExtent();
+    renderingInfo.layerCount = 1;
+    renderingInfo.colorAttachmentCount = 1;
+    renderingInfo.pColorAttachments = &colorAttachment;
+    renderingInfo.pDepthAttachment = &depthAttachment;
+    vkCmdBeginRendering(commandBuffer, &renderingInfo);
+}
+
+void VulkanRenderer::endRendering()
+{
+    vkCmdEndRendering(frames[frameIndex].commandBuffer);
+}
+
+void VulkanRenderer::recordParallel(uint32_t count,
+                                    const std::function<void(VkCommandBuffer commandBuffer, uint32_t index)>& record,
+                                    VkFormat depthFormat)
+{
+    if (count == 0)
+        return;
+    FrameData& frame = frames[frameIndex];
+    const VkFormat colorFormat = getTargetFormat();
+    VkCommandBufferInheritanceRenderingInfo renderingInfo = {};
+    renderingInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO;
+    renderingInfo.colorAttachmentCount = 1;
+    renderingInfo.pColorAttachmentFormats = &colorFormat;
+    renderingInfo.depthAttachmentFormat = depthFormat;
+    renderingInfo.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+    VkCommandBufferInheritanceInfo inheritanceInfo = {};
+    inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+    inheritanceInfo.pNext = &renderingInfo;
+
+    // Slots are filled by index, so the execution order does not depend on the thread scheduling
+    std::vector<VkCommandBuffer> secondaries(count);
+    jobs.parallelFor(count, [&](uint32_t index, uint32_t thread)
     {
-        throw std::runtime_error("[Vulkan] Failed to find GPUs with Vulkan support!");
+        ThreadCommands& commands = frame.threadCommands[thread];
+        if (commands.used == commands.commandBuffers.size())
+        {
+            VkCommandBufferAllocateInfo commandBufferInfo = {};
+            commandBufferInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+            commandBufferInfo.commandPool = commands.commandPool;
+            commandBufferInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+            commandBufferInfo.commandBufferCount = 1;
+            VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+            if (vkAllocateCommandBuffers(device, &commandBufferInfo, &commandBuffer) != VK_SUCCESS)
+            {
+                throw std::runtime_error("[Vulkan] Failed to allocate secondary command buffer!");
+            }
+            commands.commandBuffers.push_back(commandBuffer);
+        }
+        const VkCommandBuffer commandBuffer = commands.commandBuffers[commands.used++];
+
+        VkCommandBufferBeginInfo beginInfo = {};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT |
+            VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+        beginInfo.pInheritanceInfo = &inheritanceInfo;
+        vkBeginCommandBuffer(commandBuffer, &beginInfo);
+        record(commandBuffer, index);
+        if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS)
+        {
+            throw std::runtime_error("[Vulkan] Failed to record secondary command buffer!");
+        }
+        secondaries[index] = commandBuffer;
+    });
+    vkCmdExecuteCommands(frame.commandBuffer, count, secondaries.data());
+}
+
+JobSystem& VulkanRenderer::getJobSystem()
+{
+    return jobs;
+}
+
+void VulkanRenderer::setupFrames()
+{
+    frames.resize(swapchainConfig.framesInFlight);
+    for (FrameData& frame : frames)
+    {
+        VkCommandPoolCreateInfo poolInfo = {};
+        poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+        poolInfo.queueFamilyIndex = getQueueFamily(QueueType::Graphics);
+        if (vkCreateCommandPool(device, &poolInfo, allocator, &frame.commandPool) != VK_SUCCESS)
+        {
+            throw std::runtime_error("[Vulkan] Failed to create frame command pool!");
+        }
+
+        VkCommandBufferAllocateInfo commandBufferInfo = {};
+        commandBufferInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        commandBufferInfo.commandPool = frame.commandPool;
+        commandBufferInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        commandBufferInfo.commandBufferCount = 1;
+        if (vkAllocateCommandBuffers(device, &commandBufferInfo, &frame.commandBuffer) != VK_SUCCESS)
+        {
+            throw std::runtime_error("[Vulkan] Failed to allocate frame command buffer!");
+        }
+
+        frame.descriptors.init(device, allocator);
+
+        // One pool per recording thread, command pools must not be used by two threads at once
+        frame.threadCommands.resize(jobs.getThreadCount());
+        for (ThreadCommands& commands : frame.threadCommands)
+        {
+            if (vkCreateCommandPool(device, &poolInfo, allocator, &commands.commandPool) != VK_SUCCESS)
+            {
+                throw std::runtime_error("[Vulkan] Failed to create thread command pool!");
+            }
+        }
+
+        // Value 0 is already reached, the first wait on every slot returns immediately
+        frame.timelineValue = 0;
+        VkSemaphoreCreateInfo semaphoreInfo = {};
+        semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+        if (vkCreateSemaphore(device, &semaphoreInfo, allocator, &frame.imageAvailable) != VK_SUCCESS)
+        {
+            throw std::runtime_error("[Vulkan] Failed to create frame synchronization objects!");
+        }
     }
-    std::vector<VkPhysicalDevice> devices(deviceCount);
+    profiler.init(physicalDevice, device, getQueueFamily(QueueType::Graphics), swapchainConfig.framesInFlight,
+                  allocator);
+    DebugConfig::verbose("[Vulkan] %u frames in flight", swapchainConfig.framesInFlight);
+}
 
-    err = vkEnumeratePhysicalDevices(instance, &deviceCount, devices.data());
-    if (err != VK_SUCCESS || deviceCount <= 0)
+void VulkanRenderer::destroyFrames()
+{
+    for (FrameData& frame : frames)
     {
-        throw std::runtime_error("[Vulkan] Failed to retrieve devices with vulkan support!");
+        if (frame.imageAvailable != VK_NULL_HANDLE)
+            vkDestroySemaphore(device, frame.imageAvailable, allocator);
+        if (frame.commandPool != VK_NULL_HANDLE)
+            vkDestroyCommandPool(device, frame.commandPool, allocator);
+        for (ThreadCommands& commands : frame.threadCommands)
+            if (commands.commandPool != VK_NULL_HANDLE)
+                vkDestroyCommandPool(device, commands.commandPool, allocator);
+        frame.descriptors.destroy();
     }
+    frames.clear();
+}
 
-    // Selection of discrete gpu, multiple gpus not implemented
-    for (const VkPhysicalDevice& device : devices)
+void VulkanRenderer::recreateSwapchain()
+{
+    // Resizes are rare, draining the device keeps the old images out of reach of in-flight frames
+    vkDeviceWaitIdle(device);
+    const VkFormat previousFormat = swapchain.getFormat();
+    swapchainValid = swapchain.create(surfaceWidth, surfaceHeight, swapchainConfig.presentMode);
+    swapchainDirty = false;
+    if (!swapchainValid)
+        return;
+    // Pipelines are built for the color format, a new one makes them incompatible
+    const VkFormat format = swapchain.getFormat();
+    if (format == previousFormat)
+        return;
+    DebugConfig::verbose("[Vulkan] Swapchain format changed to %d, requesting pipelines again",
+                         static_cast<int>(format));
+    const std::vector<std::pair<uint32_t, std::function<void(VkFormat format)>>> listeners = formatListeners;
+    for (const auto& listener : listeners)
+        listener.second(format);
+}
+
+bool VulkanRenderer::beginFrame()
+{
+    if (frames.empty())
+        return false;
+    if (swapchainDirty)
+        recreateSwapchain();
+    if (!swapchainValid)
+        return false;
+
+    // Reload listeners request their new pipelines before anything is recorded
+    shaderLibrary.update();
+    FrameData& frame = frames[frameIndex];
+    waitFor(QueueType::Graphics, frame.timelineValue);
+    bindless.collect();
+    memoryAllocator.updateBudget();
+    frame.descriptors.reset();
+
+    if (headless)
     {
-        VkPhysicalDeviceProperties deviceProperties;
-        vkGetPhysicalDeviceProperties(device, &deviceProperties);
-        if (deviceProperties.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU)
-            return device;
+        imageIndex = frameIndex;
+    }
+    else
+    {
+        const VkResult err = swapchain.acquire(frame.imageAvailable, imageIndex);
+        if (err == VK_ERROR_OUT_OF_DATE_KHR)
+        {
+            swapchainDirty = true;
+            return false;
+        }
+        if (err != VK_SUCCESS && err != VK_SUBOPTIMAL_KHR)
+        {
+            throw std::runtime_error("[Vulkan] Failed to acquire swapchain image!");
+        }
+        if (err == VK_SUBOPTIMAL_KHR)
+            swapchainDirty = true;
+    }
+
+    vkResetCommandPool(device, frame.commandPool, 0);
+    for (ThreadCommands& commands : frame.threadCommands)
+    {
+        vkResetCommandPool(device, commands.commandPool, 0);
+        commands.used = 0;
     }
 
-    return devices[0];
+    VkCommandBufferBeginInfo beginInfo = {};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkBeginCommandBuffer(frame.commandBuffer, &beginInfo);
+    profiler.beginFrame(frame.commandBuffer, frameIndex);
+    profiler.beginScope(frame.commandBuffer, "Frame");
+    // Everything uploaded since the last frame becomes visible to this one
+    const uint64_t uploadValue = uploadManager.submit(frame.commandBuffer);
+    if (uploadValue != 0)
+        addFrameWait(QueueType::Transfer, uploadValue, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+
+    // The acquire semaphore is waited on at the transfer stage, the clear is the first use of the image
+    renderGraph.reset();
+    const VkImage image = getTargetImage(imageIndex);
+    const RenderGraphImageInfo imageInfo = {getTargetFormat(), getRenderExtent()};
+    const RenderGraphState initial = {VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_2_TRANSFER_BIT, 0};
+    // Presentation needs no stage, a readback copies the offscreen image at the transfer stage
+    RenderGraphState final = {VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, VK_PIPELINE_STAGE_2_NONE, 0};
+    if (headless)
+        final = {VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_READ_BIT};
+    backbuffer = renderGraph.importImage("Backbuffer", image, getTargetImageView(imageIndex), imageInfo, initial,
+                                         final);
+    const RenderGraphResource target = backbuffer;
+    const VkClearColorValue color = clearColor;
+    renderGraph.addPass("Clear", [target](RenderGraph::PassBuilder& builder)
+                        {
+                            builder.transferDestination(target);
+                        }, [image, color](VkCommandBuffer commandBuffer)
+                        {
+                            const VkImageSubresourceRange range = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+                            vkCmdClearColorImage(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, &color,
+                                                 1, &range);
+                        });
+    return true;
+}
+
+void VulkanRenderer::endFrame()
+{
+    FrameData& frame = frames[frameIndex];
+
+    if (headless && readbackRequested)
+    {
+        const RenderGraphResource source = backbuffer;
+        const RenderGraphResource destination = renderGraph.importBuffer(
+            "Readback", readbackBuffer.buffer, VK_WHOLE_SIZE, {VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_2_NONE, 0},
+            {VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_2_HOST_BIT, VK_ACCESS_2_HOST_READ_BIT});
+        const VkImage image = getTargetImage(imageIndex);
+        const VkBuffer buffer = readbackBuffer.buffer;
+        const VkExtent2D extent = offscreenExtent;
+        renderGraph.addPass("Readback", [source, destination](RenderGraph::PassBuilder& builder)
+                            {
+                                builder.transferSource(source);
+                                builder.writeBuffer(destination, VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+                                                    VK_ACCESS_2_TRANSFER_WRITE_BIT);
+                                builder.sideEffects();
+                            }, [image, buffer, extent](VkCommandBuffer commandBuffer)
+                            {
+                                VkBufferImageCopy region = {};
+                                region.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+                                region.imageExtent = {extent.width, extent.height, 1};
+                                vkCmdCopyImageToBuffer(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                                                       buffer, 1, &region);
+                            });
+    }
+    renderGraph.execute(frame.commandBuffer);
+    profiler.endScope(frame.commandBuffer);
+    if (vkEndCommandBuffer(frame.commandBuffer) != VK_SUCCESS)
+    {
+        throw std::runtime_error("[Vulkan] Failed to record frame command buffer!");
+    }
+
+    QueueSubmission submission;
+    submission.commandBuffers.push_back(frame.commandBuffer);
+    if (!headless)
+    {
+        submission.binaryWait = frame.imageAvailable;
+        submission.binaryWaitStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+        submission.binarySignal = swapchain.getRenderFinishedSemaphore(imageIndex);
+    }
+    submission.waits.swap(frameWaits);
+    frameWaits.clear();
+    frame.timelineValue = submit(QueueType::Graphics, submission);
+
+    if (headless)
+    {
+        if (readbackRequested)
+            readbackValue = frame.timelineValue;
+        readbackRequested = false;
+    }
+    else
+    {
+        VkResult err;
+        {
+            std::lock_guard<std::mutex> lock(getQueueMutex(QueueType::Graphics));
+            err = swapchain.present(getQueue(QueueType::Graphics), imageIndex);
+        }
+        if (err == VK_ERROR_OUT_OF_DATE_KHR || err == VK_SUBOPTIMAL_KHR)
+            swapchainDirty = true;
+        else if (err != VK_SUCCESS)
+            throw std::runtime_error("[Vulkan] Failed to present swapchain image!");
+    }
+
+    frameIndex = (frameIndex + 1) % static_cast<uint32_t>(frames.size());
+    frameNumber++;
+}
+
+VkCommandBuffer VulkanRenderer::getCommandBuffer() const
+{
+    return frames[frameIndex].commandBuffer;
+}
+
+GpuProfiler& VulkanRenderer::getProfiler()
+{
+    return profiler;
+}
+
+UploadManager& VulkanRenderer::getUploadManager()
+{
+    return uploadManager;
+}
+
+BindlessRegistry& VulkanRenderer::getBindless()
+{
+    return bindless;
+}
+
+RenderGraph& VulkanRenderer::getRenderGraph()
+{
+    return renderGraph;
+}
+
+RenderGraphResource VulkanRenderer::getBackbuffer() const
+{
+    return backbuffer;
+}
+
+uint32_t VulkanRenderer::getFrameIndex() const
+{
+    return frameIndex;
+}
+
+uint32_t VulkanRenderer::getFramesInFlight() const
+{
+    return static_cast<uint32_t>(frames.size());
+}
+
+uint64_t VulkanRenderer::getFrameNumber() const
+{
+    return frameNumber;
 }
 
 void VulkanRenderer::setupDebugUtils()
@@ -303,12 +1207,29 @@ void VulkanRenderer::setupDebugUtils()
 
 void VulkanRenderer::cleanVulkan()
 {
-    if (descriptorPool != VK_NULL_HANDLE)
+    // Compilations run on the jobs, background jobs may still submit work
+    pipelineCompiler.destroy();
+    jobs.destroy();
+    shaderLibrary.destroy();
+    if (device != VK_NULL_HANDLE)
+    {
+        vkDeviceWaitIdle(device);
+    }
+    destroyFrames();
+    profiler.destroy();
+    uploadManager.destroy();
+    destroyOffscreen();
+    swapchain.destroy();
+    for (GpuTimeline& timeline : timelines)
+        timeline.destroy();
+    if (pipelineCache != VK_NULL_HANDLE)
     {
-        vkDestroyDescriptorPool(device, descriptorPool, allocator);
-        descriptorPool = VK_NULL_HANDLE;
-        DebugConfig::verbose("[Vulkan] Destroying Vulkan descriptor pool");
+        destroyPipelineCache();
     }
+    descriptorCache.destroy();
+    bindless.destroy();
+    renderGraph.destroy();
+    memoryAllocator.destroy();
     if (debugUtilsSupported && debugMessenger != VK_NULL_HANDLE)
     {
         vkDestroyDebugUtilsMessengerEXT(instance, debugMessenger, allocator);
@@ -321,12 +1242,23 @@ void VulkanRenderer::cleanVulkan()
         device = VK_NULL_HANDLE;
         DebugConfig::verbose("[Vulkan] Destroying Vulkan device");
     }
+    if (surface != VK_NULL_HANDLE)
+    {
+        vkDestroySurfaceKHR(instance, surface, allocator);
+        surface = VK_NULL_HANDLE;
+        DebugConfig::verbose("[Vulkan] Destroying Vulkan surface");
+    }
     if (instance != VK_NULL_HANDLE)
     {
         vkDestroyInstance(instance, allocator);
         instance = VK_NULL_HANDLE;
         DebugConfig::verbose("[Vulkan] Destroying Vulkan instance");
     }
+    if (allocator != nullptr)
+    {
+        // Anything still live at this point is leaked by the driver or by us
+        hostAllocator.logStatistics();
+    }
 }
 
 VulkanRenderer::~VulkanRenderer()
@@ -5,10 +5,28 @@
 #ifndef VULKANRENDERER_H
 #define VULKANRENDERER_H
 
+#include <functional>
+#include <mutex>
+#include <string>
 #include <vector>
 #include <vulkan/vulkan.h>
 #include <SDL3/SDL.h>
 
+#include "BindlessRegistry.h"
+#include "DescriptorAllocator.h"
+#include "DeviceSelector.h"
+#include "GpuProfiler.h"
+#include "GpuTimeline.h"
+#include "HostAllocator.h"
+#include "JobSystem.h"
+#include "MemoryAllocator.h"
+#include "PipelineCompiler.h"
+#include "QueueFamilies.h"
+#include "RenderGraph.h"
+#include "ShaderLibrary.h"
+#include "Swapchain.h"
+#include "UploadManager.h"
+
 class VulkanRenderer
 {
 public:
@@ -16,26 +34,201 @@ public:
     ~VulkanRenderer();
 
     void createInstance(const std::vector<const char*>& requestedInstanceExtensions);
+    // Picks the best physical device meeting the requirements and creates the logical device on it
+    void createDevice(const DeviceRequirements& requirements);
+    // Whether a required or optional device extension was enabled, fast paths check theirs before init()
+    bool isExtensionEnabled(const char* extension) const;
     VkInstance getInstance() const;
     VkPhysicalDevice getPhysicalDevice() const;
     VkDevice getDevice() const;
-    VkQueue getQueue() const;
+    VkQueue getQueue(QueueType type = QueueType::Graphics) const;
+    uint32_t getQueueFamily(QueueType type = QueueType::Graphics) const;
+    const QueueFamilies& getQueueFamilies() const;
+    // Ownership transfer description between the families of two queue types
+    QueueOwnershipTransfer getOwnershipTransfer(QueueType src, VkPipelineStageFlags srcStage, VkAccessFlags srcAccess,
+                                                QueueType dst, VkPipelineStageFlags dstStage,
+                                                VkAccessFlags dstAccess) const;
     const VkAllocationCallbacks* getAllocator() const;
+    const HostAllocator& getHostAllocator() const;
+
+    // Submits to the queue of `type` after the listed timeline points, returns the value its timeline
+    // reaches once the work is done. Thread safe, queues shared between types are serialized.
+    uint64_t submit(QueueType type, const QueueSubmission& submission);
+    GpuTimeline& getTimeline(QueueType type);
+    // Blocks the CPU until the queue of `type` reached `value`
+    void waitFor(QueueType type, uint64_t value);
+    // Makes the next frame submission wait on a point of another queue, e.g. a finished upload
+    void addFrameWait(QueueType queue, uint64_t value, VkPipelineStageFlags stage);
+    // Layouts and long-lived sets, deduplicated by content
+    DescriptorCache& getDescriptorCache();
+    // Sets that only live for the current frame, recycled when its slot comes around again
+    DescriptorAllocator& getFrameDescriptors();
+
+    // Must be called before createInstance() to take effect
+    void setPipelineCachePath(const std::string& path);
+    VkPipelineCache getPipelineCache() const;
+    // Worker threads record pipelines into their own cache, merged back into the main one on release
+    VkPipelineCache createThreadPipelineCache();
+    void releaseThreadPipelineCache(VkPipelineCache cache);
+    void savePipelineCache();
+    // Builds pipelines on the job system against the pipeline cache
+    PipelineCompiler& getPipelineCompiler();
+    ShaderLibrary& getShaderLibrary();
+
+    MemoryAllocator& getMemoryAllocator();
+    MemoryAllocator::Buffer createBuffer(VkDeviceSize size, VkBufferUsageFlags usage,
+                                         VkMemoryPropertyFlags memoryProperties);
+    void destroyBuffer(MemoryAllocator::Buffer& buffer);
+    MemoryAllocator::Image createImage(const VkImageCreateInfo& imageInfo, VkMemoryPropertyFlags memoryProperties);
+    void destroyImage(MemoryAllocator::Image& image);
+
+    // Takes ownership of the surface, it is destroyed together with the renderer
+    void createSwapchain(VkSurfaceKHR surface, uint32_t width, uint32_t height, const SwapchainConfig& config);
+    // Swapchain recreation is deferred to the next beginFrame()
+    void resize(uint32_t width, uint32_t height);
+    void setPresentMode(VkPresentModeKHR presentMode);
+    VkPresentModeKHR getPresentMode() const;
+    // False when headless
+    bool isPresentModeSupported(VkPresentModeKHR presentMode) const;
+    // Renders into offscreen images instead of a swapchain, for machines without a display or GPU
+    // (software ICDs such as lavapipe). One image per frame in flight, in R8G8B8A8_UNORM.
+    void createOffscreen(uint32_t width, uint32_t height, uint32_t framesInFlight);
+    bool isHeadless() const;
+    // Offscreen only: copies the image of the frame being recorded to host memory in endFrame()
+    void requestReadback();
+    // Waits for the last requested readback and returns it as tightly packed RGBA8 rows
+    bool getReadback(std::vector<uint8_t>& pixels);
+    // Size of the swapchain or offscreen images
+    VkExtent2D getRenderExtent() const;
+    // Format of the swapchain or offscreen images, the color format pipelines drawing to them are built for
+    VkFormat getRenderFormat() const;
+    // Depth attachment format of the device, D32 if it supports it and D16 otherwise
+    VkFormat getDepthFormat() const;
+    // Runs from beginFrame() when a recreated swapchain changed the render format. Pipelines built for the old
+    // format can't draw to the new images, so listeners request them again without the old one as fallback.
+    uint32_t addFormatListener(const std::function<void(VkFormat format)>& callback);
+    void removeFormatListener(uint32_t id);
+    // Dynamic rendering to the current image, loading and keeping its content. Used between beginFrame() and
+    // endFrame(), VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT for contents recorded with recordParallel()
+    void beginRendering(VkRenderingFlags flags = 0);
+    // Same for a render graph pass over the whole render extent, with `depthView` cleared to the far plane
+    void beginRendering(VkCommandBuffer commandBuffer, VkImageView colorView, VkImageView depthView,
+                        VkRenderingFlags flags = 0) const;
+    void endRendering();
+    // Inside rendering begun with secondary contents: records `count` secondary command buffers on the job
+    // system, each one from the recording thread's own pool of the current frame, and executes them in index
+    // order, whichever thread recorded them. One buffer per index, so split the work into a few chunks per thread.
+    // The rendering has one color attachment of the render format, and a depth one when `depthFormat` is set.
+    // Dynamic state is not inherited, every buffer sets its own viewport and scissor.
+    void recordParallel(uint32_t count,
+                        const std::function<void(VkCommandBuffer commandBuffer, uint32_t index)>& record,
+                        VkFormat depthFormat = VK_FORMAT_UNDEFINED);
+    JobSystem& getJobSystem();
+
+    // Waits for the frame slot, acquires a swapchain image and starts recording.
+    // Returns false when there is nothing to render to (minimized window, out of date swapchain).
+    bool beginFrame();
+    // Executes the frame's render graph, submits and presents
+    void endFrame();
+    VkCommandBuffer getCommandBuffer() const;
+    // Every frame is measured as the "Frame" scope, nest GpuScopes inside it
+    GpuProfiler& getProfiler();
+    // Uploads are submitted and acquired by the next beginFrame()
+    UploadManager& getUploadManager();
+    // Every sampled image, storage buffer and sampler addressed by index, see BindlessRegistry
+    BindlessRegistry& getBindless();
+    // Rebuilt every frame, passes added between beginFrame() and endFrame() run in order after the clear
+    RenderGraph& getRenderGraph();
+    // The swapchain or offscreen image of the current frame in the render graph
+    RenderGraphResource getBackbuffer() const;
+    uint32_t getFrameIndex() const;
+    uint32_t getFramesInFlight() const;
+    uint64_t getFrameNumber() const;
 
 private:
+    // Secondary command buffers of one recording thread, the pool is reset with its frame slot
+    struct ThreadCommands
+    {
+        VkCommandPool commandPool = VK_NULL_HANDLE;
+        std::vector<VkCommandBuffer> commandBuffers;
+        uint32_t used = 0;
+    };
+
+    struct FrameData
+    {
+        VkCommandPool commandPool = VK_NULL_HANDLE;
+        VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+        VkSemaphore imageAvailable = VK_NULL_HANDLE;
+        // Graphics timeline value signaled by the last submission of this slot
+        uint64_t timelineValue = 0;
+        DescriptorAllocator descriptors;
+        std::vector<ThreadCommands> threadCommands;
+    };
+
+    HostAllocator hostAllocator;
+    JobSystem jobs;
     VkAllocationCallbacks* allocator = nullptr;
     VkInstance instance = VK_NULL_HANDLE;
     VkPipelineCache pipelineCache = VK_NULL_HANDLE;
     VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
     VkDevice device = VK_NULL_HANDLE;
-    uint32_t queueFamily = static_cast<uint32_t>(-1);
-    VkQueue queue = VK_NULL_HANDLE;
-    VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+    QueueFamilies queueFamilies = {};
+    VkQueue queues[QUEUE_TYPE_COUNT] = {};
+    GpuTimeline timelines[QUEUE_TYPE_COUNT];
+    std::mutex queueMutexes[QUEUE_TYPE_COUNT];
+    DescriptorCache descriptorCache;
+    MemoryAllocator memoryAllocator;
+    VkPhysicalDeviceProperties physicalDeviceProperties = {};
+    VkFormat depthFormat = VK_FORMAT_UNDEFINED;
+
+    std::string pipelineCachePath = "pipeline_cache.bin";
+    std::vector<VkPipelineCache> threadPipelineCaches;
+    std::mutex pipelineCacheMutex;
+    PipelineCompiler pipelineCompiler;
+    ShaderLibrary shaderLibrary;
+
+    VkSurfaceKHR surface = VK_NULL_HANDLE;
+    Swapchain swapchain;
+    SwapchainConfig swapchainConfig;
+    uint32_t surfaceWidth = 0;
+    uint32_t surfaceHeight = 0;
+    bool swapchainDirty = false;
+    bool swapchainValid = false;
+    std::vector<std::pair<uint32_t, std::function<void(VkFormat format)>>> formatListeners;
+    uint32_t nextFormatListener = 1;
+    bool headless = false;
+    VkExtent2D offscreenExtent = {};
+    std::vector<MemoryAllocator::Image> offscreenImages;
+    std::vector<VkImageView> offscreenViews;
+    MemoryAllocator::Buffer readbackBuffer;
+    bool readbackRequested = false;
+    uint64_t readbackValue = 0;
 
+    std::vector<FrameData> frames;
+    uint32_t frameIndex = 0;
+    uint32_t imageIndex = 0;
+    uint64_t frameNumber = 0;
+    std::vector<TimelineWait> frameWaits;
+    GpuProfiler profiler;
+    UploadManager uploadManager;
+    BindlessRegistry bindless;
+    RenderGraph renderGraph;
+    RenderGraphResource backbuffer = 0;
+    VkClearColorValue clearColor = {{0.06f, 0.06f, 0.08f, 1.0f}};
 
-    void setupDevices();
-    VkPhysicalDevice selectPhysicalDevice() const;
+    void setupDevices(const DeviceRequirements& requirements);
     void setupDebugUtils();
+    void setupPipelineCache();
+    void destroyPipelineCache();
+    void setupFrames();
+    void destroyFrames();
+    void recreateSwapchain();
+    void destroyOffscreen();
+    VkFormat getTargetFormat() const;
+    uint32_t getTargetImageCount() const;
+    VkImage getTargetImage(uint32_t index) const;
+    VkImageView getTargetImageView(uint32_t index) const;
+    std::mutex& getQueueMutex(QueueType type);
 
 
     PFN_vkCreateDebugUtilsMessengerEXT vkCreateDebugUtilsMessengerEXT{ nullptr };
@@ -45,6 +238,7 @@ private:
     VkDebugUtilsMessengerEXT debugMessenger{};
 
     bool debugUtilsSupported = false;
+    std::vector<std::string> enabledExtensions;
 
     static bool IsExtensionAvailable(const std::vector<VkExtensionProperties>& properties, const char* extension);
     void cleanVulkan();